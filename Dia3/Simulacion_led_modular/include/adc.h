@@ -0,0 +1,82 @@
+#pragma once
+
+/*
+    adc.h - API de ADC multicanal con DMA circular (independiente del hardware)
+
+    implementaciones:
+    - adc_sim.c : ADC simulado en PC con generador de ondas sinteticas (este)
+    - adc_hw.c  : ADC en modo scan + DMA circular del MCU (cuando llegue la placa)
+
+    como en un micro, no se lee muestra por muestra: el ADC convierte todos
+    los canales a "rate_hz" y el DMA los deja intercalados (frame = una
+    muestra de cada canal: c0 c1 ... cN-1 c0 c1 ...) en un buffer doble:
+
+        [ mitad A : block frames ][ mitad B : block frames ]
+
+    mientras el ADC llena una mitad, el firmware procesa la otra. El
+    callback recibe la mitad recien completada y vale hasta que se complete
+    la siguiente (una mitad de tiempo). Si adc_poll() llega tan tarde que
+    se acumulo mas de un buffer entero, los bloques pisados se cuentan en
+    "overruns" (en HW: el DMA sobreescribio datos no leidos).
+
+    tiempo: reloj de timeutil.h (real o virtual). adc_poll() genera las
+    muestras que "ya se convirtieron" y adc_next_ns() dice cuando se
+    completa la proxima mitad (timeout para event_wait).
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_BITS         12
+#define ADC_MAX          ((1 << ADC_BITS) - 1) // 4095
+#define ADC_CHANNELS_MAX 16
+
+typedef enum{
+    ADC_WAVE_DC = 0,
+    ADC_WAVE_SINE,
+    ADC_WAVE_SQUARE,
+    ADC_WAVE_TRIANGLE
+} adc_wave_kind_t;
+
+// Señal sintetica de un canal, en cuentas del ADC (0..ADC_MAX, se satura)
+typedef struct{
+    adc_wave_kind_t kind;
+    double freq_hz;
+    double amp;      // amplitud pico
+    double offset;   // nivel medio
+    double noise;    // ruido uniforme +-noise
+} adc_wave_t;
+
+// Mitad completa: frames intercalados, nframes * nchan muestras
+typedef void (*adc_block_cb_t)(const uint16_t *frames, size_t nframes, void *arg);
+
+typedef struct{
+    int            nchan;    // 1..ADC_CHANNELS_MAX
+    uint32_t       rate_hz;  // frames por segundo (cada canal a esta tasa)
+    size_t         block;    // frames por mitad del buffer doble
+    adc_block_cb_t cb;
+    void          *arg;
+} adc_cfg_t;
+
+typedef struct{
+    uint64_t frames;    // frames convertidos
+    uint64_t blocks;    // mitades entregadas al callback
+    uint64_t overruns;  // mitades pisadas antes de entregarse
+} adc_stats_t;
+
+// Reserva el buffer doble. 0 si ok, -1 si la configuracion no vale
+int  adc_init(const adc_cfg_t *cfg);
+void adc_deinit(void);
+
+int  adc_set_wave(int ch, const adc_wave_t *w); // por defecto DC en ADC_MAX/2
+
+int  adc_start(void);  // empieza a convertir "ahora"
+void adc_stop(void);
+
+// Genera lo convertido hasta ahora y llama el callback por cada mitad completa
+int       adc_poll(void);
+long long adc_next_ns(void);   // instante en que se completa la proxima mitad, -1 si parado
+
+int  adc_read(int ch);         // ultima conversion del canal (0..ADC_MAX), -1 si no vale
+
+void adc_stats(adc_stats_t *st);
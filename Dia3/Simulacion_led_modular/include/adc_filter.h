@@ -0,0 +1,68 @@
+#pragma once
+
+/*
+    adc_filter.h - filtros por bloques para los datos de adc.h
+
+    todos trabajan sobre bloques enteros de frames intercalados en float
+    (frame = una muestra de cada canal, como los deja el DMA), nunca una
+    muestra por llamada:
+
+        adc_to_float -> adc_ma_run -> adc_iir_run -> adc_decim_run
+
+    los filtros recursivos (media movil, IIR) dependen de la muestra
+    anterior del MISMO canal, asi que el lazo interno recorre los canales
+    de un frame: son independientes y contiguos, y el compilador los hace
+    de a 4/8 con SIMD (adc_filter.c se compila con -O3). El estado de cada
+    filtro es un arreglo por canal.
+
+    adc_to_float no escala: cada muestra queda en cuentas enteras (0..4095),
+    asi la suma de la media movil es exacta en float (no deriva).
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "adc.h"
+
+// count = frames * canales
+void adc_to_float(const uint16_t *in, float *out, size_t count);
+
+/* ============ Media movil de "len" frames (suma corrida) ============ */
+
+typedef struct{
+    int    nchan;
+    int    len;
+    int    pos;                      // frame mas viejo en hist
+    float *hist;                     // ultimos len frames (anillo)
+    float  sum[ADC_CHANNELS_MAX];
+    float  inv;                      // 1 / len
+} adc_ma_t;
+
+int  adc_ma_init(adc_ma_t *f, int nchan, int len); // 0 si ok (arranca con historia en 0)
+void adc_ma_free(adc_ma_t *f);
+void adc_ma_run(adc_ma_t *f, const float *in, float *out, size_t frames); // in != out
+
+/* ============ IIR de 1er orden: y += alpha * (x - y) ============ */
+
+typedef struct{
+    int   nchan;
+    float alpha;                     // 0..1 (fc ~ alpha * fs / 2pi)
+    float y[ADC_CHANNELS_MAX];
+} adc_iir_t;
+
+int   adc_iir_init(adc_iir_t *f, int nchan, float alpha); // 0 si ok; -1 si nchan o alpha (0 < alpha <= 1) no valen
+void  adc_iir_run(adc_iir_t *f, const float *in, float *out, size_t frames); // in == out vale
+float adc_iir_step(adc_iir_t *f, int ch, float x); // una muestra (referencia para comparar)
+
+/* ============ Decimacion por "factor": promedio de cada grupo ============ */
+
+typedef struct{
+    int   nchan;
+    int   factor;
+    int   count;                     // frames acumulados del grupo en curso
+    float acc[ADC_CHANNELS_MAX];
+    float inv;
+} adc_decim_t;
+
+int    adc_decim_init(adc_decim_t *f, int nchan, int factor); // 0 si ok; -1 si nchan o factor (>= 1) no valen
+// Retorna cuantos frames escribio en out (in == out vale)
+size_t adc_decim_run(adc_decim_t *f, const float *in, float *out, size_t frames);
@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+    app.h - logica de la aplicacion (boton -> debounce -> LED), sin teclado
+
+    antes vivia dentro de main_switch.c / main_toggle.c, pegada al loop de
+    teclado. Separada aqui la usan:
+    - los mains interactivos (un boton, un LED)
+    - el runner sin terminal (replay.c), con una instancia por pin de la traza
+
+    cada instancia es independiente: su propio debounce, su timer de muestreo
+    y su par de pines. Necesita gpio_init() y timer_service_init() hechos antes.
+*/
+
+#include <stdint.h>
+#include "debounce.h"
+#include "timer.h"
+
+typedef enum{
+    APP_SWITCH = 0, // LED sigue el nivel estable del boton
+    APP_TOGGLE = 1  // cada presion estable alterna el LED
+} app_mode_t;
+
+typedef struct app app_t;
+
+// aviso de cambio de LED (para imprimir, contar, etc.). Puede ser NULL
+typedef void (*app_led_cb_t)(app_t *a, int led);
+
+struct app{
+    app_mode_t     mode;
+    int            in_pin;      // boton
+    int            out_pin;     // LED
+    int            poll_ms;     // periodo de muestreo mientras hay cambio pendiente
+    debounce_ctx_t deb;
+    swtimer_t      poll_timer;
+    int            last_led;    // ultimo estado avisado (-1 = avisar aunque no cambie)
+    uint64_t       led_changes; // cambios de LED desde app_init
+    app_led_cb_t   on_led;
+    void          *user;        // libre para quien usa la instancia
+};
+
+/*
+    Configura los pines (LED salida, boton entrada con pull-down e
+    interrupcion en ambos flancos) y deja la instancia lista.
+    Retorna 0 si ok, -1 si algun pin no es valido
+*/
+int app_init(app_t *a, app_mode_t mode, int in_pin, int out_pin,
+             int poll_ms, long long debounce_ms, app_led_cb_t on_led, void *user);
+
+/*
+    Cambia el algoritmo de debounce (debounce.h) manteniendo la ventana de
+    app_init. Llamar antes de empezar a muestrear. 0 si ok, -1 si algo no
+    es un algoritmo valido (queda el que estaba)
+*/
+int  app_set_algo(app_t *a, debounce_algo_t algo);
+
+// Fuerza un muestreo ya y que on_led avise el estado actual (p. ej. el inicial)
+void app_kick(app_t *a);
+
+// Suelta la interrupcion del boton y para el muestreo
+void app_stop(app_t *a);
@@ -0,0 +1,57 @@
+#pragma once
+
+/*
+    batch.h - modo sin terminal para boton_switch / boton_toggle (--batch)
+
+    el loop interactivo necesita una terminal: modo raw y teclas del hilo
+    lector (input.c). En modo batch las teclas salen de un GUION (archivo o
+    pipe) y van por la misma tabla de teclas (keymap_dispatch) y el mismo
+    cuerpo del loop (gpio_poll, tick_update, timer_run_due, task_run_ready),
+    asi que corre exactamente la logica de produccion.
+
+    guion: palabras separadas por espacios o saltos de linea
+        1 0 1          cada caracter de una palabra es una tecla, en orden
+        +60            esperar 60 ms (el loop sigue atendiendo timers y tareas)
+        *1000 1 +60 0 +60
+                       repetir el resto de la linea 1000 veces
+        # ...          comentario hasta fin de linea
+    las teclas de una misma palabra llegan juntas (un lote, como si se
+    hubieran pegado en la terminal).
+
+    con reloj virtual (vclock_enable antes de gpio_init / app_init) las
+    esperas no duermen: el reloj salta al proximo timer o al fin de la
+    espera, y el guion corre a toda la velocidad de la CPU, siempre igual.
+    con reloj real las esperas son de verdad (para probar contra el reloj).
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "keymap.h"
+
+typedef struct{
+    const char   *script;    // archivo del guion, "-" = stdin
+    keymap_t     *keys;      // tabla del programa
+    keymap_cmd_fn on_cmd;    // comandos (KEY_CMD); != 0 corta el guion
+    void         *arg;
+    long long     settle_ms; // al terminar el guion, seguir corriendo esto (debounce, pulsos)
+} batch_cfg_t;
+
+typedef struct{
+    uint64_t  words;        // palabras del guion ya expandidas las repeticiones
+    uint64_t  keys;         // teclas despachadas
+    uint64_t  waits;        // esperas (+ms)
+    uint64_t  loops;        // vueltas del loop
+    long long sim_ns;       // tiempo del reloj del programa (virtual o real)
+    long long wall_ns;      // tiempo real que llevo correr el guion
+    int       quit;         // 1 si un comando corto el guion
+} batch_stats_t;
+
+/*
+    Corre el guion completo y despues settle_ms mas. Necesita gpio_init,
+    timer_service_init y las tareas ya arrancadas. 0 si ok, -1 si no se
+    pudo abrir el guion o tiene algo mal escrito (st queda con lo hecho)
+*/
+int  batch_run(const batch_cfg_t *cfg, batch_stats_t *st);
+
+// Resumen: teclas, esperas, tiempo simulado vs real, teclas/s
+void batch_print(const batch_stats_t *st, FILE *f);
@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+    bounce.h - generador de rebote de contactos (señal cruda realista)
+
+    por cada pin simula un boton fisico:
+    - presiones al azar (proceso de Poisson de press_hz por segundo), cada una
+      mantenida al menos hold_us
+    - cada cambio "ideal" (lo que hizo el dedo) llega al pin como una rafaga
+      de rebote: duracion media bounce_us, cambios cada ~1/chatter_hz
+    - ruido: pulsos espurios aislados (glitch_hz por segundo, ancho glitch_us)
+      en medio de un estado estable, como EMI o un contacto flojo
+    - las duraciones se sortean con la distribucion elegida (dist)
+
+    es determinista: misma semilla y misma config -> mismos eventos, y cada
+    pin tiene su propio generador (agregar pines no cambia los anteriores).
+    No toca gpio: entrega eventos ordenados por tiempo y quien lo usa los
+    inyecta con gpio_simulate_input() (asi se intercalan con los timers).
+*/
+
+#include <stdint.h>
+
+typedef enum{
+    BOUNCE_DIST_UNIFORM = 0, // uniforme en [0, 2*media]
+    BOUNCE_DIST_EXP,         // exponencial (muchos cortos, algunos largos)
+    BOUNCE_DIST_NORMAL       // normal con sigma = media/3 (recortada a > 0)
+} bounce_dist_t;
+
+typedef struct{
+    uint64_t      seed;
+    double        press_hz;    // presiones por segundo por pin
+    long long     hold_us;     // minimo tiempo apretado / suelto
+    long long     bounce_us;   // duracion media de una rafaga
+    double        chatter_hz;  // cambios por segundo dentro de una rafaga
+    double        glitch_hz;   // pulsos espurios por segundo por pin (0 = sin ruido)
+    long long     glitch_us;   // ancho medio de un pulso espurio
+    bounce_dist_t dist;
+} bounce_cfg_t;
+
+// Valores por defecto razonables (boton mecanico comun)
+void bounce_cfg_default(bounce_cfg_t *cfg);
+
+typedef struct{
+    long long t_ns;    // instante del cambio crudo
+    int       pin;
+    int       value;   // nuevo nivel crudo
+    int       ideal;   // nivel "verdadero" del boton en ese instante
+    int       edge;    // 1 si este cambio abre una rafaga (el dedo cambio de verdad)
+} bounce_ev_t;
+
+typedef struct bounce_pin bounce_pin_t;
+
+typedef struct{
+    bounce_cfg_t  cfg;
+    bounce_pin_t *pins;   // estado por pin
+    int          *heap;   // indices en pins[], min-heap por proximo evento
+    int           npins;
+    uint64_t      raw_changes;   // eventos entregados
+    uint64_t      ideal_changes; // de esos, cuantos eran cambios reales
+} bounce_gen_t;
+
+/*
+    Prepara un generador para los pines dados (todos arrancan en 0 y estables)
+    a partir del instante t0_ns. Retorna 0 si ok, -1 si error
+*/
+int  bounce_init(bounce_gen_t *g, const bounce_cfg_t *cfg, const int *pins, int npins, long long t0_ns);
+void bounce_free(bounce_gen_t *g);
+
+// Instante del proximo evento (-1 si no hay pines, LLONG_MAX si nunca habra otro)
+long long bounce_peek(const bounce_gen_t *g);
+
+// Saca el proximo evento (en orden de tiempo). Retorna 1 si hay, 0 si no
+int bounce_next(bounce_gen_t *g, bounce_ev_t *ev);
@@ -7,18 +7,146 @@
     - debounce_state() - devuelve el nivel esatble 1/0 (se usa en main_switch)
     - debounce_press() - devuelve 1 si se detecta un cambio de 0 a 1 (se usa en main_toggle)
 
+    y dos formas de usarlos:
+    - por contexto (debounce_ctx_t): un filtro por entrada, tantas como quieras
+    - por banco (debounce_bank_t): 64 pines por palabra de 64 bits, una llamada por tick
+
+    el contexto puede usar distintos algoritmos (debounce_algo_t) detras de
+    la misma API (debounce_ctx_state/press):
+    - DEBOUNCE_TIMER      : candidato + marca de tiempo (el de siempre). Lee
+                            tick_us() en cada muestra; la ventana es en tiempo
+    - DEBOUNCE_INTEGRATOR : contador saturado 0..N (sube con 1, baja con 0);
+                            cambia al tocar un extremo. Tolera ruido aislado
+    - DEBOUNCE_SHIFT8/16/32: historial de las ultimas 8/16/32 muestras; cambia
+                            cuando son todas iguales. Una sola comparacion
+    los dos ultimos cuentan MUESTRAS y no miran el reloj: la ventana en tiempo
+    es N * periodo de muestreo
 */
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum{
+    DEBOUNCE_TIMER = 0,   // ventana de tiempo (por defecto)
+    DEBOUNCE_INTEGRATOR,  // contador saturado con histeresis
+    DEBOUNCE_SHIFT8,      // historial de 8 muestras
+    DEBOUNCE_SHIFT16,     // historial de 16 muestras
+    DEBOUNCE_SHIFT32,     // historial de 32 muestras
+    DEBOUNCE_ALGO_COUNT
+} debounce_algo_t;
+
+extern const char *const debounce_algo_name[DEBOUNCE_ALGO_COUNT]; // "timer", "integrator", "shift8"...
+
+// Algoritmo por nombre (debounce_algo_name), -1 si no existe
+int debounce_algo_parse(const char *name);
+
+/*
+    Estado de UN filtro de rebote (una entrada).
+    Antes vivia en variables static dentro de cada funcion, asi que el proceso
+    solo podia filtrar una entrada de cada tipo.
+*/
+typedef struct{
+    int last_stable;     // ultimo estado real confirmado (0/1)
+    int candidate;       // posible nuevo estado (todavia no confirmado)
+    long long t0_us;     // marca temporal (us) cuando vimos el candidato
+    long long stable_us; // ventana minima de estabilidad en microsegundos
+    debounce_algo_t algo; // estrategia (DEBOUNCE_TIMER con debounce_ctx_init*)
+    uint32_t  hist;      // DEBOUNCE_SHIFT*: ultimas muestras, la mas nueva en el bit 0
+    uint32_t  mask;      // DEBOUNCE_SHIFT*: bits del historial que cuentan
+    uint16_t  count;     // DEBOUNCE_INTEGRATOR: 0..samples
+    uint16_t  samples;   // DEBOUNCE_INTEGRATOR: muestras para llegar al extremo
+} debounce_ctx_t;
+
+// Inicializa un contexto en 0 con la ventana indicada (en ms)
+void debounce_ctx_init(debounce_ctx_t *d, long long stable_ms);
+
+// Igual, con la ventana en microsegundos (permite ventanas < 1 ms)
+void debounce_ctx_init_us(debounce_ctx_t *d, long long stable_us);
+
+/*
+    Inicializa un contexto con el algoritmo indicado.
+    - stable_us: ventana de estabilidad (DEBOUNCE_TIMER la usa tal cual)
+    - period_us: periodo de muestreo; el integrador usa stable_us / period_us
+      muestras (redondeado hacia arriba). Los SHIFT usan el ancho del historial
+    Retorna 0 si ok, -1 si algo no es un debounce_algo_t valido (d no se toca)
+*/
+int  debounce_ctx_init_algo(debounce_ctx_t *d, debounce_algo_t algo,
+                            long long stable_us, long long period_us);
+
+/*
+    1 si el filtro no tiene nada pendiente con esta muestra cruda (el crudo
+    coincide con el estable y el estado interno esta en reposo): quien
+    muestrea por timer puede parar hasta el proximo flanco
+*/
+bool debounce_ctx_idle(const debounce_ctx_t *d, int raw);
+
+/*
+    Igual que debounce_state() pero sobre el contexto d.
+    El tiempo sale de tick_us() (timeutil.h), NO del reloj: hay que llamar
+    tick_update() antes (una vez por iteracion del loop, y todos los pines
+    comparten esa lectura). Sin tick_update() la muestra lleva el instante
+    del tick anterior (o 0 si nunca se llamo) y la ventana de DEBOUNCE_TIMER
+    no avanza. Solo DEBOUNCE_TIMER lo mira; desde otro hilo se puede llamar
+    pero con el tick del loop
+*/
+int debounce_ctx_state(debounce_ctx_t *d, int raw);
+
+// Igual que debounce_press() pero sobre el contexto d (tiempo de tick_us(): tick_update() antes)
+bool debounce_ctx_press(debounce_ctx_t *d, int raw);
 
 /*
     Detecta flanco de Presion (0 -> 1) tras mantenerse estable stable_ms
     devuelve true solo caudno se confirma el flanco de presion
+    (usa un contexto interno unico: solo sirve para UNA entrada,
+    y lee el reloj una vez por llamada)
 */
-bool debounce_press(int pin, long long stable_ms);
+bool debounce_press(int raw, long long stable_ms);
 
 /*
     Devuelve el esatdo esatble (0/1) tras mantenerse esatble por stable_ms
     util cuando la salida debe seguir el nivel (switch 1=ON, 0=OFF)
+    (usa un contexto interno unico: solo sirve para UNA entrada,
+    y lee el reloj una vez por llamada)
 */
-int debounce_state(int pin, long long stable_ms);
\ No newline at end of file
+int debounce_state(int raw, long long stable_ms);
+
+/* ================== BANCO (bit-paralelo) ==================
+    Contador vertical: el bit i de cada palabra es un pin, y el contador de
+    muestras de ese pin esta repartido en "planos" (un bit del contador por
+    palabra). Asi una suma/reset de 64 contadores son unas pocas AND/XOR.
+
+    - samples = muestras consecutivas distintas del estado estable que hacen
+      falta para aceptar el cambio (equivale a stable_ms / periodo de muestreo)
+*/
+
+#define DEBOUNCE_BANK_MAX_SAMPLES 255 // contador de hasta 8 planos
+
+typedef struct{
+    size_t    npins;     // pines en el banco
+    size_t    nwords;    // palabras de 64 pines
+    unsigned  samples;   // muestras para aceptar un cambio (1..255)
+    unsigned  nplanes;   // bits del contador vertical
+    uint64_t  thr[8];    // patron del umbral por plano (todo 1s o todo 0s)
+    uint64_t *stable;    // nivel estable, 1 bit por pin
+    uint64_t *cnt;       // contadores: nwords * nplanes palabras
+} debounce_bank_t;
+
+// Reserva el banco para npins pines. Retorna 0 si ok, -1 si error
+int debounce_bank_init(debounce_bank_t *b, size_t npins, unsigned samples);
+
+// Libera la memoria del banco
+void debounce_bank_free(debounce_bank_t *b);
+
+/*
+    Procesa una muestra cruda de todos los pines (raw: nwords palabras).
+    changed (opcional, puede ser NULL): bits de los pines que cambiaron de
+    estado estable en este tick. Flanco de presion = changed & stable.
+    Retorna el OR de todos los cambios (0 = no cambio nada).
+*/
+uint64_t debounce_bank_update(debounce_bank_t *b, const uint64_t *raw, uint64_t *changed);
+
+// Nivel estable (0/1) de un pin del banco
+static inline int debounce_bank_get(const debounce_bank_t *b, size_t pin){
+    return (int)((b->stable[pin >> 6] >> (pin & 63)) & 1u);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+    event.h - "despertador" del loop principal (eventfd + epoll)
+
+    en vez de dormir 1 ms y volver a preguntar (polling), el loop se queda
+    bloqueado en event_wait() hasta que:
+    - alguien llama event_signal() (por ej. un flanco de GPIO, otro hilo...)
+    - un descriptor vigilado (stdin) tiene datos
+    - vence el timeout (el proximo deadline del loop)
+
+    En HW real esto seria el WFI (wait for interrupt) del micro.
+*/
+
+#define EVENT_SIGNAL  0x1 // alguien llamo event_signal()
+#define EVENT_FD      0x2 // algun descriptor vigilado esta listo
+
+int  event_init(void);      // crea eventfd + epoll. 0 si ok, -1 si error
+void event_close(void);     // libera los descriptores
+
+int  event_add_fd(int fd);  // vigila fd (lectura). 0 si ok, -1 si error
+
+void event_signal(void);    // despierta a event_wait (seguro desde otros hilos)
+
+/*
+    Espera hasta que haya un evento o pasen timeout_ms (-1 = sin limite).
+    Retorna mascara EVENT_SIGNAL/EVENT_FD, 0 si vencio el timeout
+*/
+int  event_wait(long long timeout_ms);
@@ -22,12 +22,29 @@ typedef enum{
     GPIO_PULLDOWN = 2 //resistencia interna a GND (0 por defecto)
 } gpio_pull_t; //configuracion de pull-up/pull-down
 
+/*
+    Modelo de PUERTOS (como GPIOA, GPIOB... en un STM32)
+    - cada puerto agrupa GPIO_PORT_WIDTH pines en palabras de 64 bits
+    - pin N vive en el puerto N/64, bit N%64
+    - leer o escribir un banco entero = una sola carga/escritura
+*/
+#define GPIO_PORT_WIDTH 64
+#ifndef GPIO_PORT_COUNT
+#define GPIO_PORT_COUNT 64 // 64 puertos x 64 pines = 4096 pines simulados
+#endif
+#define GPIO_PIN_MAX (GPIO_PORT_WIDTH * GPIO_PORT_COUNT)
+
+#define GPIO_PORT_OF(pin) ((pin) / GPIO_PORT_WIDTH)            //puerto del pin
+#define GPIO_BIT_OF(pin)  (1ULL << ((pin) % GPIO_PORT_WIDTH))   //mascara del pin en su puerto
+
 /*Inicializa la "Capa GPIO"
     En HW real: habilitar los clocks en los puertos, yponer los pines en un estado seguro
     En simulacion: inicializar las variables internas
-
+    Retorna 0 si ok, -1 si la capa no se pudo abrir (gpio_shm: placa
+    inaccesible o incompatible). Sin GPIO no hay nada que simular: el
+    programa tiene que terminar
 */
-void gpio_init(void);
+int gpio_init(void);
 
 //Configura el modo del pin (entrada/salida)
 void gpio_mode(int pin, gpio_mode_t mode);
@@ -41,6 +58,61 @@ void gpio_write(int pin, int value); //value: 0 o 1
 //Lee el valor del pin (solo input)
 int gpio_read(int pin); //retorna 0 o 1
 
+/* ============ Acceso por puerto (64 pines de una vez) ============ */
+
+//Lee el nivel efectivo de los 64 pines del puerto (como IDR)
+//bit=1 -> pin en alto (salidas: lo escrito; entradas: crudo + pull)
+uint64_t gpio_port_read(int port);
+
+/*
+    Foto de varios puertos de una vez: out[k] = nivel efectivo del puerto
+    port + k, igual que gpio_port_read() pero sin validar ni llamar por puerto
+    (el pull ya viene aplicado, sin ramas). Es la entrada natural de
+    debounce_bank_update(): una foto por tick en vez de N gpio_read().
+    Retorna cuantos puertos escribio en out (0 si el rango no es valido)
+*/
+int gpio_read_bank(int port, int nports, uint64_t *out);
+
+//Foto de todos los pines: out debe tener GPIO_PORT_COUNT palabras
+void gpio_read_all(uint64_t *out);
+
+//Escribe el ODR completo del puerto (solo afecta a los pines de salida)
+void gpio_port_write(int port, uint64_t value);
+
+//Escribe solo los pines de "mask" con los bits de "value" (tipo BSRR)
+void gpio_write_mask(int port, uint64_t mask, uint64_t value);
+
+/* ============ Interrupciones por flanco (tipo EXTI) ============
+ *  el handler se llama desde gpio_simulate_input() cuando el nivel efectivo
+ *  del pin cambia en el sentido pedido; ademas se despierta a event_wait()
+ *  (ver event.h) para que el loop principal no tenga que hacer polling.
+ *  El handler corre en el contexto de quien inyecto la entrada (como una ISR):
+ *  debe ser corto (marcar un flag, guardar un timestamp...).
+*/
+
+typedef enum{
+    GPIO_EDGE_NONE    = 0, //sin interrupcion
+    GPIO_EDGE_RISING  = 1, //flanco de subida 0 -> 1
+    GPIO_EDGE_FALLING = 2, //flanco de bajada 1 -> 0
+    GPIO_EDGE_BOTH    = 3  //ambos flancos
+} gpio_edge_t;
+
+typedef void (*gpio_irq_handler_t)(int pin, int level, void *arg); //level: nivel nuevo 0/1
+
+//Registra un handler de flanco para el pin. 0 si ok, -1 si pin invalido
+int gpio_irq_attach(int pin, gpio_edge_t edge, gpio_irq_handler_t handler, void *arg);
+
+//Quita el handler del pin
+void gpio_irq_detach(int pin);
+
+/*
+    Atiende flancos que llegaron por fuera de este proceso (otro proceso
+    escribio la entrada en una placa compartida, ver gpio_shm.h) y llama a
+    sus handlers. El loop la llama al despertar de event_wait().
+    En gpio_sim.c (y en HW real, donde la IRQ llega sola) no hace nada
+*/
+void gpio_poll(void);
+
 /* ==========SOLO en simulacion==============
  *alimanta la "entrada cruda" (como si viniera del mundo fisico/teclado)
  *En HW real no se usa
@@ -48,4 +120,11 @@ int gpio_read(int pin); //retorna 0 o 1
 
 void gpio_simulate_input(int pin, int value); //value: 0 o 1
 
+/*
+ *graba cada cambio crudo de gpio_simulate_input() en una traza binaria
+ *(ver trace.h). NULL = dejar de grabar
+*/
+struct trace_writer;
+void gpio_trace_attach(struct trace_writer *w);
+
 /* ========================================= */
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+    gpio_err.h - contadores de errores de GPIO y log con limite de tasa
+
+    antes cada pin invalido o acceso en el modo equivocado era un fprintf a
+    stderr: un pin mal configurado dentro de un loop rapido eran miles de
+    escrituras bloqueantes por segundo y el loop perdia su temporizacion.
+    Ahora el camino de error solo:
+    - incrementa un contador atomico (total por error y por pin y error;
+      para pin / puerto invalido, por valor invalido: los primeros 16
+      valores distintos de cada tipo, el resto va a "otros")
+    - si quedan "fichas" para ese error (GPIO_ERR_LOG_BURST de rafaga,
+      recarga GPIO_ERR_LOG_PER_S por segundo) deja un registro de 16 bytes
+      en una cola en memoria (spsc.h); si no, el mensaje se cuenta como
+      suprimido
+    - gpio_err_flush() escribe los mensajes pendientes; lo llama el loop
+      cuando le conviene (fuera del camino caliente) o el programa al salir
+    - el primer error despues de un flush llama al aviso de
+      gpio_err_notify_attach() (p. ej. event_signal): el loop no tiene que
+      revisar la cola cada tanto para enterarse
+
+    productores: cualquier hilo que llame a gpio_* (el loop, el hilo del PWM,
+    el mundo de irq_bench, ...), a la vez; consumidor: UN hilo, el que llama a
+    gpio_err_flush(). Los contadores se pueden leer desde cualquier hilo.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define GPIO_ERR_LOG_BURST 8   // mensajes seguidos permitidos por tipo de error
+#define GPIO_ERR_LOG_PER_S 4   // mensajes por segundo por tipo, pasada la rafaga
+
+typedef enum{
+    GPIO_ERR_BAD_PIN = 0,  // pin fuera de rango
+    GPIO_ERR_BAD_PORT,     // puerto fuera de rango
+    GPIO_ERR_NOT_INPUT,    // pull sobre un pin de salida
+    GPIO_ERR_NOT_OUTPUT,   // escritura sobre un pin de entrada
+    GPIO_ERR_COUNT
+} gpio_err_t;
+
+typedef enum{
+    GPIO_OP_MODE = 0,
+    GPIO_OP_SET_PULL,
+    GPIO_OP_WRITE,
+    GPIO_OP_READ,
+    GPIO_OP_PORT_READ,
+    GPIO_OP_PORT_WRITE,
+    GPIO_OP_WRITE_MASK,
+    GPIO_OP_SIMULATE_INPUT,
+    GPIO_OP_IRQ_ATTACH,
+    GPIO_OP_READ_BANK,
+    GPIO_OP_COUNT
+} gpio_op_t; // funcion de gpio.h que detecto el error (para el mensaje)
+
+/*
+    Registra un error de la capa GPIO (lo llaman gpio_sim.c / gpio_hw.c).
+    pin: pin o puerto que causo el error, segun el tipo
+*/
+void gpio_err_report(gpio_op_t op, gpio_err_t err, int pin);
+
+uint64_t gpio_err_count(gpio_err_t err);              // total de un tipo de error
+uint64_t gpio_err_pin_count(int pin, gpio_err_t err); // por pin, o por valor invalido (BAD_PIN / BAD_PORT)
+uint64_t gpio_err_suppressed(void);                   // mensajes no escritos (limite o cola llena)
+
+/*
+    Aviso cuando hay algo nuevo para gpio_err_flush(): se llama una vez, desde
+    el hilo que reporta, hasta el proximo flush. Tiene que ser seguro desde
+    cualquier hilo (event_signal lo es). NULL = sin aviso. Se configura antes
+    de arrancar hilos que usen gpio_*
+*/
+void gpio_err_notify_attach(void (*fn)(void));
+
+// 1 si hay mensajes o suprimidos sin escribir desde el ultimo flush
+int  gpio_err_pending(void);
+
+// Escribe los mensajes pendientes en f. Retorna cuantos escribio
+int  gpio_err_flush(FILE *f);
+
+// Resumen de los contadores distintos de 0 (nada si no hubo errores)
+void gpio_err_dump(FILE *f);
+
+// Contadores, fichas y cola a cero (lo llama gpio_init)
+void gpio_err_reset(void);
@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+    gpio_pins.h - accesores por pin generados en compilacion desde pins.h
+
+    gpio_read(pin)/gpio_write(pin, v) sirven para cualquier pin, pero cada
+    llamada valida el rango, mira el modo del pin y resuelve el pull. Para los
+    pines de PINS_TABLE todo eso ya se sabe al compilar, asi que aqui se genera
+    una funcion static inline por pin:
+
+    - entradas: int  pin_nombre_read(void)       -> una carga del IDR (+ OR con
+                                                    el pull-up si la tabla lo pide)
+    - salidas:  int  pin_nombre_read(void)       -> una carga del ODR
+                void pin_nombre_write(int value) -> carga + escritura del ODR
+    - pins_config(): aplica modo y pull de la tabla (llamar despues de gpio_init)
+
+    No hay pin_nombre_write() para entradas: escribir un boton no compila.
+    Los accesores confian en la tabla: si alguien cambia el modo o el pull de un
+    pin de la tabla con gpio_mode/gpio_set_pull, debe usar la API normal.
+
+    En HW REAL: mismas funciones sobre los registros del MCU (GPIOx->IDR/BSRR).
+*/
+
+#include <stdint.h>
+#include "gpio.h"
+#include "pins.h"
+#include "vcd.h"
+#include "timeutil.h"
+
+/*
+    Registros simulados de un puerto (ver gpio_sim.c). Se exponen solo para los
+    accesores generados; el resto del codigo usa gpio.h.
+*/
+typedef struct{
+    uint64_t moder; //1 = GPIO_OUTPUT, 0 = GPIO_INPUT
+    uint64_t pu;    //1 = GPIO_PULLUP
+    uint64_t pd;    //1 = GPIO_PULLDOWN
+    uint64_t odr;   //valor escrito (salidas)
+    uint64_t idr;   //valor "crudo" de la entrada (antes de debounce)
+} gpio_port_t;
+
+extern gpio_port_t gpio_ports[GPIO_PORT_COUNT];
+
+/* ============ Validaciones en compilacion ============ */
+
+#define PINS_RANGE_(id, name, num, mode, pull) \
+    _Static_assert((num) >= 0 && (num) < GPIO_PIN_MAX, "pins.h: PIN_" #id " fuera de rango");
+PINS_TABLE(PINS_RANGE_)
+
+// un miembro por numero de pin: un pin repetido en la tabla es un miembro duplicado
+#define PINS_UNIQUE_(id, name, num, mode, pull) char pin_##num;
+struct pins_unique_check { PINS_TABLE(PINS_UNIQUE_) };
+
+/* ============ Accesores generados ============ */
+
+#define PINS_PULL_MASK_NOPULL(num)   0ULL
+#define PINS_PULL_MASK_PULLDOWN(num) 0ULL
+#define PINS_PULL_MASK_PULLUP(num)   GPIO_BIT_OF(num)
+
+#define PINS_MODE_IN  GPIO_INPUT
+#define PINS_MODE_OUT GPIO_OUTPUT
+
+// entrada: crudo OR pull-up (pull-down y sin pull leen el crudo tal cual)
+#define PINS_ACCESS_IN(name, num, pull)                                          \
+    static inline int pin_##name##_read(void){                                   \
+        uint64_t idr = gpio_ports[GPIO_PORT_OF(num)].idr | PINS_PULL_MASK_##pull(num); \
+        return (int)((idr >> ((num) % GPIO_PORT_WIDTH)) & 1u);                   \
+    }
+
+// salida: el ODR es el nivel; el volcado VCD solo cuesta si esta activo
+#define PINS_ACCESS_OUT(name, num, pull)                                         \
+    static inline int pin_##name##_read(void){                                   \
+        return (int)((gpio_ports[GPIO_PORT_OF(num)].odr >> ((num) % GPIO_PORT_WIDTH)) & 1u); \
+    }                                                                            \
+    static inline void pin_##name##_write(int value){                            \
+        uint64_t *odr = &gpio_ports[GPIO_PORT_OF(num)].odr;                      \
+        uint64_t old = *odr;                                                     \
+        *odr = value ? (old | GPIO_BIT_OF(num)) : (old & ~GPIO_BIT_OF(num));     \
+        if (__builtin_expect(vcd_active, 0) && ((old ^ *odr) & GPIO_BIT_OF(num))) { \
+            vcd_change(now_ns(), (num), value != 0);                             \
+        }                                                                        \
+    }
+
+#define PINS_ACCESS_(id, name, num, mode, pull) PINS_ACCESS_##mode(name, num, pull)
+PINS_TABLE(PINS_ACCESS_)
+
+/* ============ Configuracion desde la tabla ============ */
+
+#define PINS_CONFIG_(id, name, num, mode, pull)    \
+    gpio_mode((num), PINS_MODE_##mode);            \
+    if (PINS_MODE_##mode == GPIO_INPUT) {          \
+        gpio_set_pull((num), GPIO_##pull);         \
+    }
+
+// Modo y pull de todos los pines de la tabla (despues de gpio_init)
+static inline void pins_config(void){
+    PINS_TABLE(PINS_CONFIG_)
+}
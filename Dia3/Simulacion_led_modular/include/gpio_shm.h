@@ -0,0 +1,71 @@
+#pragma once
+
+/*
+    gpio_shm.h - extras del backend de GPIO en memoria compartida (gpio_shm.c)
+
+    gpio_shm.c implementa la MISMA API de gpio.h que gpio_sim.c, pero los
+    registros de los puertos viven en /dev/shm (shm_open + mmap) en vez de en
+    un arreglo privado. Varios procesos que abren la misma "placa" ven los
+    mismos pines:
+    - un firmware (boton_switch_shm) configura y escribe sus pines
+    - un banco de pruebas / tablero / otro dispositivo simulado inyecta
+      entradas y lee salidas (bin/gpio_shm) sin pipes ni sockets
+
+    se elige al enlazar: gpio_sim.o o gpio_shm.o (ver makefile, "make shm").
+
+    concurrencia (entre procesos):
+    - cada puerto tiene un contador de secuencia (seqlock): impar = alguien
+      escribe. Los escritores lo toman con un CAS, los lectores no esperan:
+      releen si la secuencia cambio en medio. Leer un puerto = 5 cargas.
+      Si la secuencia queda impar sin moverse (un proceso murio escribiendo)
+      quien espera la libera pasado un rato y lo cuenta: nadie se cuelga
+    - contadores globales de cambios: in_seq (entradas, modo, pull), out_seq
+      (salidas) y seq (cualquiera). Quien observa la placa los compara o
+      espera en seq (futex); solo se hace la syscall de despertar si hay
+      alguien esperando, asi que escribir un pin sigue sin syscalls
+    - los flancos que inyecta OTRO proceso los detecta gpio_poll(); un hilo
+      del proceso espera en in_seq y despierta al loop con event_signal()
+
+    el nombre de la placa sale de la variable de entorno GPIO_SHM_NAME
+    (por defecto GPIO_SHM_DEFAULT). Los accesores de gpio_pins.h son solo de
+    gpio_sim.c (registros en un arreglo fijo) y no enlazan con este backend.
+*/
+
+#include <stdint.h>
+
+#define GPIO_SHM_DEFAULT "/gpio_sim_board"
+
+/*
+    gpio_init() (gpio.h) abre la placa: -1 si existe pero no se puede usar
+    (otro tamaño / version, creador que no termino, permisos). Solo sin
+    /dev/shm sigue con una placa privada
+*/
+
+// Nombre de la placa abierta por gpio_init() (GPIO_SHM_NAME o el por defecto)
+const char *gpio_shm_name(void);
+
+// 1 si gpio_init() creo la placa, 0 si se unio a una existente o no hay placa
+int gpio_shm_created(void);
+
+// Escritores dados por muertos: puertos liberados con la secuencia impar
+uint64_t gpio_shm_stale_writers(void);
+
+// Contadores de cambios de la placa (para observadores)
+uint32_t gpio_shm_seq(void);     // cualquier cambio
+uint32_t gpio_shm_in_seq(void);  // entradas, modo, pull
+uint32_t gpio_shm_out_seq(void); // salidas
+
+/*
+    Espera hasta que gpio_shm_seq() deje de valer "seen" o pasen timeout_ms
+    (-1 = sin limite; siempre reloj real). Retorna 1 si hubo cambio, 0 si no
+*/
+int gpio_shm_wait(uint32_t seen, long long timeout_ms);
+
+// Pone todos los pines de la placa en estado seguro (afecta a todos los procesos)
+void gpio_shm_reset(void);
+
+// Suelta la placa (para el hilo de flancos y desmapea). La placa sigue existiendo
+void gpio_shm_close(void);
+
+// Borra la placa de /dev/shm (los procesos que la tengan abierta la conservan)
+int gpio_shm_unlink(const char *name);
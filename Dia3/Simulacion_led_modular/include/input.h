@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+    input.h - hilo de entrada: teclado -> cola lock-free -> loop de control
+
+    antes el loop llamaba tty_getch_nonblock() (un read() a stdin) en cada
+    vuelta, hubiera tecla o no. Ahora:
+    - un hilo aparte se bloquea en poll() y lee todo lo pendiente de una vez
+      (tty_read_burst)
+    - cada byte leido se marca con su instante (now_ns) y va a una cola
+      wait-free de un productor / un consumidor (spsc.h)
+    - el hilo despierta al loop con event_signal()
+    - el loop vacia la cola con input_poll_burst(): sin syscalls
+
+    la marca de tiempo es la de la lectura, no la de cuando el loop la
+    atiende: sirve para medir la latencia desde la tecla (latency_mark)
+*/
+
+#include <stdint.h>
+
+typedef struct{
+    long long t_ns; // instante en que el hilo leyo el byte
+    int       key;  // byte leido (0..255)
+} input_ev_t;
+
+// Arranca el hilo lector sobre fd (normalmente STDIN_FILENO). 0 si ok, -1 si error
+int  input_start(int fd);
+
+// Para el hilo y espera a que termine (no pasa nada si no estaba corriendo)
+void input_stop(void);
+
+// Saca hasta max eventos de una vez. Retorna cuantos (0 = cola vacia). Sin syscalls
+int  input_poll_burst(input_ev_t *evs, int max);
+
+// 1 cuando el descriptor llego a fin de archivo y la cola ya se vacio (no llegan mas teclas)
+int  input_eof(void);
+
+// Veces que el hilo lector tuvo que esperar (futex, sin polling) porque la cola estaba llena
+uint64_t input_stalls(void);
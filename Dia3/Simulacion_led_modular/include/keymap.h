@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+    keymap.h - mapa de teclas -> acciones sobre pines (tabla, no if-chains)
+
+    cada byte posible (0..255) tiene una entrada en la tabla: decodificar una
+    tecla es un acceso indexado, no una cadena de comparaciones, y el mismo
+    teclado puede manejar muchos pines simulados:
+
+        KEY_PRESS   -> pone 1 crudo en el pin
+        KEY_RELEASE -> pone 0 crudo
+        KEY_TOGGLE  -> invierte el nivel crudo
+        KEY_PULSE   -> pone 1 y lo suelta solo despues de pulse_ms (timer);
+                       mientras dura el pulso la tecla se ignora
+        KEY_CMD     -> no toca pines: devuelve un comando al programa
+                       (salir, imprimir latencia...)
+
+    las acciones sobre pines marcan la latencia desde el instante de la tecla
+    (latency_mark) cuando cambian el nivel.
+*/
+
+#include "input.h"
+#include "timer.h"
+
+typedef enum{
+    KEY_NONE = 0,
+    KEY_PRESS,
+    KEY_RELEASE,
+    KEY_TOGGLE,
+    KEY_PULSE,
+    KEY_CMD
+} key_action_t;
+
+typedef struct{
+    key_action_t action;
+    int          pin;       // pin de entrada (acciones de pin)
+    int          cmd;       // codigo de comando (KEY_CMD), lo define el programa
+    long long    pulse_ms;  // duracion del pulso (KEY_PULSE)
+    swtimer_t    release;   // fin del pulso (KEY_PULSE)
+} keymap_entry_t;
+
+typedef struct{
+    keymap_entry_t key[256];
+} keymap_t;
+
+/*
+    Comando recibido: retornar != 0 corta el despacho (p. ej. salir);
+    las teclas que quedaban en el lote se descartan
+*/
+typedef int (*keymap_cmd_fn)(int cmd, void *arg);
+
+// Tabla vacia (ninguna tecla hace nada)
+void keymap_init(keymap_t *m);
+
+// Asigna una accion de pin a una tecla (pulse_ms solo para KEY_PULSE). 0 si ok, -1 si error
+int  keymap_bind(keymap_t *m, unsigned char key, key_action_t action, int pin, long long pulse_ms);
+
+// Asigna un comando a una tecla
+void keymap_bind_cmd(keymap_t *m, unsigned char key, int cmd);
+
+/*
+    Agrega asignaciones desde texto, separadas por comas:
+        "a=press:2,z=release:2,t=toggle:3,p=pulse:4:60"
+    Retorna 0 si ok, -1 si hay algo mal escrito (lo anterior queda aplicado)
+*/
+int  keymap_parse(keymap_t *m, const char *spec);
+
+/*
+    Aplica un lote de teclas en orden. Retorna el valor != 0 que devolvio
+    on_cmd (y deja de procesar), o 0 si se procesaron todas
+*/
+int  keymap_dispatch(keymap_t *m, const input_ev_t *evs, int n, keymap_cmd_fn on_cmd, void *arg);
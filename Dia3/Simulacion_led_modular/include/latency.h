@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+    latency.h - histogramas de latencia estilo HDR (entrada -> salida)
+
+    medimos cuanto tarda un flanco crudo (gpio_simulate_input) en convertirse
+    en el cambio de LED ya filtrado (gpio_write), por pin de entrada:
+    - latency_mark(pin, t)   -> al ver el flanco crudo (solo cuenta el primero)
+    - latency_done(pin, t)   -> al cambiar la salida: registra t - marca
+    - latency_cancel(pin)    -> el rebote volvio al estado anterior sin cambiar nada
+
+    histograma log-lineal: cada potencia de 2 se parte en 32 cubetas lineales,
+    error relativo < 3.2% para cualquier valor entre 1 ns y ~18 minutos,
+    registrar = un clz y un incremento
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LAT_SUB_BITS 5                              // 32 cubetas por potencia de 2
+#define LAT_SUB      (1 << LAT_SUB_BITS)
+#define LAT_MAX_BITS 40                             // hasta 2^40 ns (~18 min)
+#define LAT_BUCKETS  ((LAT_MAX_BITS - LAT_SUB_BITS + 1) * LAT_SUB)
+
+typedef struct{
+    uint64_t count;               // muestras registradas
+    uint64_t min;                 // minimo exacto (ns)
+    uint64_t max;                 // maximo exacto (ns)
+    uint64_t sum;                 // para el promedio
+    uint64_t bucket[LAT_BUCKETS]; // conteo por cubeta
+} lat_hist_t;
+
+void     lat_hist_reset(lat_hist_t *h);
+void     lat_hist_record(lat_hist_t *h, uint64_t ns);
+uint64_t lat_hist_percentile(const lat_hist_t *h, double p); // p en [0,100], valor en ns
+void     lat_hist_print(const lat_hist_t *h, const char *name, FILE *f); // p50/p99/p999/max
+
+/* ============ Latencia por pin ============ */
+
+void latency_mark(int pin, long long t_ns);    // flanco crudo en el pin de entrada
+void latency_done(int pin, long long t_ns);    // la salida ya reflejo el cambio
+void latency_cancel(int pin);                  // el cambio no llego a la salida
+
+const lat_hist_t *latency_hist(int pin);       // NULL si el pin no tiene muestras
+void latency_dump(FILE *f);                    // imprime todos los pines con muestras
+void latency_reset(void);                      // borra todo
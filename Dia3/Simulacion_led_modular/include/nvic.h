@@ -0,0 +1,72 @@
+#pragma once
+
+/*
+    nvic.h - controlador de interrupciones simulado (tipo NVIC de Cortex-M)
+
+    un "nucleo" de interrupciones: un hilo propio que corre los handlers.
+    - lineas IRQ numeradas 0..NVIC_IRQ_COUNT-1, cada una con handler,
+      prioridad (0 = la mas urgente) y bits de habilitada / pendiente / activa
+    - nvic_set_pending() desde cualquier hilo (un periferico, otro handler):
+      si el nucleo esta libre lo despierta (futex); si esta corriendo un
+      handler MENOS urgente, le manda una señal y el handler nuevo corre
+      anidado encima, en la pila del hilo, como la preempcion del NVIC.
+      Al terminar se retoma el de abajo. Con prioridad igual o menor espera
+      su turno (tail-chaining: se encadena sin volver a dormir)
+    - una linea pendiente que se vuelve a marcar antes de atenderse se
+      cuenta como perdida (como en HW: el bit pendiente es uno solo)
+    - nvic_gpio_route(): un flanco de gpio.h (EXTI) marca pendiente una IRQ
+
+    handlers: corren en el hilo del nucleo o dentro del manejador de la
+    señal, asi que deben ser cortos y "async-signal-safe" (nada de printf ni
+    malloc): marcar flags, guardar instantes, nvic_set_pending...
+    gpio_sim.c no es seguro entre hilos: un handler no debe escribir pines
+    que el loop tambien toca.
+
+    mascara global (PRIMASK): nvic_irq_lock() / nvic_irq_unlock() desde el
+    loop, para secciones criticas con datos de los handlers. lock espera a
+    que termine el handler en curso; mientras dura no entra ninguno.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "gpio.h"
+#include "latency.h"
+
+#define NVIC_IRQ_COUNT   64
+#define NVIC_PRIO_LEVELS 16 // prioridades 0..15
+
+typedef void (*nvic_handler_t)(int irq, void *arg);
+
+typedef struct{
+    uint64_t   count;     // veces que corrio el handler
+    uint64_t   nested;    // veces que entro interrumpiendo a otro handler
+    uint64_t   lost;      // marcas que cayeron sobre una ya pendiente
+    lat_hist_t latency;   // marcar pendiente -> entrar al handler (ns)
+} nvic_stats_t;
+
+int  nvic_init(void);      // arranca el hilo del nucleo. 0 si ok
+void nvic_shutdown(void);
+
+/*
+    Configuracion (con la linea deshabilitada). attach no la habilita.
+    -1 si irq, prioridad o handler no valen
+*/
+int  nvic_attach(int irq, nvic_handler_t handler, void *arg);
+int  nvic_set_priority(int irq, int prio);
+void nvic_enable(int irq);
+void nvic_disable(int irq);
+
+void nvic_set_pending(int irq);   // desde cualquier hilo o handler
+void nvic_clear_pending(int irq);
+int  nvic_is_pending(int irq);
+int  nvic_is_active(int irq);     // 1 si su handler esta corriendo (o interrumpido)
+
+void nvic_irq_lock(void);         // PRIMASK = 1 (no llamar desde un handler)
+void nvic_irq_unlock(void);
+
+// Un flanco del pin marca pendiente la irq (varios pines pueden compartir linea)
+int  nvic_gpio_route(int pin, gpio_edge_t edge, int irq);
+
+const nvic_stats_t *nvic_stats(int irq); // NULL si irq no vale
+void nvic_stats_reset(void);
+void nvic_dump(FILE *f);                 // lineas con actividad: cuenta, anidadas, perdidas, latencia
@@ -11,10 +11,31 @@
     de variables con numeros magicos.
 
     -Este archivo se cambiara cuando llegue el hardware, por ahora solo se simulan los pines
+
+    El mapa se declara UNA vez en PINS_TABLE (X-macro). De la misma tabla salen:
+    - el enum PIN_xxx (para la API normal gpio_read/gpio_write con pin variable)
+    - los accesores por pin pin_xxx_read()/pin_xxx_write() y pins_config() (gpio_pins.h)
+    - las validaciones en compilacion (pin fuera de rango, pin repetido)
+
+    Columnas: X(ID, nombre, numero, modo, pull)
+    - ID     : sufijo del enum (PIN_ID)
+    - nombre : sufijo de los accesores (pin_nombre_read)
+    - numero : pin fisico/simulado (puerto = numero/64)
+    - modo   : IN u OUT
+    - pull   : NOPULL, PULLUP o PULLDOWN (en salidas se ignora)
 */
 
+#include "gpio.h"
+
+#define PINS_TABLE(X)                                                    \
+    X(LED,    led,    0, OUT, NOPULL)   /* LED del sistema */            \
+    X(BUTTON, button, 1, IN,  PULLDOWN) /* Boton del usuario */         \
+    X(SPI_CS0, spi_cs0, 8, OUT, NOPULL) /* CS del 1er sensor SPI (activo en bajo) */
+
+#define PINS_ENUM_(id, name, num, mode, pull) PIN_##id = (num),
+#define PINS_COUNT_(id, name, num, mode, pull) + 1
+
 enum{
-    PIN_LED = 0, //LEd del sistema
-    PIN_BUTTON = 1, //Boton del usuario
-    PIN_COUNT //Numero total de pines definidos
-};
\ No newline at end of file
+    PINS_TABLE(PINS_ENUM_)
+    PIN_COUNT = 0 PINS_TABLE(PINS_COUNT_) //Numero total de pines definidos
+};
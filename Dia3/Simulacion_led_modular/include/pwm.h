@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+    pwm.h - motor de PWM por software, muchos canales sobre salidas de gpio.h
+
+    un canal = un pin de salida con un ciclo de trabajo (duty). Todos los
+    canales de un motor comparten el periodo y arrancan alineados:
+
+        inicio de periodo : suben todos los canales con duty > 0
+                            (un gpio_write_mask por puerto usado)
+        durante el periodo: bajan en orden de tiempo, segun su duty
+
+    - la lista de bajadas ("agenda") se arma ordenada UNA vez por periodo, y
+      solo si cambio algun duty: qsort O(c log c) y se juntan en una sola
+      escritura los canales del mismo puerto que bajan a la vez. Con la agenda
+      hecha, un periodo cuesta un gpio_write_mask por flanco distinto, sin
+      revisar todos los canales en cada tick.
+    - sin glitches: pwm_set_duty() (desde cualquier hilo) deja el duty en un
+      registro "sombra"; el motor lo toma recien al empezar el periodo
+      siguiente (como el preload de un timer de MCU). Nunca hay un periodo con
+      medio duty viejo y medio nuevo, ni pulsos extra.
+    - se puede correr desde el loop (pwm_step con el reloj que sea, real o
+      virtual) o en un hilo propio (pwm_start), que duerme hasta el proximo
+      flanco y mide cuan tarde llego cada uno (jitter) y la frecuencia real.
+
+    ojo: gpio_sim.c no es seguro entre hilos; con pwm_start los pines de los
+    canales deben estar en puertos que el resto del programa no escribe, y
+    sin volcado VCD (vcd.h tiene un solo productor).
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "gpio.h"
+#include "latency.h"
+
+#define PWM_DUTY_MAX 65536u // 100 %; duty = fraccion del periodo en 1/65536
+
+typedef struct{
+    long long at;    // bajada: ns desde el inicio del periodo
+    int       port;
+    uint64_t  mask;  // pines del puerto que bajan en "at"
+} pwm_edge_t;
+
+typedef struct{
+    // configuracion
+    long long         period_ns;
+    int               nchan;
+    int              *pin;        // pin de cada canal (-1 = sin asignar)
+    uint32_t         *duty;       // duty vigente (lo usa el motor)
+    _Atomic uint32_t *duty_next;  // duty pedido (registro sombra)
+    atomic_int        pending;    // 1 = hay duty nuevo para el proximo periodo
+
+    // agenda del periodo actual
+    pwm_edge_t       *edges;      // bajadas ordenadas por tiempo
+    int               nedges;
+    int               next;       // proximo evento: -1 = inicio de periodo, 0.. = edges[next]
+    long long         t_start;    // inicio del periodo actual (o del proximo si next == -1)
+    uint64_t          port_mask[GPIO_PORT_COUNT]; // pines de canales por puerto
+    uint64_t          port_set[GPIO_PORT_COUNT];  // pines que suben al inicio
+    int               ports[GPIO_PORT_COUNT];     // puertos con canales
+    int               nports;
+
+    // estadisticas
+    uint64_t          periods;    // periodos arrancados
+    uint64_t          edge_writes;// escrituras de bajada (varias bajadas juntas = 1)
+    uint64_t          rebuilds;   // agendas armadas (periodos con duty nuevo)
+    uint64_t          overruns;   // periodos salteados por ir mas de un periodo tarde
+    long long         t_first;    // inicio del primer periodo
+    long long         t_last;     // ultimo evento aplicado
+    lat_hist_t        jitter;     // atraso de cada evento respecto de su instante (ns)
+
+    // hilo (pwm_start)
+    pthread_t         thread;
+    atomic_int        stop;
+    int               running;
+    long long         spin_ns;    // los ultimos spin_ns antes de un flanco se esperan activos
+    long long         cpu_ns;     // CPU del hilo (al pararlo)
+} pwm_t;
+
+typedef struct{
+    uint64_t periods, edge_writes, rebuilds, overruns;
+    double   hz_target;   // 1 / periodo
+    double   hz_real;     // periodos / tiempo transcurrido
+    double   cpu_pct;     // CPU del hilo / tiempo transcurrido (solo con pwm_start)
+    uint64_t jitter_p50, jitter_p99, jitter_max; // ns
+} pwm_stats_t;
+
+/*
+    Reserva nchan canales sin pin y duty 0. Necesita gpio_init() hecho.
+    Retorna 0 si ok, -1 si no hay memoria o los parametros no valen
+*/
+int  pwm_init(pwm_t *p, int nchan, long long period_ns);
+void pwm_free(pwm_t *p);
+
+// Asigna el pin del canal y lo pone como salida. -1 si canal o pin no valen
+int  pwm_channel(pwm_t *p, int ch, int pin);
+
+// Pide un duty (0..PWM_DUTY_MAX) para el canal; se aplica al empezar el proximo periodo
+void pwm_set_duty(pwm_t *p, int ch, uint32_t duty);
+
+// Ancho del pulso en alto del periodo actual (ns), segun el duty vigente
+long long pwm_high_ns(const pwm_t *p, int ch);
+
+/*
+    Aplica todos los eventos con instante <= now (ns, mismo reloj que now_ns).
+    El primer llamado arranca el periodo en now. Retorna el instante del
+    proximo evento (para dormir o para el reloj virtual)
+*/
+long long pwm_step(pwm_t *p, long long now);
+
+/*
+    Hilo propio: duerme hasta cada evento (clock_nanosleep absoluto) y los
+    ultimos spin_ns los espera activo para llegar mas justo. 0 si ok
+*/
+int  pwm_start(pwm_t *p, long long spin_ns);
+void pwm_stop(pwm_t *p);
+
+void pwm_stats(const pwm_t *p, pwm_stats_t *st);
+void pwm_stats_reset(pwm_t *p);
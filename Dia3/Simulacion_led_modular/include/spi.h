@@ -0,0 +1,122 @@
+#pragma once
+
+/*
+    spi.h - API de bus SPI maestro (independiente del hardware), como gpio.h
+
+    implementaciones:
+    - spi_sim.c : bus simulado en PC, con esclavos de prueba (spi_dev.h)
+    - spi_hw.c  : periferico SPI + DMA del MCU (cuando llegue la placa)
+
+    una transaccion es un descriptor (spi_xfer_t) que arma quien llama:
+    punteros tx / rx, largo y pin de chip select (de pins.h). El motor
+    encola descriptores, no datos:
+    - nada se copia: el esclavo lee de x->tx y escribe en x->rx directamente
+      (en HW: el DMA apunta a esos mismos buffers)
+    - los buffers deben vivir hasta que el descriptor quede SPI_XFER_DONE
+    - full-duplex: tx y rx del mismo largo; tx NULL = manda 0xFF, rx NULL =
+      se descarta lo recibido
+    - spi_submit_batch() encola N descriptores de una vez (un sensor por
+      descriptor): leer muchos sensores por tick cuesta una llamada
+
+    tiempo: cada transaccion ocupa el bus cs_setup + len*8/hz + cs_hold, una
+    detras de otra (con gap_ns de CS alto entre medio). El reloj es el de
+    timeutil.h, asi que con el reloj virtual los tiempos son exactos y
+    reproducibles. spi_poll() completa las transacciones cuyo fin ya paso:
+    baja CS, intercambia datos con el esclavo, sube CS y llama el callback
+    (en el hilo del loop, como uart_poll)
+
+    CS es activo en bajo y se maneja con gpio_write(); spi_attach() deja el
+    pin como salida en alto.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPI_COUNT 2 // buses simulados (0..SPI_COUNT-1)
+
+typedef enum{
+    SPI_XFER_IDLE   = 0, // sin encolar (o ya leido)
+    SPI_XFER_QUEUED = 1, // esperando su turno en el bus
+    SPI_XFER_DONE   = 2  // rx ya tiene los datos
+} spi_xfer_status_t;
+
+typedef struct spi_xfer spi_xfer_t;
+typedef void (*spi_done_cb_t)(spi_xfer_t *x, void *arg);
+
+struct spi_xfer{
+    // los completa quien llama
+    const uint8_t *tx;       // MOSI (NULL = 0xFF)
+    uint8_t       *rx;       // MISO (NULL = descartar)
+    size_t         len;
+    int            cs;       // pin de chip select (PIN_xxx de pins.h)
+    int            keep_cs;  // 1 = no subir CS al final (comando y datos en dos descriptores)
+    spi_done_cb_t  done;     // puede ser NULL (mirar status)
+    void          *arg;
+
+    // los completa el motor
+    spi_xfer_status_t status;
+    long long      t_queued; // instantes en ns (reloj de timeutil.h)
+    long long      t_start;
+    long long      t_end;
+    spi_xfer_t    *next;
+};
+
+typedef struct{
+    uint32_t  hz;           // reloj SCK
+    long long cs_setup_ns;  // CS bajo -> primer flanco de SCK
+    long long cs_hold_ns;   // ultimo flanco -> CS alto
+    long long gap_ns;       // CS alto minimo entre transacciones
+} spi_cfg_t;
+
+/*
+    Esclavo simulado (ver spi_dev.h). xfer recibe los buffers del maestro
+    tal cual (mosi NULL = 0xFF, miso NULL = no escribir); puede llamarse mas
+    de una vez entre select y deselect (keep_cs)
+*/
+typedef struct{
+    void (*select)(void *ctx);     // CS bajo (puede ser NULL)
+    void (*xfer)(void *ctx, const uint8_t *mosi, uint8_t *miso, size_t len);
+    void (*deselect)(void *ctx);   // CS alto (puede ser NULL)
+    void *ctx;
+} spi_slave_t;
+
+typedef struct{
+    uint64_t  xfers;        // transacciones completas
+    uint64_t  bytes;
+    uint64_t  batches;      // llamadas a spi_submit / spi_submit_batch
+    long long busy_ns;      // bus ocupado (CS setup + bits + CS hold)
+    long long wire_ns;      // solo los bits
+    long long span_ns;      // de la primera transaccion al fin de la ultima
+    long long wait_max_ns;  // mayor espera en cola (encolada -> empieza)
+    double    utilization;  // busy_ns / span_ns (0..1)
+    double    overhead;     // (busy_ns - wire_ns) / busy_ns: costo fijo por transaccion
+} spi_stats_t;
+
+// Configura el bus. 0 si ok, -1 si el numero o el reloj no valen
+int  spi_init(int bus, const spi_cfg_t *cfg);
+void spi_deinit(int bus);
+
+/*
+    Conecta un esclavo al pin cs del bus (copia la estructura). slave NULL
+    desconecta y libera su lugar: lo que se lea de ese CS vale 0xFF (MISO con pull-up)
+*/
+int  spi_attach(int bus, int cs, const spi_slave_t *slave);
+
+/*
+    Encola una transaccion / n transacciones contiguas (xs[0..n-1]), en ese
+    orden. -1 si algun descriptor sigue encolado o no vale (nada se encola)
+*/
+int  spi_submit(int bus, spi_xfer_t *x);
+int  spi_submit_batch(int bus, spi_xfer_t *xs, size_t n);
+
+// Completa lo que ya termino en todos los buses. Retorna cuantas transacciones
+int  spi_poll(void);
+
+// Fin de la proxima transaccion pendiente (ns), -1 si no hay ninguna
+long long spi_next_ns(void);
+
+// Encola y espera (durmiendo con el reloj de timeutil.h) a que termine
+int  spi_transfer(int bus, spi_xfer_t *x);
+
+void spi_stats(int bus, spi_stats_t *st);
+void spi_stats_reset(int bus);
@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+    spi_dev.h - esclavos SPI simulados para probar drivers (solo simulacion)
+
+    dos modelos, cada uno da un spi_slave_t para spi_attach():
+
+    - spi_regdev_t: sensor tipico con mapa de 128 registros. El primer byte
+      de cada transaccion es el comando: bit 7 = 1 lectura, bits 6..0 =
+      registro; los bytes siguientes leen/escriben desde ahi con
+      auto-incremento (como un acelerometro o un barometro). "sample" se
+      llama al bajar CS: ahi el test pone la "medicion" en los registros.
+
+    - spi_script_t: guion de transacciones esperadas. Paso i = lo que el
+      maestro deberia mandar (expect, NULL = no se mira) y lo que el esclavo
+      contesta (reply, NULL = 0x00). Cuenta transacciones que no coinciden
+      con el guion: sirve para verificar un driver byte a byte.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "spi.h"
+
+#define SPI_REGDEV_REGS 128
+#define SPI_REGDEV_READ 0x80 // bit de lectura en el byte de comando
+
+typedef struct spi_regdev spi_regdev_t;
+
+struct spi_regdev{
+    uint8_t  regs[SPI_REGDEV_REGS];
+    void   (*sample)(spi_regdev_t *d, void *arg); // al bajar CS (puede ser NULL)
+    void    *arg;
+
+    // estado de la transaccion en curso
+    int      have_cmd;
+    int      reading;
+    uint8_t  addr;
+
+    uint64_t selects;   // transacciones
+    uint64_t writes;    // bytes escritos en registros
+};
+
+void        spi_regdev_init(spi_regdev_t *d);
+spi_slave_t spi_regdev_slave(spi_regdev_t *d);
+
+typedef struct{
+    const uint8_t *expect;  // MOSI esperado (NULL = cualquiera)
+    const uint8_t *reply;   // MISO a devolver (NULL = ceros)
+    size_t         len;
+} spi_script_step_t;
+
+typedef struct{
+    const spi_script_step_t *steps;
+    size_t   nsteps;
+    size_t   step;       // paso en curso
+    size_t   off;        // bytes del paso ya intercambiados
+    int      step_bad;
+    uint64_t mismatches; // pasos con MOSI o largo distinto al guion
+    uint64_t overruns;   // transacciones despues del ultimo paso
+} spi_script_t;
+
+void        spi_script_init(spi_script_t *s, const spi_script_step_t *steps, size_t nsteps);
+spi_slave_t spi_script_slave(spi_script_t *s);
+int         spi_script_done(const spi_script_t *s); // 1 si se cumplio todo el guion sin errores
@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+    spsc.h - cola lock-free de UN productor y UN consumidor (hilos distintos)
+
+    la cola solo maneja los indices: los datos van en un arreglo de quien la
+    usa, del mismo tamaño (potencia de 2). Asi sirve para cualquier tipo sin
+    copiar por void* ni macros.
+
+        productor:  long i = spsc_reserve(&q);      // -1 = llena
+                    if (i >= 0) { buf[i] = x; spsc_publish(&q); }
+
+        consumidor: size_t first, n = spsc_peek(&q, &first);
+                    for (k = 0; k < n; k++) usar(buf[(first + k) & q.mask]);
+                    spsc_consume(&q, n);
+
+    - wait-free: ninguna operacion espera ni reintenta
+    - por lotes (bytes de un UART, etc.): spsc_reserve_n / spsc_publish_n
+      y spsc_peek / spsc_consume con n > 1: un par de atomicos por bloque
+    - head y tail en lineas de cache separadas (sin false sharing), y cada
+      lado guarda una copia del indice del otro: solo lee el atomico
+      compartido cuando la copia dice lleno / vacio
+*/
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define SPSC_CACHELINE 64
+
+typedef struct{
+    size_t mask;                                  // capacidad - 1 (solo lectura)
+
+    _Alignas(SPSC_CACHELINE) atomic_size_t head;  // proximo a escribir (productor)
+    size_t tail_cache;                            // ultimo tail visto por el productor
+
+    _Alignas(SPSC_CACHELINE) atomic_size_t tail;  // proximo a leer (consumidor)
+    size_t head_cache;                            // ultimo head visto por el consumidor
+} spsc_t;
+
+// cap debe ser potencia de 2
+static inline void spsc_init(spsc_t *q, size_t cap){
+    q->mask = cap - 1;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->tail_cache = 0;
+    q->head_cache = 0;
+}
+
+/* ============ Productor ============ */
+
+// Indice del proximo hueco libre, -1 si la cola esta llena
+static inline long spsc_reserve(spsc_t *q){
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (h - q->tail_cache > q->mask) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (h - q->tail_cache > q->mask) {
+            return -1;
+        }
+    }
+    return (long)(h & q->mask);
+}
+
+// Hace visible al consumidor el hueco de spsc_reserve()
+static inline void spsc_publish(spsc_t *q){
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&q->head, h + 1, memory_order_release);
+}
+
+/*
+    Huecos libres (hasta la capacidad); *first = indice (sin enmascarar) del
+    primero. Relee el tail compartido solo si la copia da menos de "want"
+*/
+static inline size_t spsc_reserve_n(spsc_t *q, size_t want, size_t *first){
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t room = q->mask + 1 - (h - q->tail_cache);
+    if (room < want) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        room = q->mask + 1 - (h - q->tail_cache);
+    }
+    *first = h;
+    return room;
+}
+
+// Hace visibles n huecos de spsc_reserve_n() de una vez
+static inline void spsc_publish_n(spsc_t *q, size_t n){
+    size_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&q->head, h + n, memory_order_release);
+}
+
+/* ============ Consumidor ============ */
+
+// Cuantos elementos hay listos; *first = indice (sin enmascarar) del primero
+static inline size_t spsc_peek(spsc_t *q, size_t *first){
+    size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (q->head_cache == t) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+    }
+    *first = t;
+    return q->head_cache - t;
+}
+
+// Libera n elementos ya leidos
+static inline void spsc_consume(spsc_t *q, size_t n){
+    size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    atomic_store_explicit(&q->tail, t + n, memory_order_release);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+/*
+    task.h - tareas cooperativas sin pila (estilo protothreads)
+
+    el loop principal iba sumando "cosas que hacer en cada vuelta" (vaciar el
+    teclado, escribir los errores, ...): cada comportamiento nuevo era otro
+    if dentro del while, revisado en todas las vueltas. Con tareas:
+
+    - cada comportamiento es una funcion que se escribe como si fuera un hilo:
+          TASK_BEGIN(t);
+          for(;;){
+              TASK_WAIT_EVENT(t, EV_TECLADO);   // dormir hasta que llegue algo
+              ...
+              TASK_SLEEP_MS(t, 100);           // o hasta un instante
+          }
+          TASK_END(t);
+    - sin pila propia: la tarea retorna en cada espera y al volver salta a la
+      linea donde quedo (un switch sobre __LINE__). Las variables locales NO
+      sobreviven a una espera: lo que haga falta va en el struct o en static.
+      No poner dos esperas en la misma linea.
+    - el planificador solo corre tareas listas: una tarea esperando un
+      instante esta colgada de un timer (timer.h, O(1)) y una esperando un
+      evento no cuesta nada hasta que alguien le hace task_post(). Sumar
+      tareas dormidas no agrega trabajo al loop.
+    - cada corrida se mide con el reloj real (aunque el loop use el virtual):
+      corridas, tiempo total y maximo por tarea (task_dump).
+
+    todo en el hilo del loop (task_post incluido); otros hilos despiertan al
+    loop con event_signal() y el loop hace el task_post.
+
+    En HW real: lo mismo sobre el SysTick y el WFI.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "timer.h"
+#include "timeutil.h"
+
+typedef struct task task_t;
+
+// Cuerpo de la tarea: TASK_WAITING si quedo esperando, TASK_DONE si termino
+typedef int (*task_fn_t)(task_t *t);
+
+enum{ TASK_WAITING = 0, TASK_DONE = 1 };
+
+typedef enum{
+    TASK_READY = 0,   // en la cola de listas
+    TASK_WAIT_TIME,   // esperando un instante (timer armado)
+    TASK_WAIT_EVENT,  // esperando algun bit de wait_mask
+    TASK_FINISHED
+} task_state_t;
+
+struct task{
+    const char  *name;
+    task_fn_t    fn;
+    void        *arg;        // libre para la tarea
+    unsigned     pc;         // linea donde sigue (0 = inicio)
+    task_state_t state;
+    uint32_t     events;     // eventos recibidos y no consumidos
+    uint32_t     wait_mask;  // eventos que espera (TASK_WAIT_EVENT)
+    uint32_t     got;        // eventos que la despertaron (los consume la espera)
+    long long    deadline;   // instante esperado en ms (TASK_WAIT_TIME)
+    swtimer_t    timer;
+    task_t      *next_ready; // cola de listas (uso interno)
+    task_t      *next_all;   // lista de todas (uso interno)
+    // contabilidad (reloj real)
+    uint64_t     runs;
+    uint64_t     run_ns;     // tiempo total corriendo
+    uint64_t     max_ns;     // corrida mas larga
+};
+
+// Registra la tarea y la deja lista para su primera corrida
+void task_start(task_t *t, const char *name, task_fn_t fn, void *arg);
+
+// Saca la tarea del planificador (deja de correr y de contarse)
+void task_kill(task_t *t);
+
+// Le manda eventos (bits) a la tarea; si esperaba alguno, queda lista
+void task_post(task_t *t, uint32_t ev);
+
+/*
+    Corre una vez cada tarea que estaba lista al entrar (las que se despiertan
+    en el camino quedan para la proxima llamada: una tarea que cede sin parar
+    no traba el loop). Retorna cuantas corridas hizo
+*/
+int task_run_ready(void);
+
+// 1 si hay tareas listas para correr
+int task_any_ready(void);
+
+// Timeout para event_wait: 0 si hay tareas listas, si no timer_ms_until_next()
+long long task_ms_until_next(void);
+
+// Tabla de corridas y tiempos por tarea
+void task_dump(FILE *f);
+
+// Contadores de todas las tareas a cero
+void task_stats_reset(void);
+
+/*==========================================================
+=      MACROS DE LA TAREA (uso dentro de la funcion)       =
+==========================================================*/
+
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define TASK_FALLTHROUGH_ __attribute__((fallthrough))
+#else
+#define TASK_FALLTHROUGH_ ((void)0)
+#endif
+
+// uso interno de las macros
+int task_take_events_(task_t *t, uint32_t mask);
+int task_time_due_(task_t *t);
+void task_arm_(task_t *t, long long at_ms);
+void task_ready_(task_t *t);
+
+#define TASK_BEGIN(t)  switch ((t)->pc) { case 0:
+
+#define TASK_END(t)    } (t)->pc = 0; return TASK_DONE
+
+// Espera hasta que llegue alguno de los eventos de mask (si ya habia, sigue sin esperar)
+#define TASK_WAIT_EVENT(t, mask)                                  \
+    do {                                                          \
+        (t)->pc = __LINE__;                                       \
+        TASK_FALLTHROUGH_;                                        \
+    case __LINE__:                                                \
+        if (!task_take_events_((t), (mask))) return TASK_WAITING; \
+    } while (0)
+
+// Espera hasta el instante absoluto at_ms (base de tick_ms/now_ms)
+#define TASK_WAIT_UNTIL(t, at_ms)                                 \
+    do {                                                          \
+        task_arm_((t), (at_ms));                                  \
+        (t)->pc = __LINE__;                                       \
+        TASK_FALLTHROUGH_;                                        \
+    case __LINE__:                                                \
+        if (!task_time_due_(t)) return TASK_WAITING;              \
+    } while (0)
+
+// Espera ms desde ahora (tick_ms del loop)
+#define TASK_SLEEP_MS(t, ms)    TASK_WAIT_UNTIL((t), tick_ms() + (ms))
+
+// Espera ms desde el instante esperado anterior: periodo sin acumular error
+#define TASK_EVERY_MS(t, ms)    TASK_WAIT_UNTIL((t), (t)->deadline + (ms))
+
+// Cede el turno: vuelve a correr despues de las demas tareas listas
+#define TASK_YIELD(t)                                             \
+    do {                                                          \
+        task_ready_(t);                                           \
+        (t)->pc = __LINE__;                                       \
+        return TASK_WAITING;                                      \
+    case __LINE__:;                                               \
+    } while (0)
+
+// Eventos que desperto la ultima TASK_WAIT_EVENT
+#define TASK_EVENTS(t)  ((t)->got)
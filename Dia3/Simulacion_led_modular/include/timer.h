@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+    timer.h - temporizadores por software (rueda jerarquica) sobre timeutil
+
+    reemplaza el patron:
+        if (now_ms() >= next_tick) { ...; next_tick += POLL_MS; }
+        sleep_ms(1);
+    por timers one-shot o periodicos con callback, y un loop que duerme
+    exactamente hasta el proximo vencimiento (tickless).
+
+    - resolucion: 1 ms (misma base que now_ms)
+    - timer_start / timer_stop: O(1)
+    - el swtimer_t lo reserva quien lo usa (static, en un struct, etc.):
+      el servicio no hace malloc
+*/
+
+typedef struct swtimer swtimer_t;
+
+typedef void (*swtimer_cb_t)(swtimer_t *t, void *arg);
+
+struct swtimer{
+    swtimer_t  *next;     // lista del slot (uso interno)
+    swtimer_t **pprev;    // puntero al "next" anterior o a la cabeza del slot
+    long long   expires;  // vencimiento absoluto en ms
+    long long   period;   // 0 = one-shot, >0 = periodico
+    swtimer_cb_t cb;      // funcion a llamar al vencer
+    void       *arg;      // argumento para cb
+    int         level;    // nivel de la rueda (uso interno, -1 = lista lejana)
+    int         slot;     // slot dentro del nivel (uso interno)
+};
+
+// Arranca el servicio con el reloj en now_ms(). Llamar una vez al inicio
+void timer_service_init(void);
+
+// Prepara un timer (no lo arranca)
+void timer_setup(swtimer_t *t, swtimer_cb_t cb, void *arg);
+
+/*
+    Arranca (o re-arranca) el timer para vencer en delay_ms.
+    period_ms > 0 -> periodico, vuelve a vencer cada period_ms sin acumular error
+*/
+void timer_start(swtimer_t *t, long long delay_ms, long long period_ms);
+
+// Igual que timer_start pero con vencimiento absoluto (base de now_ms)
+void timer_start_at(swtimer_t *t, long long at_ms, long long period_ms);
+
+// Cancela el timer (no pasa nada si no estaba activo)
+void timer_stop(swtimer_t *t);
+
+// 1 si el timer esta armado
+int timer_active(const swtimer_t *t);
+
+// Vencimiento absoluto mas cercano, -1 si no hay timers armados
+long long timer_next_deadline(void);
+
+// ms hasta el proximo vencimiento (0 si ya vencio), -1 si no hay timers (para event_wait)
+long long timer_ms_until_next(void);
+
+// Ejecuta todos los timers con vencimiento <= now. Retorna cuantos disparo
+int timer_run_due(long long now);
+
+/*
+    Duerme hasta el proximo vencimiento (clock_nanosleep absoluto) y ejecuta
+    lo que haya vencido. Retorna cuantos disparo, -1 si no hay timers armados
+*/
+int timer_run_until_next(void);
+
+/*
+    Para simulacion con reloj virtual (vclock_enable): lleva el reloj hasta t_ns
+    pasando por cada vencimiento intermedio, igual que haria el loop real al
+    despertarse por timer, y deja el tick en t_ns. Retorna cuantos timers disparo
+*/
+long long timer_vclock_run_until(long long t_ns);
@@ -2,8 +2,66 @@
 
 /*
     timeutil.h - Utilidades de tiempo para temporizadores no bloquiantes
+
+    el reloj es "enchufable" (time_source_t):
+    - TIME_SOURCE_REAL    -> CLOCK_MONOTONIC y sleeps de verdad (por defecto)
+    - TIME_SOURCE_VIRTUAL -> reloj simulado: dormir = adelantar el reloj al instante
+      siguiente. Sirve para correr escenarios largos en milisegundos y con
+      resultados identicos en cada corrida (sin jitter del scheduler)
+
+    resolucion interna: nanosegundos. now_ms()/now_us() son la misma lectura
+    truncada.
 */
 
+#include <stdatomic.h>
+
+long long now_ns(void); // Tiempo actual en nanosegundos
+long long now_us(void); // Tiempo actual en microsegundos
 long long now_ms(void); // Devuelve el tiempo actual en milisegundos desde el inicio del programa
 
 void sleep_ms(long long ms); // Suspende la ejecución durante el número de milisegundos especificado
+void sleep_us(long long us); // Igual pero en microsegundos
+
+void sleep_until_ms(long long deadline_ms); // Duerme hasta el instante absoluto deadline_ms (misma base que now_ms)
+void sleep_until_ns(long long deadline_ns); // Igual pero en nanosegundos
+
+/* ============ Tiempo del tick ============
+    Una lectura del reloj por iteracion del loop, compartida por todos:
+    - el loop llama tick_update() UNA vez al despertar
+    - debounce, timers, etc. leen tick_ns()/tick_us()/tick_ms(): una carga
+      de memoria en vez de un clock_gettime por pin
+    - antes del primer tick_update() valen 0
+    - es atomico relajado (en x86-64 / ARM64 la misma carga de siempre):
+      otro hilo lo puede leer sin carrera, pero ve el tick del loop, que puede
+      estar atrasado. Un hilo que no es el loop y necesita la hora usa now_ns()
+*/
+
+extern atomic_llong tick_now_ns; // ultimo instante muestreado (no escribir a mano)
+
+long long tick_update(void); // muestrea el reloj y retorna el instante en ns
+
+static inline long long tick_ns(void){ return atomic_load_explicit(&tick_now_ns, memory_order_relaxed); }
+static inline long long tick_us(void){ return tick_ns() / 1000LL; }
+static inline long long tick_ms(void){ return tick_ns() / 1000000LL; }
+
+/* ============ Fuente de reloj ============ */
+
+typedef struct{
+    long long (*now_ns)(void);                    // instante actual
+    void      (*sleep_ns)(long long ns);          // dormir relativo
+    void      (*sleep_until_ns)(long long at_ns); // dormir hasta instante absoluto
+} time_source_t;
+
+extern const time_source_t TIME_SOURCE_REAL;
+extern const time_source_t TIME_SOURCE_VIRTUAL;
+
+void time_source_set(const time_source_t *src); // NULL = volver al reloj real
+int  time_is_virtual(void);                     // 1 si el reloj activo es el virtual
+
+/* ============ Reloj virtual ============ */
+
+void vclock_enable(long long start_ms);  // usar el reloj virtual empezando en start_ms
+void vclock_set_ms(long long t_ms);      // mover el reloj a t_ms (nunca hacia atras)
+void vclock_advance_ms(long long ms);    // adelantar el reloj ms milisegundos
+void vclock_set_ns(long long t_ns);      // igual que vclock_set_ms con resolucion de ns
+void vclock_advance_ns(long long ns);    // igual que vclock_advance_ms con resolucion de ns
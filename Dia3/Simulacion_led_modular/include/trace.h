@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+    trace.h - trazas binarias de transiciones crudas de pines
+
+    formato (little endian, registros de tamaño fijo -> se puede mapear con mmap
+    y recorrer como un arreglo):
+
+        trace_header_t                 (32 bytes)
+        trace_rec_t * count            (8 bytes cada uno)
+
+    cada registro guarda el tiempo como DELTA en us desde el registro anterior
+    (el primero, desde t0_ns del header). Si un delta no entra en 32 bits
+    (~71 min sin actividad) se escribe un registro TRACE_F_TIME que solo
+    adelanta el tiempo.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#define TRACE_MAGIC   0x52545047u  // "GPTR"
+#define TRACE_VERSION 1
+
+#define TRACE_F_TIME  0x01  // registro que solo adelanta el tiempo (pin/value no valen)
+
+typedef struct{
+    uint32_t magic;     // TRACE_MAGIC
+    uint16_t version;   // TRACE_VERSION
+    uint16_t rec_size;  // sizeof(trace_rec_t)
+    uint64_t count;     // cantidad de registros
+    int64_t  t0_ns;     // instante del inicio de la traza
+    uint64_t reserved;
+} trace_header_t;
+
+typedef struct{
+    uint32_t dt_us;     // tiempo desde el registro anterior
+    uint16_t pin;       // pin de entrada
+    uint8_t  value;     // nivel crudo nuevo (0/1)
+    uint8_t  flags;     // TRACE_F_*
+} trace_rec_t;
+
+/* ============ Escritura ============ */
+
+typedef struct trace_writer{
+    FILE     *f;
+    uint64_t  count;
+    long long t0_ns;    // inicio de la traza (va en el header)
+    long long last_us;  // instante del ultimo registro (us)
+    char     *buf;      // buffer grande para escribir en bloques
+} trace_writer_t;
+
+int  trace_writer_open(trace_writer_t *w, const char *path, long long t0_ns); // 0 ok, -1 error
+void trace_writer_add(trace_writer_t *w, long long t_ns, int pin, int value);
+int  trace_writer_close(trace_writer_t *w); // reescribe el header con el total
+
+/* ============ Lectura (mmap) ============ */
+
+typedef struct{
+    const trace_header_t *hdr;
+    const trace_rec_t    *rec;   // arreglo de hdr->count registros
+    size_t                size;  // bytes mapeados
+    size_t                pos;   // proximo registro a leer
+    long long             t_us;  // tiempo acumulado
+} trace_reader_t;
+
+int  trace_reader_open(trace_reader_t *r, const char *path); // 0 ok, -1 error
+void trace_reader_close(trace_reader_t *r);
+
+/*
+    Proxima transicion: 1 si hay, 0 si se termino la traza.
+    t_ns = instante absoluto (misma base que la grabacion)
+*/
+int  trace_reader_next(trace_reader_t *r, long long *t_ns, int *pin, int *value);
+void trace_reader_rewind(trace_reader_t *r);
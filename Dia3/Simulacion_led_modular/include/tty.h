@@ -11,4 +11,12 @@
 
 void tty_raw_enable(void); // Habilita el modo raw de la terminal
 void tty_raw_disable(void); // Deshabilita el modo raw de la terminal al salir del programa
-int  tty_getch_nonblock(void); // -1 si no hay tecla
\ No newline at end of file
+int  tty_getch_nonblock(void); // -1 si no hay tecla (lee por rafagas y entrega de a un byte)
+
+#define TTY_BURST_MAX 4096 // bytes maximos por lectura
+
+/*
+    Lee de una sola vez todo lo pendiente en fd (hasta max bytes).
+    >0 = bytes leidos, 0 = no habia nada, -1 = fin de archivo o error
+*/
+int  tty_read_burst(int fd, unsigned char *buf, int max);
\ No newline at end of file
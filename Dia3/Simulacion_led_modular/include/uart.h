@@ -0,0 +1,90 @@
+#pragma once
+
+/*
+    uart.h - API de UART (independiente del hardware), como gpio.h
+
+    implementaciones:
+    - uart_sim.c : UART simulado en PC (este)
+    - uart_hw.c  : registros / DMA del MCU (cuando llegue la placa)
+
+    la idea es la del DMA de un micro: el firmware no toca cada byte.
+    - TX: uart_write() copia un bloque a un anillo y retorna; la "linea"
+      los saca a la velocidad del baud. UART_EV_TX_LOW avisa cuando el
+      anillo bajo de la mitad, para rellenar de a bloques.
+    - RX con anillo: uart_read() saca lo que haya, de a bloques.
+    - RX con DMA circular: uart_rx_dma_start(buf, len) y la linea escribe
+      directo en buf. Avisos de media transferencia (HALF), vuelta completa
+      (FULL) e IDLE (la linea quedo callada un caracter despues de recibir):
+      el callback recibe la posicion de escritura y procesa de a bloques
+      desde la posicion anterior (el patron de HAL_UARTEx_RxEventCallback).
+
+    los callbacks corren en el hilo del loop, dentro de uart_poll(), igual
+    que los handlers de gpio_poll(); la simulacion despierta al loop con
+    event_signal(). Un UART se conecta a otro (cable cruzado), a si mismo
+    (loopback) o a nada (lo transmitido se descarta).
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define UART_COUNT 4 // UARTs simulados (0..UART_COUNT-1)
+
+typedef enum{
+    UART_EV_RX_HALF = 0x1, // DMA: buf[0 .. len/2) completo
+    UART_EV_RX_FULL = 0x2, // DMA: buf completo, vuelve a empezar
+    UART_EV_RX_IDLE = 0x4, // linea callada despues de recibir (fin de mensaje)
+    UART_EV_RX_DATA = 0x8, // (sin DMA) hay bytes en el anillo de RX
+    UART_EV_TX_LOW  = 0x10 // el anillo de TX bajo de la mitad: se puede rellenar
+} uart_event_t;
+
+/*
+    Aviso de eventos (mascara de uart_event_t). pos = posicion de escritura
+    del DMA de RX en ese momento (0..len-1), 0 si no hay DMA
+*/
+typedef void (*uart_cb_t)(int uart, unsigned events, size_t pos, void *arg);
+
+typedef struct{
+    uint32_t  baud;     // bits por segundo (8N1: 10 bits por byte)
+    int       peer;     // UART del otro lado: -1 = nada, el mismo = loopback
+    size_t    tx_size;  // anillo de TX en bytes (potencia de 2, 0 = 4096)
+    size_t    rx_size;  // anillo de RX en bytes (potencia de 2, 0 = 4096)
+    uart_cb_t cb;       // puede ser NULL
+    void     *arg;
+} uart_cfg_t;
+
+typedef struct{
+    uint64_t tx_bytes;    // bytes que salieron por la linea
+    uint64_t rx_bytes;    // bytes que llegaron (anillo o DMA)
+    uint64_t rx_dropped;  // llegaron con el anillo de RX lleno
+    uint64_t events;      // callbacks llamados
+    uint64_t wakeups;     // veces que la linea desperto al loop
+} uart_stats_t;
+
+/*
+    Configura el UART y arranca su linea. Retorna 0 si ok, -1 si el numero,
+    el peer o los tamaños no valen, o no hay memoria
+*/
+int  uart_init(int uart, const uart_cfg_t *cfg);
+void uart_deinit(int uart);
+
+// Copia hasta len bytes al anillo de TX. Retorna cuantos entraron
+size_t uart_write(int uart, const void *data, size_t len);
+size_t uart_tx_free(int uart);      // bytes libres en el anillo de TX
+int    uart_tx_idle(int uart);      // 1 si no queda nada por transmitir
+
+// Saca hasta len bytes del anillo de RX (sin DMA). Retorna cuantos
+size_t uart_read(int uart, void *data, size_t len);
+size_t uart_rx_available(int uart);
+
+/*
+    RX por DMA circular sobre buf (len par, >= 2). Mientras esta activo, lo
+    recibido va a buf y no al anillo. Retorna 0 si ok
+*/
+int    uart_rx_dma_start(int uart, void *buf, size_t len);
+void   uart_rx_dma_stop(int uart);
+size_t uart_rx_dma_pos(int uart);   // posicion de escritura actual
+
+// Llama los callbacks de los eventos pendientes de todos los UART (hilo del loop)
+void uart_poll(void);
+
+void uart_stats(int uart, uart_stats_t *st);
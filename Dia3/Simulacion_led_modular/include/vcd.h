@@ -0,0 +1,41 @@
+#pragma once
+
+/*
+    vcd.h - volcado de la actividad de pines en formato VCD (Value Change Dump)
+
+    el archivo se abre con GTKWave (u otro visor de ondas) y muestra el rebote
+    crudo de las entradas junto con la respuesta de las salidas.
+
+    - gpio_sim.c llama vcd_change() en cada cambio de nivel de gpio_write,
+      gpio_port_write, gpio_write_mask y gpio_simulate_input
+    - vcd_change() solo deja el cambio en una cola lock-free (spsc.h); un hilo
+      aparte lo formatea y escribe en bloques grandes. El loop de control
+      nunca espera al disco
+    - si la cola se llena (disco muy lento) el cambio se descarta y se cuenta
+      en "dropped": nunca se bloquea
+    - un solo hilo productor: el que llama a las funciones de gpio
+*/
+
+#include <stdint.h>
+
+extern int vcd_active; // 1 entre vcd_open() y vcd_close() (no escribir a mano)
+
+typedef struct{
+    uint64_t changes;  // cambios escritos al archivo
+    uint64_t dropped;  // cambios descartados por cola llena
+} vcd_stats_t;
+
+/*
+    Abre el archivo, declara los pines a volcar (names puede ser NULL -> "pinN")
+    con su nivel actual y arranca el hilo escritor. Retorna 0 si ok, -1 si error
+*/
+int vcd_open(const char *path, const int *pins, const char *const *names, int npins);
+
+// Registra un cambio de nivel (los pines no declarados se ignoran)
+void vcd_change(long long t_ns, int pin, int value);
+
+// Vacia la cola, para el hilo y cierra el archivo. Retorna 0 si ok
+int vcd_close(void);
+
+// Totales de la ultima sesion (valido despues de vcd_close)
+void vcd_stats(vcd_stats_t *s);
@@ -0,0 +1,210 @@
+/*
+  adc_bench.c — Muestras por segundo por núcleo en cada etapa de adquisición
+
+  El ADC simulado corre en tiempo VIRTUAL (unos segundos de señal en lo que
+  tarde la CPU) y en cada mitad del buffer doble el callback pasa el bloque
+  por la cadena de adc_filter.h:
+
+      ADC (generador) -> a float -> media móvil -> IIR -> decimación
+
+  Cada etapa se cronometra en reloj real y se reporta ns por muestra y
+  millones de muestras por segundo (una muestra = un canal de un frame).
+  Como referencia, el mismo IIR llamado una muestra por vez
+  (adc_iir_step). El último canal es DC sin ruido: la media móvil y la
+  decimación deben devolver exactamente ese valor (verificación).
+
+  Uso:
+    ./bin/adc [-c canales] [-r frames/s] [-b bloque] [-t segundos] [-m media] [-a alfa] [-d factor]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "adc.h"
+#include "adc_filter.h"
+#include "timeutil.h"
+
+#define DC_LEVEL 1234
+
+typedef struct{
+    int       nchan;
+    uint32_t  rate;
+    size_t    block;
+    double    secs;
+    int       ma_len;
+    double    alpha;
+    int       decim;
+} adc_opts_t;
+
+enum{ ST_TO_FLOAT, ST_MA, ST_IIR, ST_DECIM, ST_IIR_STEP, ST_COUNT };
+
+typedef struct{
+    int         nchan;
+    float      *f_in, *f_ma, *f_ref;
+    adc_ma_t    ma;
+    adc_iir_t   iir, iir_ref;
+    adc_decim_t dec;
+    long long   ns[ST_COUNT];
+    uint64_t    samples[ST_COUNT];
+    long long   cb_ns;       // todo el callback (para descontarlo del generador)
+    uint64_t    blocks;
+    uint64_t    bad;         // salidas del canal DC distintas de DC_LEVEL
+} pipe_t;
+
+static void on_block(const uint16_t *frames, size_t n, void *arg){
+    pipe_t *p = arg;
+    size_t nc = (size_t)p->nchan;
+    size_t count = n * nc;
+    long long t_cb = TIME_SOURCE_REAL.now_ns();
+    long long t0 = t_cb, t1;
+
+    adc_to_float(frames, p->f_in, count);
+    t1 = TIME_SOURCE_REAL.now_ns(); p->ns[ST_TO_FLOAT] += t1 - t0; p->samples[ST_TO_FLOAT] += count; t0 = t1;
+
+    adc_ma_run(&p->ma, p->f_in, p->f_ma, n);
+    t1 = TIME_SOURCE_REAL.now_ns(); p->ns[ST_MA] += t1 - t0; p->samples[ST_MA] += count; t0 = t1;
+
+    // chequeo de la media movil antes de que el IIR la pise (solo con historia llena)
+    if (p->blocks * n >= (size_t)p->ma.len) {
+        p->bad += (p->f_ma[(n - 1) * nc + nc - 1] != (float)DC_LEVEL);
+    }
+
+    adc_iir_run(&p->iir, p->f_ma, p->f_ma, n);
+    t1 = TIME_SOURCE_REAL.now_ns(); p->ns[ST_IIR] += t1 - t0; p->samples[ST_IIR] += count; t0 = t1;
+
+    size_t nout = adc_decim_run(&p->dec, p->f_in, p->f_in, n);
+    t1 = TIME_SOURCE_REAL.now_ns(); p->ns[ST_DECIM] += t1 - t0; p->samples[ST_DECIM] += count; t0 = t1;
+    for (size_t k = 0; k < nout; k++) {
+        p->bad += (p->f_in[k * nc + nc - 1] != (float)DC_LEVEL);
+    }
+
+    // referencia: una llamada por muestra
+    for (size_t i = 0; i < n; i++) {
+        for (size_t ch = 0; ch < nc; ch++) {
+            p->f_ref[i * nc + ch] = adc_iir_step(&p->iir_ref, (int)ch, p->f_ma[i * nc + ch]);
+        }
+    }
+    t1 = TIME_SOURCE_REAL.now_ns(); p->ns[ST_IIR_STEP] += t1 - t0; p->samples[ST_IIR_STEP] += count;
+
+    p->blocks++;
+    p->cb_ns += TIME_SOURCE_REAL.now_ns() - t_cb;
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-c canales] [-r frames/s] [-b bloque] [-t segundos] [-m media] [-a alfa] [-d factor]\n"
+            "  -c  canales del ADC, 1..%d (por defecto 8)\n"
+            "  -r  frames por segundo (por defecto 1000000)\n"
+            "  -b  frames por mitad del buffer doble (por defecto 256)\n"
+            "  -t  segundos de señal, en tiempo virtual (por defecto 4)\n"
+            "  -m  largo de la media móvil (por defecto 16)\n"
+            "  -a  alfa del IIR (por defecto 0.05)\n"
+            "  -d  factor de decimación (por defecto 8)\n", argv0, ADC_CHANNELS_MAX);
+}
+
+int main(int argc, char **argv){
+    adc_opts_t o = { .nchan = 8, .rate = 1000000, .block = 256, .secs = 4, .ma_len = 16,
+                     .alpha = 0.05, .decim = 8 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-c") == 0) {
+            o.nchan = atoi(v);
+        } else if (strcmp(a, "-r") == 0) {
+            o.rate = (uint32_t)atol(v);
+        } else if (strcmp(a, "-b") == 0) {
+            o.block = (size_t)atol(v);
+        } else if (strcmp(a, "-t") == 0) {
+            o.secs = atof(v);
+        } else if (strcmp(a, "-m") == 0) {
+            o.ma_len = atoi(v);
+        } else if (strcmp(a, "-a") == 0) {
+            o.alpha = atof(v);
+        } else if (strcmp(a, "-d") == 0) {
+            o.decim = atoi(v);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.nchan < 1 || o.nchan > ADC_CHANNELS_MAX || o.rate == 0 || o.block == 0 || o.secs <= 0 ||
+        o.ma_len < 1 || o.decim < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    pipe_t p = { .nchan = o.nchan };
+    size_t count = o.block * (size_t)o.nchan;
+    p.f_in  = malloc(count * sizeof(float));
+    p.f_ma  = malloc(count * sizeof(float));
+    p.f_ref = malloc(count * sizeof(float));
+    if (p.f_in == NULL || p.f_ma == NULL || p.f_ref == NULL || adc_ma_init(&p.ma, o.nchan, o.ma_len) != 0) {
+        fprintf(stderr, "adc: sin memoria\n");
+        return 1;
+    }
+    if (adc_iir_init(&p.iir, o.nchan, (float)o.alpha) != 0 || adc_iir_init(&p.iir_ref, o.nchan, (float)o.alpha) != 0 ||
+        adc_decim_init(&p.dec, o.nchan, o.decim) != 0) {
+        fprintf(stderr, "adc: filtro no válido (alpha en (0, 1], decimación >= 1)\n");
+        return 1;
+    }
+
+    vclock_enable(0);
+    adc_cfg_t cfg = { .nchan = o.nchan, .rate_hz = o.rate, .block = o.block, .cb = on_block, .arg = &p };
+    if (adc_init(&cfg) != 0) {
+        fprintf(stderr, "adc: configuración no válida\n");
+        return 1;
+    }
+    // señales variadas; el último canal queda en DC para la verificación
+    for (int ch = 0; ch < o.nchan - 1; ch++) {
+        adc_wave_t w = { .kind = (adc_wave_kind_t)(1 + ch % 3), .freq_hz = 50.0 * (ch + 1),
+                         .amp = 1500, .offset = 2048, .noise = 20 };
+        adc_set_wave(ch, &w);
+    }
+    adc_wave_t dc = { .kind = ADC_WAVE_DC, .offset = DC_LEVEL };
+    adc_set_wave(o.nchan - 1, &dc);
+
+    adc_start();
+    long long t_end = now_ns() + (long long)(o.secs * 1e9);
+    long long gen_ns = 0;
+    while (now_ns() < t_end) {
+        vclock_set_ns(adc_next_ns());
+        long long cb0 = p.cb_ns;
+        long long t0 = TIME_SOURCE_REAL.now_ns();
+        adc_poll();
+        long long t1 = TIME_SOURCE_REAL.now_ns();
+        gen_ns += (t1 - t0) - (p.cb_ns - cb0);
+    }
+    adc_stop();
+
+    adc_stats_t st;
+    adc_stats(&st);
+    uint64_t samples = st.frames * (uint64_t)o.nchan;
+    printf("ADC: %d canales a %u frames/s, bloques de %zu frames, %.1f s de señal (virtual)\n",
+           o.nchan, o.rate, o.block, o.secs);
+    printf("     %llu muestras, %llu bloques, %llu pisados\n\n",
+           (unsigned long long)samples, (unsigned long long)st.blocks, (unsigned long long)st.overruns);
+
+    static const char *names[ST_COUNT] = { "a float", "media movil", "IIR (bloque)", "decimacion", "IIR por muestra" };
+    printf("%-18s %12s %10s %14s\n", "etapa", "muestras", "ns/muestra", "M muestras/s");
+    printf("%-18s %12llu %10.2f %14.1f\n", "ADC (generador)", (unsigned long long)samples,
+           (double)gen_ns / (double)samples, (double)samples / ((double)gen_ns / 1e9) / 1e6);
+    for (int s = 0; s < ST_COUNT; s++) {
+        double ns = (double)p.ns[s] / (double)p.samples[s];
+        printf("%-18s %12llu %10.2f %14.1f\n", names[s], (unsigned long long)p.samples[s], ns, 1e3 / ns);
+    }
+    double chain = (double)(gen_ns + p.ns[ST_TO_FLOAT] + p.ns[ST_MA] + p.ns[ST_IIR] + p.ns[ST_DECIM]) / (double)samples;
+    printf("%-18s %12s %10.2f %14.1f\n", "cadena completa", "", chain, 1e3 / chain);
+    printf("\nverificación (canal DC, media y decimación exactas): %s\n", p.bad == 0 ? "ok" : "FALLA");
+
+    adc_deinit();
+    adc_ma_free(&p.ma);
+    free(p.f_in);
+    free(p.f_ma);
+    free(p.f_ref);
+    time_source_set(NULL);
+    return p.bad != 0;
+}
@@ -0,0 +1,146 @@
+/*
+    adc_filter.c — Filtros por bloques (ver adc_filter.h)
+
+    Patrón de todos los lazos: afuera los frames (en orden, por la
+    recursión), adentro los canales con el estado en arreglos locales
+    contiguos. Sin llamadas ni ramas adentro: el lazo interno se vectoriza.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "adc_filter.h"
+
+void adc_to_float(const uint16_t *restrict in, float *restrict out, size_t count){
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (float)in[i];
+    }
+}
+
+/*==========================================================
+=                       MEDIA MÓVIL                        =
+==========================================================*/
+
+int adc_ma_init(adc_ma_t *f, int nchan, int len){
+    memset(f, 0, sizeof(*f));
+    if (nchan < 1 || nchan > ADC_CHANNELS_MAX || len < 1) {
+        return -1;
+    }
+    f->hist = calloc((size_t)len * (size_t)nchan, sizeof(float));
+    if (f->hist == NULL) {
+        return -1;
+    }
+    f->nchan = nchan;
+    f->len   = len;
+    f->inv   = 1.0f / (float)len;
+    return 0;
+}
+
+void adc_ma_free(adc_ma_t *f){
+    free(f->hist);
+    f->hist = NULL;
+}
+
+void adc_ma_run(adc_ma_t *f, const float *restrict in, float *restrict out, size_t frames){
+    const int nc  = f->nchan;
+    const float inv = f->inv;
+    float sum[ADC_CHANNELS_MAX];
+    memcpy(sum, f->sum, sizeof(sum));
+    int pos = f->pos;
+
+    for (size_t i = 0; i < frames; i++) {
+        const float *restrict x = in + i * (size_t)nc;
+        float *restrict y = out + i * (size_t)nc;
+        float *restrict h = f->hist + (size_t)pos * (size_t)nc;
+        for (int ch = 0; ch < nc; ch++) {
+            float s = sum[ch] + x[ch] - h[ch];
+            h[ch]   = x[ch];
+            sum[ch] = s;
+            y[ch]   = s * inv;
+        }
+        if (++pos == f->len) {
+            pos = 0;
+        }
+    }
+    memcpy(f->sum, sum, sizeof(sum));
+    f->pos = pos;
+}
+
+/*==========================================================
+=                     IIR DE 1ER ORDEN                     =
+==========================================================*/
+
+int adc_iir_init(adc_iir_t *f, int nchan, float alpha){
+    memset(f, 0, sizeof(*f));
+    // !(alpha > 0) también descarta NaN
+    if (nchan < 1 || nchan > ADC_CHANNELS_MAX || !(alpha > 0.0f) || alpha > 1.0f) {
+        return -1;
+    }
+    f->nchan = nchan;
+    f->alpha = alpha;
+    return 0;
+}
+
+void adc_iir_run(adc_iir_t *f, const float *in, float *out, size_t frames){
+    const int nc = f->nchan;
+    const float a = f->alpha;
+    float y[ADC_CHANNELS_MAX];
+    memcpy(y, f->y, sizeof(y));
+
+    for (size_t i = 0; i < frames; i++) {
+        const float *x = in + i * (size_t)nc;
+        float *o = out + i * (size_t)nc;
+        for (int ch = 0; ch < nc; ch++) {
+            y[ch] += a * (x[ch] - y[ch]);
+            o[ch]  = y[ch];
+        }
+    }
+    memcpy(f->y, y, sizeof(y));
+}
+
+float adc_iir_step(adc_iir_t *f, int ch, float x){
+    f->y[ch] += f->alpha * (x - f->y[ch]);
+    return f->y[ch];
+}
+
+/*==========================================================
+=                        DECIMACIÓN                        =
+==========================================================*/
+
+int adc_decim_init(adc_decim_t *f, int nchan, int factor){
+    memset(f, 0, sizeof(*f));
+    if (nchan < 1 || nchan > ADC_CHANNELS_MAX || factor < 1) {
+        return -1;
+    }
+    f->nchan  = nchan;
+    f->factor = factor;
+    f->inv    = 1.0f / (float)factor;
+    return 0;
+}
+
+size_t adc_decim_run(adc_decim_t *f, const float *in, float *out, size_t frames){
+    const int nc = f->nchan;
+    const float inv = f->inv;
+    float acc[ADC_CHANNELS_MAX];
+    memcpy(acc, f->acc, sizeof(acc));
+    int count = f->count;
+    size_t nout = 0;
+
+    for (size_t i = 0; i < frames; i++) {
+        const float *x = in + i * (size_t)nc;
+        for (int ch = 0; ch < nc; ch++) {
+            acc[ch] += x[ch];
+        }
+        if (++count == f->factor) {
+            float *o = out + nout * (size_t)nc; // nout <= i: en el lugar no pisa nada sin leer
+            for (int ch = 0; ch < nc; ch++) {
+                o[ch]   = acc[ch] * inv;
+                acc[ch] = 0.0f;
+            }
+            count = 0;
+            nout++;
+        }
+    }
+    memcpy(f->acc, acc, sizeof(acc));
+    f->count = count;
+    return nout;
+}
@@ -0,0 +1,222 @@
+/*
+    adc_sim.c — ADC SIMULADO (implementación de adc.h)
+
+    - las muestras se generan "a demanda" en adc_poll(): las que según el
+      reloj ya se convirtieron desde adc_start(). Con el reloj virtual el
+      resultado es idéntico en cada corrida
+    - generador por canal con acumulador de fase de 32 bits (como un DDS):
+      seno por tabla, cuadrada y triangular por los bits de la fase, sin
+      sin()/fmod por muestra
+    - cada mitad completa va al callback, salvo que para cuando adc_poll()
+      la ve el "DMA" ya haya escrito más de una mitad detrás (overrun)
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "adc.h"
+#include "timeutil.h"
+
+#define ADC_SINE_BITS 10
+#define ADC_SINE_LEN  (1 << ADC_SINE_BITS)
+
+typedef struct{
+    int        used;
+    int        running;
+    adc_cfg_t  cfg;
+    uint16_t  *buf;         // 2 * block frames intercalados
+    int        half;        // mitad que se está llenando
+    size_t     fill;        // frames ya escritos en esa mitad
+    uint64_t   produced;    // frames desde adc_start()
+    long long  t0;
+
+    adc_wave_t wave[ADC_CHANNELS_MAX];
+    uint32_t   phase[ADC_CHANNELS_MAX];
+    uint32_t   inc[ADC_CHANNELS_MAX];   // avance de fase por frame
+    uint16_t   last[ADC_CHANNELS_MAX];
+    uint32_t   rng;
+
+    uint64_t   blocks, overruns;
+} adc_sim_t;
+
+static adc_sim_t A;
+static float sine_table[ADC_SINE_LEN];
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static void wave_apply(int ch){
+    double inc = A.wave[ch].freq_hz / (double)A.cfg.rate_hz;
+    inc -= floor(inc); // por encima de Nyquist se "dobla", como en un ADC real
+    A.inc[ch] = (uint32_t)(inc * 4294967296.0);
+}
+
+static float rng_noise(void){
+    // xorshift32 -> [-1, 1)
+    A.rng ^= A.rng << 13;
+    A.rng ^= A.rng >> 17;
+    A.rng ^= A.rng << 5;
+    return (float)(int32_t)A.rng * (1.0f / 2147483648.0f);
+}
+
+// Escribe n frames intercalados en out
+static void generate(uint16_t *out, size_t n){
+    int nc = A.cfg.nchan;
+    for (int ch = 0; ch < nc; ch++) {
+        const adc_wave_t *w = &A.wave[ch];
+        float    off   = (float)w->offset;
+        float    amp   = (float)w->amp;
+        float    noise = (float)w->noise;
+        uint32_t ph    = A.phase[ch];
+        uint32_t inc   = A.inc[ch];
+        float    v     = off;
+        for (size_t i = 0; i < n; i++) {
+            float s;
+            switch (w->kind) {
+            case ADC_WAVE_SINE:     s = sine_table[ph >> (32 - ADC_SINE_BITS)]; break;
+            case ADC_WAVE_SQUARE:   s = (ph & 0x80000000u) ? -1.0f : 1.0f; break;
+            case ADC_WAVE_TRIANGLE: // fase doblada en 0..2^31: sube y baja
+                s = (float)(ph ^ (uint32_t)((int32_t)ph >> 31)) * (1.0f / 1073741824.0f) - 1.0f;
+                break;
+            default:                s = 0.0f; break;
+            }
+            ph += inc;
+            v = off + amp * s;
+            if (noise != 0.0f) {
+                v += noise * rng_noise();
+            }
+            v = v < 0.0f ? 0.0f : (v > (float)ADC_MAX ? (float)ADC_MAX : v);
+            out[i * (size_t)nc + (size_t)ch] = (uint16_t)(v + 0.5f);
+        }
+        A.phase[ch] = ph;
+        if (n > 0) {
+            A.last[ch] = (uint16_t)(v + 0.5f);
+        }
+    }
+}
+
+static uint64_t frames_due(long long now){
+    if (now <= A.t0) {
+        return 0;
+    }
+    return (uint64_t)((unsigned __int128)(now - A.t0) * A.cfg.rate_hz / 1000000000ULL);
+}
+
+/*==========================================================
+=                    API PÚBLICA (adc.h)                   =
+==========================================================*/
+
+int adc_init(const adc_cfg_t *cfg){
+    if (A.used || cfg->nchan < 1 || cfg->nchan > ADC_CHANNELS_MAX || cfg->rate_hz == 0 || cfg->block == 0) {
+        return -1;
+    }
+    memset(&A, 0, sizeof(A));
+    A.buf = malloc(2 * cfg->block * (size_t)cfg->nchan * sizeof(uint16_t));
+    if (A.buf == NULL) {
+        return -1;
+    }
+    if (sine_table[ADC_SINE_LEN / 4] == 0.0f) {
+        for (int i = 0; i < ADC_SINE_LEN; i++) {
+            sine_table[i] = (float)sin(2.0 * M_PI * i / ADC_SINE_LEN);
+        }
+    }
+    A.cfg = *cfg;
+    A.rng = 0x12345678u;
+    for (int ch = 0; ch < cfg->nchan; ch++) {
+        A.wave[ch] = (adc_wave_t){ .kind = ADC_WAVE_DC, .offset = ADC_MAX / 2 };
+        A.last[ch] = ADC_MAX / 2;
+        wave_apply(ch);
+    }
+    A.used = 1;
+    return 0;
+}
+
+void adc_deinit(void){
+    free(A.buf);
+    memset(&A, 0, sizeof(A));
+}
+
+int adc_set_wave(int ch, const adc_wave_t *w){
+    if (!A.used || ch < 0 || ch >= A.cfg.nchan || w->freq_hz < 0) {
+        return -1;
+    }
+    A.wave[ch] = *w;
+    wave_apply(ch);
+    return 0;
+}
+
+int adc_start(void){
+    if (!A.used) {
+        return -1;
+    }
+    A.running  = 1;
+    A.t0       = now_ns();
+    A.produced = 0;
+    A.half     = 0;
+    A.fill     = 0;
+    return 0;
+}
+
+void adc_stop(void){
+    A.running = 0;
+}
+
+int adc_poll(void){
+    if (!A.running) {
+        return 0;
+    }
+    size_t   nc      = (size_t)A.cfg.nchan;
+    size_t   block   = A.cfg.block;
+    uint64_t pending = frames_due(now_ns()) - A.produced;
+    int      done    = 0;
+    while (pending > 0) {
+        size_t n = block - A.fill;
+        if (n > pending) {
+            n = (size_t)pending;
+        }
+        generate(A.buf + ((size_t)A.half * block + A.fill) * nc, n);
+        A.fill     += n;
+        A.produced += n;
+        pending    -= n;
+        if (A.fill == block) {
+            const uint16_t *blk = A.buf + (size_t)A.half * block * nc;
+            A.half ^= 1;
+            A.fill  = 0;
+            if (pending > block) {
+                A.overruns++;       // el DMA ya la volvió a pisar
+            } else {
+                A.blocks++;
+                done++;
+                if (A.cfg.cb != NULL) {
+                    A.cfg.cb(blk, block, A.cfg.arg);
+                }
+            }
+        }
+    }
+    return done;
+}
+
+long long adc_next_ns(void){
+    if (!A.running) {
+        return -1;
+    }
+    uint64_t target = A.produced + (A.cfg.block - A.fill);
+    // primer instante en que frames_due() >= target (redondeo hacia arriba)
+    unsigned __int128 ns = ((unsigned __int128)target * 1000000000ULL + A.cfg.rate_hz - 1) / A.cfg.rate_hz;
+    return A.t0 + (long long)ns;
+}
+
+int adc_read(int ch){
+    if (!A.used || ch < 0 || ch >= A.cfg.nchan) {
+        return -1;
+    }
+    adc_poll();
+    return A.last[ch];
+}
+
+void adc_stats(adc_stats_t *st){
+    st->frames   = A.produced;
+    st->blocks   = A.blocks;
+    st->overruns = A.overruns;
+}
@@ -0,0 +1,99 @@
+/*
+  app.c — Lógica de la aplicación: botón -> debounce -> LED
+
+  Sin polling en reposo: el flanco del botón (interrupción simulada) arranca
+  un timer de muestreo cada poll_ms, y ese timer se para solo cuando el
+  crudo vuelve a coincidir con el estable. Todo el estado es de la instancia,
+  así que se pueden tener tantos botones/LEDs como pines.
+*/
+
+#include "app.h"
+#include "gpio.h"
+#include "timeutil.h"
+#include "latency.h"
+
+// "ISR" del botón: marca el flanco para medir latencia y arranca el muestreo
+static void on_button_edge(int pin, int level, void *arg){
+    (void)level;
+    app_t *a = arg;
+    latency_mark(pin, now_ns());
+    if (!timer_active(&a->poll_timer)) {
+        timer_start(&a->poll_timer, 0, a->poll_ms); // primer muestreo ya, luego cada poll_ms
+    }
+}
+
+// Timer de muestreo: debounce + LED
+static void on_poll(swtimer_t *t, void *arg){
+    app_t *a = arg;
+    int raw = gpio_read(a->in_pin);
+    int led;
+
+    if (a->mode == APP_SWITCH) {
+        //LED sigue el estado estable del botón
+        led = debounce_ctx_state(&a->deb, raw);
+        gpio_write(a->out_pin, led);
+    } else {
+        //flanco 0->1 estable: alternar LED
+        led = gpio_read(a->out_pin);
+        if (debounce_ctx_press(&a->deb, raw)) {
+            led = !led;
+            gpio_write(a->out_pin, led);
+        }
+    }
+
+    //avisar solo si cambió
+    if (led != a->last_led) {
+        if (a->last_led != -1) {
+            latency_done(a->in_pin, now_ns()); // flanco crudo -> LED
+            a->led_changes++;
+        }
+        a->last_led = led;
+        if (a->on_led != NULL) {
+            a->on_led(a, led);
+        }
+    }
+
+    //nada pendiente de confirmar: a dormir hasta el próximo flanco
+    if (debounce_ctx_idle(&a->deb, raw)) {
+        latency_cancel(a->in_pin); // rebote (o suelta en toggle) que no cambió el LED
+        timer_stop(t);
+    }
+}
+
+int app_init(app_t *a, app_mode_t mode, int in_pin, int out_pin,
+             int poll_ms, long long debounce_ms, app_led_cb_t on_led, void *user){
+    if (in_pin < 0 || in_pin >= GPIO_PIN_MAX || out_pin < 0 || out_pin >= GPIO_PIN_MAX ||
+        in_pin == out_pin) {
+        return -1;
+    }
+    a->mode        = mode;
+    a->in_pin      = in_pin;
+    a->out_pin     = out_pin;
+    a->poll_ms     = (poll_ms > 0) ? poll_ms : 1;
+    a->last_led    = 0; // el LED arranca apagado (gpio_init)
+    a->led_changes = 0;
+    a->on_led      = on_led;
+    a->user        = user;
+    debounce_ctx_init(&a->deb, debounce_ms);
+    timer_setup(&a->poll_timer, on_poll, a);
+
+    gpio_mode(out_pin, GPIO_OUTPUT);
+    gpio_mode(in_pin, GPIO_INPUT);
+    gpio_set_pull(in_pin, GPIO_PULLDOWN); // 0 por defecto
+    return gpio_irq_attach(in_pin, GPIO_EDGE_BOTH, on_button_edge, a);
+}
+
+int app_set_algo(app_t *a, debounce_algo_t algo){
+    // misma ventana; los algoritmos por muestras la pasan a muestras de poll_ms
+    return debounce_ctx_init_algo(&a->deb, algo, a->deb.stable_us, a->poll_ms * 1000LL);
+}
+
+void app_kick(app_t *a){
+    a->last_led = -1; // el próximo muestreo avisa el estado aunque no cambie
+    timer_start(&a->poll_timer, 0, a->poll_ms);
+}
+
+void app_stop(app_t *a){
+    gpio_irq_detach(a->in_pin);
+    timer_stop(&a->poll_timer);
+}
@@ -0,0 +1,190 @@
+/*
+    batch.c — MODO SIN TERMINAL (implementación de batch.h)
+
+    Cada palabra del guion se ejecuta en el momento en que el reloj del
+    programa llega a ella:
+    - teclas: un lote de input_ev_t con el instante actual, directo a
+      keymap_dispatch (lo mismo que hace la tarea teclado con lo que junta
+      el hilo lector), y una vuelta del loop
+    - espera: run_until() repite el cuerpo del loop interactivo hasta el fin
+      de la espera, saltando (virtual) o durmiendo (real) hasta el próximo
+      vencimiento, sin pasar nunca por encima de un timer
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "gpio.h"
+#include "timeutil.h"
+#include "timer.h"
+#include "task.h"
+
+#define BATCH_TOKENS_MAX 256
+
+typedef struct{
+    const batch_cfg_t *cfg;
+    batch_stats_t     *st;
+} batch_run_t;
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+// Una vuelta del loop interactivo, sin event_wait
+static void loop_once(batch_stats_t *st){
+    gpio_poll();
+    tick_update();
+    timer_run_due(tick_ms());
+    task_run_ready();
+    st->loops++;
+}
+
+// Lleva el loop hasta t_ns pasando por cada timer que vence en el camino
+static void run_until(long long t_ns, batch_stats_t *st){
+    for (;;) {
+        long long next = t_ns;
+        if (task_any_ready()) {
+            next = now_ns();
+        } else {
+            long long d = timer_next_deadline();
+            if (d >= 0 && d * 1000000LL < t_ns) {
+                next = d * 1000000LL;
+            }
+        }
+        if (next > now_ns()) {
+            if (time_is_virtual()) {
+                vclock_set_ns(next);
+            } else {
+                sleep_until_ns(next);
+            }
+        }
+        loop_once(st);
+        if (next >= t_ns) {
+            return;
+        }
+    }
+}
+
+// Despacha las teclas de una palabra en lotes, todas con el mismo instante
+static int send_keys(batch_run_t *r, const char *word){
+    input_ev_t evs[BATCH_TOKENS_MAX];
+    size_t len = strlen(word);
+    for (size_t i = 0; i < len; ) {
+        int n = 0;
+        long long t = now_ns();
+        while (i < len && n < BATCH_TOKENS_MAX) {
+            evs[n].t_ns = t;
+            evs[n].key  = (unsigned char)word[i++];
+            n++;
+        }
+        r->st->keys += (uint64_t)n;
+        if (keymap_dispatch(r->cfg->keys, evs, n, r->cfg->on_cmd, r->cfg->arg) != 0) {
+            return 1;
+        }
+        loop_once(r->st);
+    }
+    return 0;
+}
+
+// Ejecuta tok[from..n) (los "*N" repiten el resto). 1 si hay que cortar, -1 si error
+static int exec_tokens(batch_run_t *r, char **tok, int from, int n){
+    for (int i = from; i < n; i++) {
+        char *end;
+        if (tok[i][0] == '+') {
+            long long ms = strtoll(tok[i] + 1, &end, 10);
+            if (end == tok[i] + 1 || *end != '\0' || ms < 0) {
+                return -1;
+            }
+            r->st->words++;
+            r->st->waits++;
+            run_until(now_ns() + ms * 1000000LL, r->st);
+        } else if (tok[i][0] == '*') {
+            long long times = strtoll(tok[i] + 1, &end, 10);
+            if (end == tok[i] + 1 || *end != '\0' || times < 0) {
+                return -1;
+            }
+            for (long long k = 0; k < times; k++) {
+                int rc = exec_tokens(r, tok, i + 1, n);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+            return 0;
+        } else {
+            r->st->words++;
+            if (send_keys(r, tok[i]) != 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*==========================================================
+=                    API PÚBLICA (batch.h)                 =
+==========================================================*/
+
+int batch_run(const batch_cfg_t *cfg, batch_stats_t *st){
+    memset(st, 0, sizeof(*st));
+    FILE *f = (strcmp(cfg->script, "-") == 0) ? stdin : fopen(cfg->script, "r");
+    if (f == NULL) {
+        perror(cfg->script);
+        return -1;
+    }
+    batch_run_t r = { .cfg = cfg, .st = st };
+    long long t0 = now_ns();
+    long long w0 = TIME_SOURCE_REAL.now_ns();
+    char     *line = NULL;
+    size_t    cap  = 0;
+    int       rc   = 0;
+    long      lineno = 0;
+
+    tick_update();
+    while (rc == 0 && getline(&line, &cap, f) >= 0) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash != NULL) {
+            *hash = '\0';
+        }
+        char *tok[BATCH_TOKENS_MAX];
+        int   n = 0;
+        char *save;
+        for (char *t = strtok_r(line, " \t\r\n", &save); t != NULL; t = strtok_r(NULL, " \t\r\n", &save)) {
+            if (n == BATCH_TOKENS_MAX) {
+                rc = -1;
+                break;
+            }
+            tok[n++] = t;
+        }
+        if (rc == 0) {
+            rc = exec_tokens(&r, tok, 0, n);
+        }
+        if (rc < 0) {
+            fprintf(stderr, "%s:%ld: guion mal escrito\n", cfg->script, lineno);
+        }
+    }
+    free(line);
+    if (f != stdin) {
+        fclose(f);
+    }
+    st->quit = (rc == 1);
+    if (rc == 0) {
+        run_until(now_ns() + cfg->settle_ms * 1000000LL, st); // que termine lo pendiente
+    }
+    st->sim_ns  = now_ns() - t0;
+    st->wall_ns = TIME_SOURCE_REAL.now_ns() - w0;
+    return rc < 0 ? -1 : 0;
+}
+
+void batch_print(const batch_stats_t *st, FILE *f){
+    double sim  = st->sim_ns / 1e9;
+    double wall = st->wall_ns / 1e9;
+    fprintf(f, "Guion: %llu palabras, %llu teclas, %llu esperas, %llu vueltas del loop%s\n",
+            (unsigned long long)st->words, (unsigned long long)st->keys,
+            (unsigned long long)st->waits, (unsigned long long)st->loops,
+            st->quit ? " (cortado por comando)" : "");
+    fprintf(f, "Tiempo: %.3f s %s en %.3f s reales (x%.0f), %.0f teclas/s\n",
+            sim, time_is_virtual() ? "virtuales" : "de reloj", wall,
+            wall > 0 ? sim / wall : 0.0, wall > 0 ? (double)st->keys / wall : 0.0);
+}
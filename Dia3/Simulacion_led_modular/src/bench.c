@@ -0,0 +1,507 @@
+/*
+  bench.c — Microbenchmarks de los caminos calientes de GPIO y debounce
+
+  Mide ns/op, ops/s y ciclos/op de:
+    - gpio_read / gpio_write / gpio_simulate_input / gpio_port_read
+    - gpio_read_bank (foto de todos los puertos; se reporta por pin)
+    - bank_tick = gpio_read_bank + debounce_bank_update (un tick completo, por pin)
+    - gpio_write_err (gpio_write sobre entradas: contador + log con límite de tasa)
+    - pin_button_read / pin_led_write (accesores de pins.h, pin fijo en compilación)
+    - debounce_state / debounce_press (API vieja, un pin)
+    - debounce_ctx_state (un contexto por pin, una lectura de reloj por tick)
+    - debounce_integrator / debounce_shift8/16/32 (misma API, otros algoritmos)
+    - debounce_bank_update (64 pines por palabra; se reporta por pin)
+    - task_post_run (una tarea por pin: evento + corrida de todas, por tarea)
+    - task_one_of_n (una tarea despierta entre N dormidas: no depende de N)
+  para varias cantidades de pines y patrones de rebote.
+
+  Método:
+    - los patrones se generan ANTES de medir (semilla fija: mismas entradas siempre)
+    - "warmup" corridas sin medir (caches, predictor de saltos, frecuencia del CPU)
+    - "reps" repeticiones medidas; se reporta la mediana y el mínimo
+    - ciclos con rdtsc en x86 (en otras arquitecturas se reporta 0)
+
+  Uso:
+    ./bin/bench [-f table|csv|json] [-r reps] [-w warmup] [-n ops] [-p pines,...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "gpio_pins.h"
+#include "debounce.h"
+#include "timeutil.h"
+#include "task.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t cycles_now(void){ return __rdtsc(); }
+#else
+static inline uint64_t cycles_now(void){ return 0; }
+#endif
+
+/*==========================================================
+=                  PATRONES DE ENTRADA                     =
+==========================================================*/
+
+#define SAMPLES 1024 // muestras por patrón (se recorren en círculo)
+
+typedef enum{
+    PAT_STABLE = 0,  // nunca cambia (camino más común)
+    PAT_TOGGLE,      // cambia en cada muestra (peor caso)
+    PAT_BURST,       // ráfagas de rebote y luego estable (botón real)
+    PAT_RANDOM,      // ruido uniforme
+    PAT_COUNT
+} pattern_t;
+
+static const char *pattern_name[PAT_COUNT] = { "estable", "alterna", "rafaga", "aleatorio" };
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void){
+    // xorshift64*: rápido y reproducible
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+// pat[s * nwords + w] = bits crudos de los pines de la palabra w en la muestra s
+static uint64_t *pattern_make(pattern_t p, size_t nwords){
+    uint64_t *pat = malloc(SAMPLES * nwords * sizeof(uint64_t));
+    if (pat == NULL) {
+        return NULL;
+    }
+    rng_state = 0x9E3779B97F4A7C15ULL;
+    uint64_t level = 0;
+    for (size_t s = 0; s < SAMPLES; s++) {
+        for (size_t w = 0; w < nwords; w++) {
+            uint64_t v = 0;
+            switch (p) {
+                case PAT_STABLE: v = 0; break;
+                case PAT_TOGGLE: v = (s & 1) ? ~0ULL : 0; break;
+                case PAT_RANDOM: v = rng_next(); break;
+                case PAT_BURST:
+                    // 16 muestras rebotando, 112 estables en el nuevo nivel
+                    if (w == 0 && s % 128 == 0) level = ~level;
+                    v = (s % 128 < 16) ? rng_next() : level;
+                    break;
+                default: break;
+            }
+            pat[s * nwords + w] = v;
+        }
+    }
+    return pat;
+}
+
+static inline int pat_bit(const uint64_t *pat, size_t nwords, size_t s, size_t pin){
+    return (int)((pat[(s % SAMPLES) * nwords + (pin >> 6)] >> (pin & 63)) & 1u);
+}
+
+/*==========================================================
+=                       CASOS                              =
+==========================================================*/
+
+typedef struct{
+    size_t          npins;
+    size_t          nwords;
+    const uint64_t *pat;
+    debounce_ctx_t *ctx;
+    debounce_bank_t bank;
+    uint64_t       *snap;    // foto de gpio_read_bank (nwords palabras)
+    task_t         *tasks;   // una tarea por pin (casos task_*)
+} bench_env_t;
+
+static volatile uint64_t sink; // evita que el compilador borre el trabajo
+
+// cada caso corre "rounds" vueltas y retorna cuántas operaciones hizo
+typedef uint64_t (*bench_fn_t)(bench_env_t *e, uint64_t rounds);
+
+static uint64_t b_gpio_read(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < e->npins; p++) {
+            acc += (uint64_t)gpio_read((int)p);
+        }
+    }
+    sink = acc;
+    return rounds * e->npins;
+}
+
+static uint64_t b_gpio_write(bench_env_t *e, uint64_t rounds){
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < e->npins; p++) {
+            gpio_write((int)p, pat_bit(e->pat, e->nwords, r, p));
+        }
+    }
+    return rounds * e->npins;
+}
+
+static uint64_t b_gpio_simulate_input(bench_env_t *e, uint64_t rounds){
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < e->npins; p++) {
+            gpio_simulate_input((int)p, pat_bit(e->pat, e->nwords, r, p));
+        }
+    }
+    return rounds * e->npins;
+}
+
+static uint64_t b_gpio_port_read(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (size_t w = 0; w < e->nwords; w++) {
+            acc ^= gpio_port_read((int)w);
+        }
+    }
+    sink = acc;
+    return rounds * e->nwords;
+}
+
+// mismo trabajo que gpio_read/gpio_write con un pin, pero con el pin fijo en compilación
+static uint64_t b_pin_button_read(bench_env_t *e, uint64_t rounds){
+    (void)e;
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        acc += (uint64_t)pin_button_read();
+        __asm__ volatile("" ::: "memory"); // releer el IDR en cada vuelta (como un registro real)
+    }
+    sink = acc;
+    return rounds;
+}
+
+static uint64_t b_pin_led_write(bench_env_t *e, uint64_t rounds){
+    for (uint64_t r = 0; r < rounds; r++) {
+        pin_led_write(pat_bit(e->pat, e->nwords, r, 0));
+    }
+    return rounds;
+}
+
+static uint64_t b_gpio_read_bank(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        gpio_read_bank(0, (int)e->nwords, e->snap);
+        acc ^= e->snap[r % e->nwords];
+    }
+    sink = acc;
+    return rounds * e->npins; // por pin, para comparar con gpio_read
+}
+
+// un tick de un debouncer por lotes: foto de las entradas + banco bit-paralelo
+static uint64_t b_bank_tick(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        gpio_read_bank(0, (int)e->nwords, e->snap);
+        acc ^= debounce_bank_update(&e->bank, e->snap, NULL);
+    }
+    sink = acc;
+    return rounds * e->npins;
+}
+
+static uint64_t b_debounce_state(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        acc += (uint64_t)debounce_state(pat_bit(e->pat, e->nwords, r, 0), 1);
+    }
+    sink = acc;
+    return rounds;
+}
+
+static uint64_t b_debounce_press(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        acc += (uint64_t)debounce_press(pat_bit(e->pat, e->nwords, r, 0), 1);
+    }
+    sink = acc;
+    return rounds;
+}
+
+static uint64_t b_debounce_ctx_state(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        tick_update(); // una lectura del reloj por tick para todos los pines
+        for (size_t p = 0; p < e->npins; p++) {
+            acc += (uint64_t)debounce_ctx_state(&e->ctx[p], pat_bit(e->pat, e->nwords, r, p));
+        }
+    }
+    sink = acc;
+    return rounds * e->npins;
+}
+
+static uint64_t b_debounce_bank(bench_env_t *e, uint64_t rounds){
+    uint64_t acc = 0;
+    for (uint64_t r = 0; r < rounds; r++) {
+        acc ^= debounce_bank_update(&e->bank, &e->pat[(r % SAMPLES) * e->nwords], NULL);
+    }
+    sink = acc;
+    return rounds * e->npins; // por pin, para comparar con los demás
+}
+
+// tarea que solo espera eventos
+static int bench_task(task_t *t){
+    TASK_BEGIN(t);
+    for (;;) {
+        TASK_WAIT_EVENT(t, 1u);
+        sink += TASK_EVENTS(t);
+    }
+    TASK_END(t);
+}
+
+static uint64_t b_task_post_run(bench_env_t *e, uint64_t rounds){
+    for (uint64_t r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < e->npins; p++) {
+            task_post(&e->tasks[p], 1u);
+        }
+        task_run_ready();
+    }
+    return rounds * e->npins;
+}
+
+static uint64_t b_task_one_of_n(bench_env_t *e, uint64_t rounds){
+    for (uint64_t r = 0; r < rounds; r++) {
+        task_post(&e->tasks[r % e->npins], 1u);
+        task_run_ready();
+    }
+    return rounds;
+}
+
+typedef struct{
+    const char *name;
+    bench_fn_t  fn;
+    int         uses_pattern;  // 1 si depende del patrón de rebote
+    int         single_pin;    // 1 si solo tiene sentido con un pin (API vieja)
+    int         outputs;       // 1 = pines como salida, 0 = entrada
+    debounce_algo_t algo;      // algoritmo de los contextos (DEBOUNCE_TIMER si no se dice)
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    { "gpio_read",            b_gpio_read,            0, 0, 0, DEBOUNCE_TIMER },
+    { "gpio_write",           b_gpio_write,           1, 0, 1, DEBOUNCE_TIMER },
+    { "gpio_write_err",       b_gpio_write,           0, 0, 0, DEBOUNCE_TIMER }, // sobre entradas: camino de error
+    { "gpio_simulate_input",  b_gpio_simulate_input,  1, 0, 0, DEBOUNCE_TIMER },
+    { "gpio_port_read",       b_gpio_port_read,       0, 0, 0, DEBOUNCE_TIMER },
+    { "gpio_read_bank",       b_gpio_read_bank,       0, 0, 0, DEBOUNCE_TIMER },
+    { "bank_tick",            b_bank_tick,            0, 0, 0, DEBOUNCE_TIMER },
+    { "pin_button_read",      b_pin_button_read,      0, 1, 0, DEBOUNCE_TIMER },
+    { "pin_led_write",        b_pin_led_write,        1, 1, 1, DEBOUNCE_TIMER },
+    { "debounce_state",       b_debounce_state,       1, 1, 0, DEBOUNCE_TIMER },
+    { "debounce_press",       b_debounce_press,       1, 1, 0, DEBOUNCE_TIMER },
+    { "debounce_ctx_state",   b_debounce_ctx_state,   1, 0, 0, DEBOUNCE_TIMER },
+    { "debounce_integrator",  b_debounce_ctx_state,   1, 0, 0, DEBOUNCE_INTEGRATOR },
+    { "debounce_shift8",      b_debounce_ctx_state,   1, 0, 0, DEBOUNCE_SHIFT8 },
+    { "debounce_shift16",     b_debounce_ctx_state,   1, 0, 0, DEBOUNCE_SHIFT16 },
+    { "debounce_shift32",     b_debounce_ctx_state,   1, 0, 0, DEBOUNCE_SHIFT32 },
+    { "debounce_bank_update", b_debounce_bank,        1, 0, 0, DEBOUNCE_TIMER },
+    { "task_post_run",        b_task_post_run,        0, 0, 0, DEBOUNCE_TIMER },
+    { "task_one_of_n",        b_task_one_of_n,        0, 0, 0, DEBOUNCE_TIMER },
+};
+
+/*==========================================================
+=                     MEDICIÓN Y SALIDA                    =
+==========================================================*/
+
+typedef enum{ OUT_TABLE, OUT_CSV, OUT_JSON } out_fmt_t;
+
+typedef struct{
+    out_fmt_t fmt;
+    int       reps;
+    int       warmup;
+    uint64_t  ops;     // operaciones objetivo por repetición
+    size_t    pins[8];
+    int       npins;
+} bench_opts_t;
+
+static int cmp_double(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int first_row = 1;
+
+static void report(const bench_opts_t *o, const char *name, size_t pins, const char *pat,
+                   uint64_t ops, double ns_med, double ns_min, double cyc){
+    double ops_s = (ns_med > 0) ? 1e9 / ns_med : 0;
+    switch (o->fmt) {
+        case OUT_CSV:
+            printf("%s,%zu,%s,%llu,%d,%.3f,%.3f,%.0f,%.2f\n",
+                   name, pins, pat, (unsigned long long)ops, o->reps, ns_med, ns_min, ops_s, cyc);
+            break;
+        case OUT_JSON:
+            printf("%s  {\"caso\":\"%s\",\"pines\":%zu,\"patron\":\"%s\",\"ops\":%llu,\"reps\":%d,"
+                   "\"ns_op\":%.3f,\"ns_op_min\":%.3f,\"ops_s\":%.0f,\"ciclos_op\":%.2f}",
+                   first_row ? "" : ",\n", name, pins, pat, (unsigned long long)ops, o->reps,
+                   ns_med, ns_min, ops_s, cyc);
+            break;
+        default:
+            printf("%-22s %6zu %-10s %10.3f %10.3f %14.0f %10.2f\n",
+                   name, pins, pat, ns_med, ns_min, ops_s, cyc);
+            break;
+    }
+    first_row = 0;
+}
+
+static void run_case(const bench_opts_t *o, const bench_case_t *c, size_t npins, pattern_t p){
+    bench_env_t e;
+    memset(&e, 0, sizeof(e));
+    e.npins  = npins;
+    e.nwords = (npins + 63) / 64;
+    e.pat    = pattern_make(p, e.nwords);
+    e.ctx    = calloc(npins, sizeof(debounce_ctx_t));
+    e.snap   = calloc(e.nwords, sizeof(uint64_t));
+    if (e.pat == NULL || e.ctx == NULL || e.snap == NULL || debounce_bank_init(&e.bank, npins, 4) != 0) {
+        fprintf(stderr, "bench: sin memoria\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < npins; i++) {
+        if (c->algo == DEBOUNCE_TIMER) {
+            debounce_ctx_init_us(&e.ctx[i], 1);
+        } else {
+            if (debounce_ctx_init_algo(&e.ctx[i], c->algo, 4, 1) != 0) { // integrador: 4 muestras
+                fprintf(stderr, "bench: algoritmo de debounce invalido en %s\n", c->name);
+                exit(1);
+            }
+        }
+    }
+
+    // pines en el modo que necesita el caso
+    if (gpio_init() != 0) {
+        exit(1);
+    }
+    for (size_t i = 0; i < npins; i++) {
+        gpio_mode((int)i, c->outputs ? GPIO_OUTPUT : GPIO_INPUT);
+    }
+
+    // tareas dormidas esperando un evento (casos task_*)
+    int with_tasks = (c->fn == b_task_post_run || c->fn == b_task_one_of_n);
+    if (with_tasks) {
+        timer_service_init();
+        e.tasks = calloc(npins, sizeof(task_t));
+        if (e.tasks == NULL) {
+            fprintf(stderr, "bench: sin memoria\n");
+            exit(1);
+        }
+        for (size_t i = 0; i < npins; i++) {
+            task_start(&e.tasks[i], "bench", bench_task, NULL);
+        }
+        task_run_ready(); // primera corrida: todas quedan esperando
+    }
+
+    // vueltas por repetición para llegar a ~ops operaciones
+    uint64_t per_round = c->fn == b_gpio_port_read ? e.nwords
+                       : (c->single_pin || c->fn == b_task_one_of_n) ? 1 : npins;
+    uint64_t rounds = o->ops / per_round;
+    if (rounds == 0) {
+        rounds = 1;
+    }
+
+    for (int i = 0; i < o->warmup; i++) {
+        c->fn(&e, rounds);
+    }
+
+    double *ns = malloc(sizeof(double) * (size_t)o->reps);
+    double cyc_sum = 0;
+    uint64_t ops = 0;
+    for (int i = 0; i < o->reps; i++) {
+        long long t0 = now_ns();
+        uint64_t  c0 = cycles_now();
+        ops = c->fn(&e, rounds);
+        uint64_t  c1 = cycles_now();
+        long long t1 = now_ns();
+        ns[i] = (double)(t1 - t0) / (double)ops;
+        cyc_sum += (double)(c1 - c0) / (double)ops;
+    }
+    qsort(ns, (size_t)o->reps, sizeof(double), cmp_double);
+
+    report(o, c->name, npins, c->uses_pattern ? pattern_name[p] : "-", ops,
+           ns[o->reps / 2], ns[0], cyc_sum / o->reps);
+
+    free(ns);
+    free((void *)e.pat);
+    free(e.ctx);
+    free(e.snap);
+    if (with_tasks) {
+        for (size_t i = 0; i < npins; i++) {
+            task_kill(&e.tasks[i]);
+        }
+        free(e.tasks);
+    }
+    debounce_bank_free(&e.bank);
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-f table|csv|json] [-r reps] [-w warmup] [-n ops] [-p pines,...]\n"
+            "  -f  formato de salida (por defecto table)\n"
+            "  -r  repeticiones medidas (por defecto 7)\n"
+            "  -w  repeticiones de calentamiento (por defecto 2)\n"
+            "  -n  operaciones por repetición (por defecto 2000000)\n"
+            "  -p  cantidades de pines (por defecto 1,64,1024,4096)\n", argv0);
+}
+
+int main(int argc, char **argv){
+    bench_opts_t o = { .fmt = OUT_TABLE, .reps = 7, .warmup = 2, .ops = 2000000,
+                       .pins = { 1, 64, 1024, 4096 }, .npins = 4 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-f") == 0) {
+            o.fmt = strcmp(v, "csv") == 0 ? OUT_CSV : strcmp(v, "json") == 0 ? OUT_JSON : OUT_TABLE;
+        } else if (strcmp(a, "-r") == 0) {
+            o.reps = atoi(v);
+        } else if (strcmp(a, "-w") == 0) {
+            o.warmup = atoi(v);
+        } else if (strcmp(a, "-n") == 0) {
+            o.ops = strtoull(v, NULL, 10);
+        } else if (strcmp(a, "-p") == 0) {
+            o.npins = 0;
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", v);
+            for (char *tok = strtok(buf, ","); tok != NULL && o.npins < 8; tok = strtok(NULL, ",")) {
+                size_t n = strtoull(tok, NULL, 10);
+                if (n >= 1 && n <= GPIO_PIN_MAX) {
+                    o.pins[o.npins++] = n;
+                }
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.reps < 1) o.reps = 1;
+    if (o.warmup < 0) o.warmup = 0;
+
+    switch (o.fmt) {
+        case OUT_CSV:
+            puts("caso,pines,patron,ops,reps,ns_op,ns_op_min,ops_s,ciclos_op");
+            break;
+        case OUT_JSON:
+            puts("[");
+            break;
+        default:
+            printf("%-22s %6s %-10s %10s %10s %14s %10s\n",
+                   "caso", "pines", "patron", "ns/op", "ns/op min", "ops/s", "ciclos/op");
+            break;
+    }
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        for (int n = 0; n < o.npins; n++) {
+            if (cases[c].single_pin && n > 0) {
+                break; // la API vieja solo tiene un pin: una fila basta
+            }
+            size_t pins = cases[c].single_pin ? 1 : o.pins[n];
+            int npat = cases[c].uses_pattern ? PAT_COUNT : 1;
+            for (int p = 0; p < npat; p++) {
+                run_case(&o, &cases[c], pins, (pattern_t)p);
+            }
+        }
+    }
+
+    if (o.fmt == OUT_JSON) {
+        puts("\n]");
+    }
+    return 0;
+}
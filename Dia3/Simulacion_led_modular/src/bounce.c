@@ -0,0 +1,244 @@
+/*
+  bounce.c — Generador de rebote de contactos
+
+  Cada pin es una pequeña máquina de estados:
+
+      ESTABLE --(cambio ideal)--> RAFAGA --(se asienta)--> ESTABLE
+         |                                                    ^
+         +--(ruido)--> PULSO --(termina el pulso)-------------+
+
+  y guarda el instante de su próximo cambio crudo. Los pines van en un
+  min-heap por ese instante: sacar el próximo evento de N pines es O(log N),
+  sin recorrer los que no tienen nada que hacer.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "bounce.h"
+
+enum{ PH_STABLE = 0, PH_BURST, PH_GLITCH };
+
+struct bounce_pin{
+    uint64_t  rng;        // generador propio del pin
+    long long next_ns;    // próximo cambio crudo
+    long long ideal_at;   // próximo cambio ideal (mientras está estable)
+    long long glitch_at;  // próximo pulso espurio (mientras está estable)
+    long long burst_end;  // fin de la ráfaga en curso
+    int       pin;
+    uint8_t   ideal;      // nivel verdadero
+    uint8_t   raw;        // nivel crudo
+    uint8_t   phase;      // PH_*
+};
+
+/*==========================================================
+=                  AZAR (uso interno)                      =
+==========================================================*/
+
+// splitmix64: para derivar una semilla distinta por pin
+static uint64_t splitmix(uint64_t x){
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// uniforme en (0, 1)
+static double rnd_unit(bounce_pin_t *p){
+    // xorshift64*
+    p->rng ^= p->rng >> 12;
+    p->rng ^= p->rng << 25;
+    p->rng ^= p->rng >> 27;
+    uint64_t x = p->rng * 0x2545F4914F6CDD1DULL;
+    return ((double)(x >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+static long long rnd_exp(bounce_pin_t *p, double mean_ns){
+    return (long long)(-mean_ns * log(rnd_unit(p)));
+}
+
+// Duración con la distribución configurada y media mean_ns (>= 1 ns)
+static long long rnd_dist(bounce_pin_t *p, bounce_dist_t d, double mean_ns){
+    double v;
+    switch (d) {
+        case BOUNCE_DIST_EXP:
+            v = -mean_ns * log(rnd_unit(p));
+            break;
+        case BOUNCE_DIST_NORMAL: {
+            // Box-Muller
+            double u1 = rnd_unit(p), u2 = rnd_unit(p);
+            v = mean_ns + (mean_ns / 3.0) * sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+            break;
+        }
+        default:
+            v = 2.0 * mean_ns * rnd_unit(p);
+            break;
+    }
+    return (v < 1.0) ? 1 : (long long)v;
+}
+
+/*==========================================================
+=               MÁQUINA DE ESTADOS (uso interno)           =
+==========================================================*/
+
+// Entra en ESTABLE en el instante t: sortear próximo cambio ideal y próximo ruido
+static void enter_stable(const bounce_cfg_t *c, bounce_pin_t *p, long long t){
+    p->phase = PH_STABLE;
+    if (c->press_hz > 0) {
+        // dos cambios ideales por presión; el mínimo hold_us y el resto al azar (Poisson)
+        double mean = 1e9 / (2.0 * c->press_hz) - c->hold_us * 1000.0;
+        p->ideal_at = t + c->hold_us * 1000LL + (mean > 0 ? rnd_exp(p, mean) : 0);
+    } else {
+        p->ideal_at = LLONG_MAX;
+    }
+    p->glitch_at = (c->glitch_hz > 0) ? t + 1 + rnd_exp(p, 1e9 / c->glitch_hz) : LLONG_MAX;
+    p->next_ns = (p->ideal_at < p->glitch_at) ? p->ideal_at : p->glitch_at;
+}
+
+// Aplica el cambio crudo que tocaba en p->next_ns y programa el siguiente
+static void step(const bounce_cfg_t *c, bounce_pin_t *p, bounce_ev_t *ev){
+    long long t = p->next_ns;
+    ev->t_ns = t;
+    ev->pin  = p->pin;
+    ev->edge = 0;
+
+    switch (p->phase) {
+        case PH_STABLE:
+            if (p->ideal_at <= p->glitch_at) {
+                // el dedo cambió: primer contacto y arranca la ráfaga
+                p->ideal ^= 1;
+                p->raw = p->ideal;
+                p->burst_end = t + rnd_dist(p, c->dist, c->bounce_us * 1000.0);
+                p->phase = PH_BURST;
+                ev->edge = 1;
+            } else {
+                // pulso espurio: se va del nivel y vuelve, sin llegar al próximo cambio ideal
+                p->raw ^= 1;
+                p->phase = PH_GLITCH;
+                long long end = t + rnd_dist(p, c->dist, c->glitch_us * 1000.0);
+                p->next_ns = (end < p->ideal_at) ? end : p->ideal_at;
+                break;
+            }
+            // sigue abajo: programar el próximo rebote
+            /* fallthrough */
+        case PH_BURST:
+            if (ev->edge == 0) {
+                p->raw ^= 1; // un rebote más
+            }
+            {
+                long long iv = rnd_dist(p, c->dist, 1e9 / c->chatter_hz);
+                if (p->raw != p->ideal) {
+                    // separado: vuelve a tocar antes o al final de la ráfaga
+                    p->next_ns = (t + iv < p->burst_end) ? t + iv : p->burst_end;
+                } else if (t + iv < p->burst_end) {
+                    p->next_ns = t + iv; // todavía rebota
+                } else {
+                    long long settle = (p->burst_end > t) ? p->burst_end : t;
+                    enter_stable(c, p, settle);
+                }
+            }
+            break;
+        case PH_GLITCH: {
+            p->raw ^= 1; // fin del pulso: de vuelta al nivel ideal
+            long long ideal_at = p->ideal_at; // el ruido no mueve el próximo cambio ideal
+            enter_stable(c, p, t);
+            p->ideal_at = ideal_at;
+            p->next_ns = (p->ideal_at < p->glitch_at) ? p->ideal_at : p->glitch_at;
+            break;
+        }
+    }
+    ev->value = p->raw;
+    ev->ideal = p->ideal;
+}
+
+/*==========================================================
+=                    HEAP (uso interno)                    =
+==========================================================*/
+
+static int before(const bounce_gen_t *g, int a, int b){
+    const bounce_pin_t *pa = &g->pins[a], *pb = &g->pins[b];
+    return pa->next_ns < pb->next_ns || (pa->next_ns == pb->next_ns && a < b);
+}
+
+static void sift_down(bounce_gen_t *g, int i){
+    int n = g->npins;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && before(g, g->heap[l], g->heap[m])) m = l;
+        if (r < n && before(g, g->heap[r], g->heap[m])) m = r;
+        if (m == i) {
+            return;
+        }
+        int tmp = g->heap[i];
+        g->heap[i] = g->heap[m];
+        g->heap[m] = tmp;
+        i = m;
+    }
+}
+
+/*==========================================================
+=                        API PÚBLICA                        =
+==========================================================*/
+
+void bounce_cfg_default(bounce_cfg_t *cfg){
+    cfg->seed       = 1;
+    cfg->press_hz   = 1.0;     // una presión por segundo
+    cfg->hold_us    = 100000;  // 100 ms apretado como mínimo
+    cfg->bounce_us  = 2000;    // ráfagas de ~2 ms
+    cfg->chatter_hz = 20000;   // un rebote cada ~50 us
+    cfg->glitch_hz  = 0.5;     // un pulso espurio cada ~2 s
+    cfg->glitch_us  = 200;     // de ~200 us
+    cfg->dist       = BOUNCE_DIST_EXP;
+}
+
+int bounce_init(bounce_gen_t *g, const bounce_cfg_t *cfg, const int *pins, int npins, long long t0_ns){
+    memset(g, 0, sizeof(*g));
+    if (npins <= 0 || cfg->chatter_hz <= 0) {
+        return -1;
+    }
+    g->cfg   = *cfg;
+    g->pins  = calloc((size_t)npins, sizeof(*g->pins));
+    g->heap  = malloc(sizeof(int) * (size_t)npins);
+    g->npins = npins;
+    if (g->pins == NULL || g->heap == NULL) {
+        bounce_free(g);
+        return -1;
+    }
+    for (int i = 0; i < npins; i++) {
+        bounce_pin_t *p = &g->pins[i];
+        p->pin = pins[i];
+        p->rng = splitmix(cfg->seed ^ ((uint64_t)pins[i] << 32)) | 1; // xorshift no admite 0
+        enter_stable(&g->cfg, p, t0_ns);
+        g->heap[i] = i;
+    }
+    for (int i = npins / 2 - 1; i >= 0; i--) {
+        sift_down(g, i);
+    }
+    return 0;
+}
+
+void bounce_free(bounce_gen_t *g){
+    free(g->pins);
+    free(g->heap);
+    memset(g, 0, sizeof(*g));
+}
+
+long long bounce_peek(const bounce_gen_t *g){
+    return (g->npins > 0) ? g->pins[g->heap[0]].next_ns : -1;
+}
+
+int bounce_next(bounce_gen_t *g, bounce_ev_t *ev){
+    if (g->npins == 0) {
+        return 0;
+    }
+    bounce_pin_t *p = &g->pins[g->heap[0]];
+    if (p->next_ns == LLONG_MAX) {
+        return 0; // nadie va a cambiar nunca (press_hz y glitch_hz en 0)
+    }
+    step(&g->cfg, p, ev);
+    sift_down(g, 0); // su próximo evento es más tarde: baja en el heap
+    g->raw_changes++;
+    g->ideal_changes += (uint64_t)ev->edge;
+    return 1;
+}
@@ -6,81 +6,275 @@
   - "candidate" = posible nuevo estado que estamos "probando".
   - "last_stable" = último estado ya aceptado como REAL (sin rebotes).
   - Si "raw" se mantiene igual a "candidate" por >= stable_ms, aceptamos el cambio.
-  - now_ms() = marca de tiempo en milisegundos (ver timeutil.h / timeutil.c).
+  - El tiempo se maneja en microsegundos, así que la ventana puede ser < 1 ms.
+  - Las funciones por contexto usan tick_us() (una lectura del reloj por
+    iteración del loop, compartida por todos los pines). Las funciones viejas
+    leen now_us() UNA vez por llamada.
+  - El contexto también puede filtrar contando muestras (integrador o
+    historial por desplazamiento): sin reloj, solo sumas o un shift.
 */
 
+#include <stdlib.h>
+#include <string.h>
 #include "debounce.h"
 #include "timeutil.h"
 
+const char *const debounce_algo_name[DEBOUNCE_ALGO_COUNT] = {
+    "timer", "integrator", "shift8", "shift16", "shift32"
+};
+
+int debounce_algo_parse(const char *name){
+    for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++) {
+        if (strcmp(name, debounce_algo_name[a]) == 0) {
+            return a;
+        }
+    }
+    return -1;
+}
+
+void debounce_ctx_init_us(debounce_ctx_t *d, long long stable_us){
+    debounce_ctx_init_algo(d, DEBOUNCE_TIMER, stable_us, 0);
+}
+
+int debounce_ctx_init_algo(debounce_ctx_t *d, debounce_algo_t algo,
+                           long long stable_us, long long period_us){
+    static const uint32_t shift_mask[DEBOUNCE_ALGO_COUNT] = {
+        [DEBOUNCE_SHIFT8] = 0xFFu, [DEBOUNCE_SHIFT16] = 0xFFFFu, [DEBOUNCE_SHIFT32] = 0xFFFFFFFFu
+    };
+    if ((unsigned)algo >= DEBOUNCE_ALGO_COUNT) {
+        return -1; // shift_mask[algo] se saldría de la tabla y debounce_ctx_state no sabría qué correr
+    }
+    long long n = (period_us > 0) ? (stable_us + period_us - 1) / period_us : 1;
+
+    d->last_stable = 0;
+    d->candidate   = 0;
+    d->t0_us       = 0;
+    d->stable_us   = stable_us;
+    d->algo        = algo;
+    d->hist        = 0;
+    d->mask        = shift_mask[algo];
+    d->count       = 0;
+    d->samples     = (uint16_t)(n < 1 ? 1 : n > UINT16_MAX ? UINT16_MAX : n);
+    return 0;
+}
+
+void debounce_ctx_init(debounce_ctx_t *d, long long stable_ms){
+    debounce_ctx_init_us(d, stable_ms * 1000LL);
+}
+
 /* -------------------- DETECCIÓN DE EVENTO (flanco 0->1) --------------------
    Devuelve true EXACTAMENTE UNA VEZ cuando se confirma un flanco de PRESIÓN
    (cambio estable de 0 -> 1). Si hay rebotes 0/1 rápidos, no dispara hasta que
    el nivel 1 se mantiene durante "stable_ms".
 
    raw:        0/1 crudo del botón.
-   stable_ms:  ventana de tiempo mínima que debe sostener "candidate".
+   now:        instante de la muestra en us.
 */
-bool debounce_press(int raw, long long stable_ms){
-    static int last_stable = 0;   // Último estado real confirmado (0/1)
-    static int candidate   = 0;   // Posible nuevo estado (todavía no confirmado)
-    static long long t0    = 0;   // Marca temporal cuando vimos el "candidate"
-
-    if (raw != last_stable) {
+static bool press_at(debounce_ctx_t *d, int raw, long long now){
+    if (raw != d->last_stable) {
         // Vemos una diferencia respecto al estado REAL actual
-        if (raw != candidate) {
+        if (raw != d->candidate) {
             // Cambió el candidato: empezar a medir estabilidad desde cero
-            candidate = raw;
-            t0 = now_ms();
+            d->candidate = raw;
+            d->t0_us = now;
         } else {
             // El candidato se mantiene; comprobar si ya cumplió la ventana de tiempo
-            if (now_ms() - t0 >= stable_ms) {
+            if (now - d->t0_us >= d->stable_us) {
                 // ¡Cambio confirmado!
-                last_stable = candidate;
+                d->last_stable = d->candidate;
 
                 // ¿Fue un flanco 0->1? Entonces es un EVENTO "press"
-                if (last_stable == 1) {
+                if (d->last_stable == 1) {
                     return true;  // disparamos una sola vez
                 }
             }
         }
     } else {
         // raw == last_stable -> nada cambió realmente; mantener sincronía
-        candidate = last_stable;
-        t0 = now_ms(); // opcional: re-referenciamos el reloj
+        d->candidate = d->last_stable;
+        d->t0_us = now; // opcional: re-referenciamos el reloj
     }
 
     return false; // No hubo flanco 0->1 confirmado en esta llamada
 }
 
+bool debounce_ctx_press(debounce_ctx_t *d, int raw){
+    if (d->algo == DEBOUNCE_TIMER) {
+        return press_at(d, raw, tick_us());
+    }
+    // por muestras: flanco = el estable pasó de 0 a 1 en esta muestra
+    int before = d->last_stable;
+    return debounce_ctx_state(d, raw) && !before;
+}
+
+bool debounce_press(int raw, long long stable_ms){
+    static debounce_ctx_t d;   // contexto único (compatibilidad con la API vieja)
+    d.stable_us = stable_ms * 1000LL;
+    return press_at(&d, raw, now_us());
+}
+
 /* --------------------- ESTADO ESTABLE (nivel 0/1) -------------------------
    Devuelve SIEMPRE el último nivel estable (0/1). No es "evento" puntual;
    es el valor con rebotes filtrados, aceptado sólo si se sostiene "stable_ms".
 
    raw:        0/1 crudo del botón.
-   stable_ms:  ventana mínima antes de aceptar el nuevo nivel.
+   now:        instante de la muestra en us.
 */
-int debounce_state(int raw, long long stable_ms){
-    static int last_stable = 0;   // Nivel aceptado (0/1)
-    static int candidate   = 0;   // Posible nuevo nivel
-    static long long t0    = 0;   // Marca temporal para estabilidad
-
-    if (raw != last_stable) {
+static int state_at(debounce_ctx_t *d, int raw, long long now){
+    if (raw != d->last_stable) {
         // Hay un intento de cambio de nivel
-        if (raw != candidate) {
+        if (raw != d->candidate) {
             // Nuevo candidato: reiniciar conteo de estabilidad
-            candidate = raw;
-            t0 = now_ms();
+            d->candidate = raw;
+            d->t0_us = now;
         } else {
             // El candidato se mantiene; verificar tiempo
-            if (now_ms() - t0 >= stable_ms) {
+            if (now - d->t0_us >= d->stable_us) {
                 // Aceptar nuevo nivel estable
-                last_stable = candidate;
+                d->last_stable = d->candidate;
             }
         }
     } else {
         // No hay cambios reales; mantener sincronía
-        candidate = last_stable;
-        t0 = now_ms(); // opcional
+        d->candidate = d->last_stable;
+        d->t0_us = now; // opcional
+    }
+    return d->last_stable; // nivel estable actual (0/1)
+}
+
+/* ----------------------- INTEGRADOR (contador saturado) -------------------
+   Cada muestra en 1 suma, cada muestra en 0 resta, sin pasarse de 0..samples.
+   El estable solo cambia al tocar un extremo: un pulso de ruido aislado baja
+   el contador uno y la siguiente muestra buena lo repone (histéresis).
+*/
+static int integrator_at(debounce_ctx_t *d, int raw){
+    if (raw) {
+        d->count += (d->count < d->samples);
+    } else {
+        d->count -= (d->count > 0);
+    }
+    if (d->count == 0) {
+        d->last_stable = 0;
+    } else if (d->count == d->samples) {
+        d->last_stable = 1;
+    }
+    return d->last_stable;
+}
+
+/* ------------------- HISTORIAL POR DESPLAZAMIENTO (shift) -----------------
+   hist guarda las últimas 8/16/32 muestras. Todas en 1 -> estable 1, todas
+   en 0 -> estable 0, mezcla -> sigue el anterior. Sin ramas.
+*/
+static int shift_at(debounce_ctx_t *d, int raw){
+    d->hist = ((d->hist << 1) | (uint32_t)(raw != 0)) & d->mask;
+    d->last_stable = (d->hist == d->mask) | (d->last_stable & (d->hist != 0));
+    return d->last_stable;
+}
+
+int debounce_ctx_state(debounce_ctx_t *d, int raw){
+    switch (d->algo) {
+        case DEBOUNCE_INTEGRATOR: return integrator_at(d, raw);
+        case DEBOUNCE_SHIFT8:
+        case DEBOUNCE_SHIFT16:
+        case DEBOUNCE_SHIFT32:    return shift_at(d, raw);
+        default:                  return state_at(d, raw, tick_us());
+    }
+}
+
+bool debounce_ctx_idle(const debounce_ctx_t *d, int raw){
+    switch (d->algo) {
+        case DEBOUNCE_INTEGRATOR:
+            return raw == d->last_stable && d->count == (d->last_stable ? d->samples : 0);
+        case DEBOUNCE_SHIFT8:
+        case DEBOUNCE_SHIFT16:
+        case DEBOUNCE_SHIFT32:
+            return d->hist == (d->last_stable ? d->mask : 0u) && raw == d->last_stable;
+        default:
+            return raw == d->last_stable;
+    }
+}
+
+int debounce_state(int raw, long long stable_ms){
+    static debounce_ctx_t d;   // contexto único (compatibilidad con la API vieja)
+    d.stable_us = stable_ms * 1000LL;
+    return state_at(&d, raw, now_us());
+}
+
+/* ---------------------- BANCO BIT-PARALELO (64 pines/palabra) -------------
+   Cada pin tiene un contador de muestras "distintas al estable". En vez de
+   guardar un int por pin, el contador se guarda en vertical: plano i = bit i
+   del contador de los 64 pines de la palabra. Con eso:
+
+     delta   = raw ^ stable         (pines que quieren cambiar)
+     cnt    &= delta                (los que volvieron al estable: reset)
+     cnt    += delta                (suma de 1 con acarreo entre planos)
+     reached = (cnt == samples)     (comparación plano a plano, sin ramas)
+     stable ^= reached              (aceptar el cambio) y reset de su contador
+
+   Un tick de N pines cuesta ~N/64 * (4 * nplanes) operaciones de bits.
+*/
+int debounce_bank_init(debounce_bank_t *b, size_t npins, unsigned samples){
+    if (samples < 1 || samples > DEBOUNCE_BANK_MAX_SAMPLES) {
+        return -1;
+    }
+    b->npins   = npins;
+    b->nwords  = (npins + 63) / 64;
+    b->samples = samples;
+
+    // bits necesarios para contar hasta "samples"
+    b->nplanes = 0;
+    while ((1u << b->nplanes) <= samples) {
+        b->nplanes++;
+    }
+    for (unsigned i = 0; i < 8; i++) {
+        b->thr[i] = ((samples >> i) & 1u) ? ~0ULL : 0ULL;
+    }
+
+    // una sola reserva: stable + contadores
+    b->stable = calloc(b->nwords * (1 + b->nplanes), sizeof(uint64_t));
+    if (b->stable == NULL) {
+        return -1;
+    }
+    b->cnt = b->stable + b->nwords;
+    return 0;
+}
+
+void debounce_bank_free(debounce_bank_t *b){
+    free(b->stable);
+    b->stable = NULL;
+    b->cnt    = NULL;
+    b->nwords = 0;
+}
+
+uint64_t debounce_bank_update(debounce_bank_t *b, const uint64_t *raw, uint64_t *changed){
+    const unsigned np = b->nplanes;
+    uint64_t any = 0;
+
+    for (size_t w = 0; w < b->nwords; w++) {
+        uint64_t *c     = &b->cnt[w * np];
+        uint64_t delta  = raw[w] ^ b->stable[w];
+        uint64_t carry  = delta;       // +1 solo donde hay diferencia
+        uint64_t reached = delta;      // candidatos a alcanzar el umbral
+
+        for (unsigned i = 0; i < np; i++) {
+            uint64_t ci = c[i] & delta;        // reset de los que no difieren
+            uint64_t t  = ci & carry;          // acarreo al siguiente plano
+            ci ^= carry;
+            carry = t;
+            reached &= ~(ci ^ b->thr[i]);      // bit i igual al del umbral
+            c[i] = ci;
+        }
+
+        // aceptar los cambios y reiniciar sus contadores
+        b->stable[w] ^= reached;
+        for (unsigned i = 0; i < np; i++) {
+            c[i] &= ~reached;
+        }
+
+        if (changed != NULL) {
+            changed[w] = reached;
+        }
+        any |= reached;
     }
-    return last_stable; // nivel estable actual (0/1)
+    return any;
 }
@@ -0,0 +1,111 @@
+/*
+  event.c — Espera de eventos con eventfd + epoll (Linux)
+
+  Ideas clave:
+  - eventfd = contador del kernel que sirve de "timbre": write() lo toca,
+    epoll_wait() despierta al que espera.
+  - "pending" evita una syscall por cada event_signal(): si el timbre ya
+    sonó y nadie lo atendió todavía, no hace falta tocarlo otra vez.
+  - Si un fd vigilado es un archivo regular (stdin redirigido), epoll no lo
+    acepta (EPERM); como un archivo siempre está "listo", lo marcamos así.
+  - Con reloj virtual (timeutil.h) no se bloquea por tiempo: se mira si hay
+    algo listo y, si no, "dormir" el timeout es adelantar el reloj virtual.
+*/
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include "event.h"
+#include "timeutil.h"
+
+static int efd  = -1;            // eventfd (timbre)
+static int epfd = -1;            // instancia epoll
+static int always_ready = 0;     // hay un fd que epoll no soporta (archivo regular)
+static atomic_int pending;       // 1 = el timbre ya sonó y no se atendió
+
+int event_init(void){
+    efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (efd == -1) {
+        return -1;
+    }
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd == -1) {
+        close(efd);
+        efd = -1;
+        return -1;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = efd };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, efd, &ev) == -1) {
+        event_close();
+        return -1;
+    }
+    atomic_store(&pending, 0);
+    always_ready = 0;
+    return 0;
+}
+
+void event_close(void){
+    if (epfd != -1) { close(epfd); epfd = -1; }
+    if (efd  != -1) { close(efd);  efd  = -1; }
+}
+
+int event_add_fd(int fd){
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = fd };
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        if (errno == EPERM) {
+            // archivo regular: siempre se puede leer sin bloquear
+            always_ready = 1;
+            return 0;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+void event_signal(void){
+    // solo el primero que encuentra pending=0 hace la syscall
+    if (atomic_exchange(&pending, 1) == 0 && efd != -1) {
+        uint64_t one = 1;
+        ssize_t r = write(efd, &one, sizeof(one));
+        (void)r;
+    }
+}
+
+int event_wait(long long timeout_ms){
+    int mask = 0;
+
+    // si ya hay algo pendiente, no dormimos
+    if (atomic_load(&pending) || always_ready) {
+        timeout_ms = 0;
+    }
+
+    // reloj virtual: mirar sin bloquear y, si no hay nada, adelantar el reloj
+    int virt = time_is_virtual() && timeout_ms > 0;
+
+    struct epoll_event evs[8];
+    int n = epoll_wait(epfd, evs, 8, virt ? 0 : (timeout_ms < 0) ? -1 : (int)timeout_ms);
+    if (virt && n == 0 && !atomic_load(&pending)) {
+        sleep_ms(timeout_ms);
+    }
+    for (int i = 0; i < n; i++) {
+        if (evs[i].data.fd != efd) {
+            mask |= EVENT_FD;
+        }
+    }
+
+    // atender el timbre: primero bajar pending y luego vaciar el contador,
+    // así un event_signal() que llegue en medio no se pierde
+    if (atomic_exchange(&pending, 0)) {
+        uint64_t v;
+        ssize_t r = read(efd, &v, sizeof(v));
+        (void)r;
+        mask |= EVENT_SIGNAL;
+    }
+    if (always_ready) {
+        mask |= EVENT_FD;
+    }
+    return mask;
+}
@@ -0,0 +1,317 @@
+/*
+  gpio_err.c — Contadores de errores de GPIO y log con límite de tasa
+
+  Camino de error (cualquier hilo que llame a gpio_*: el loop, el hilo del
+  PWM con gpio_write_mask, el "mundo" de irq_bench con gpio_simulate_input):
+    - un atomic_fetch_add en el total del error y en el del pin (o en el del
+      valor inválido, ver bad_count)
+    - una "cubeta de fichas" por tipo de error (GCRA: un instante teórico
+      que se avanza con CAS): si hay ficha, el mensaje (función, error, pin)
+      va a una cola de varios productores; si no, solo se cuenta como
+      suprimido
+  sin fprintf, sin syscalls (salvo leer el reloj), sin locks: en el peor
+  caso un productor reintenta un CAS que otro le ganó.
+
+  La cola es la de Vyukov acotada: cada celda lleva el número de vuelta
+  (pos sin los bits del índice). Un productor reserva la celda avanzando head
+  con CAS y la publica con seq = vuelta + 1; el consumidor (un solo hilo,
+  gpio_err_flush) solo lee celdas publicadas y las libera para la vuelta
+  siguiente. Todo en 0 es un estado válido, aunque no se haya llamado
+  gpio_err_reset. spsc.h no sirve acá: su reserve/publish supone un solo
+  productor. El primer
+  error después de un flush levanta "pending" y llama al aviso (un
+  event_signal): el loop se entera sin revisar la cola periódicamente.
+
+  gpio_err_flush() formatea y escribe lo que haya en la cola.
+*/
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "gpio_err.h"
+#include "gpio.h"
+#include "timeutil.h"
+
+#define ERR_RING_SIZE 64                          // mensajes en vuelo (potencia de 2)
+#define ERR_RING_MASK (ERR_RING_SIZE - 1)
+#define ERR_REFILL_NS (1000000000LL / GPIO_ERR_LOG_PER_S)
+#define ERR_BAD_KEYS  16                          // valores inválidos distintos contados por tipo
+#define ERR_KEY(v)    ((long long)(v) * 2 + 1)    // clave en bad_key (0 = celda libre)
+
+typedef struct{
+    int32_t   pin;
+    uint8_t   op;
+    uint8_t   err;
+} err_rec_t;
+
+typedef struct{
+    atomic_size_t seq; // == vuelta de pos: libre; == vuelta + 1: publicada
+    err_rec_t     rec;
+} err_cell_t;
+
+static const char *const op_name[GPIO_OP_COUNT] = {
+    "gpio_mode", "gpio_set_pull", "gpio_write", "gpio_read", "gpio_port_read",
+    "gpio_port_write", "gpio_write_mask", "gpio_simulate_input", "gpio_irq_attach",
+    "gpio_read_bank"
+};
+
+static const char *const err_fmt[GPIO_ERR_COUNT] = {
+    "%s: Pin %d no es válido.\n",
+    "%s: Puerto %d no es válido.\n",
+    "%s: Pin %d no está configurado como entrada.\n",
+    "%s: Pin %d no está configurado como salida.\n"
+};
+
+static atomic_uint_fast64_t totals[GPIO_ERR_COUNT];
+static atomic_uint_fast64_t suppressed;
+// errores de modo: el pin es válido, [pin][err - GPIO_ERR_NOT_INPUT]
+static atomic_uint_fast64_t per_pin[GPIO_PIN_MAX][2];
+// pin / puerto inválido: el valor no indexa nada, tabla chica por tipo
+// (direccionamiento abierto; la celda se toma con CAS y no se suelta)
+static atomic_llong         bad_key[2][ERR_BAD_KEYS];
+static atomic_uint_fast64_t bad_cnt[2][ERR_BAD_KEYS];
+static atomic_uint_fast64_t bad_other[2];    // tabla llena
+
+static atomic_llong  tat[GPIO_ERR_COUNT];    // cubetas: instante teórico de la próxima ficha
+static err_cell_t    ring[ERR_RING_SIZE];
+static atomic_size_t head;                   // próximo a reservar (productores)
+static size_t        tail;                   // próximo a leer (solo gpio_err_flush)
+static uint64_t      suppressed_seen;        // lo último avisado por gpio_err_flush
+static atomic_int   pending;                 // 1 = hay algo para gpio_err_flush (ya avisado)
+static void       (*notify)(void);           // gpio_err_notify_attach
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static int per_pin_slot(gpio_err_t err){
+    return (err == GPIO_ERR_NOT_INPUT || err == GPIO_ERR_NOT_OUTPUT) ? (int)(err - GPIO_ERR_NOT_INPUT) : -1;
+}
+
+static int bad_slot(gpio_err_t err){
+    return (err == GPIO_ERR_BAD_PIN || err == GPIO_ERR_BAD_PORT) ? (int)(err - GPIO_ERR_BAD_PIN) : -1;
+}
+
+// Contador de v en la tabla de valores inválidos (toma una celda si claim). NULL = no está / llena
+static atomic_uint_fast64_t *bad_find(int slot, int v, int claim){
+    for (int k = 0; k < ERR_BAD_KEYS; k++) {
+        int i = (int)(((unsigned)v + (unsigned)k) % ERR_BAD_KEYS);
+        long long key = atomic_load_explicit(&bad_key[slot][i], memory_order_relaxed);
+        if (key == 0 && claim) {
+            // si otro la tomó antes, key queda con su valor y se compara abajo
+            atomic_compare_exchange_strong_explicit(&bad_key[slot][i], &key, ERR_KEY(v),
+                                                    memory_order_relaxed, memory_order_relaxed);
+            if (key == 0) {
+                return &bad_cnt[slot][i];
+            }
+        }
+        if (key == ERR_KEY(v)) {
+            return &bad_cnt[slot][i];
+        }
+        if (key == 0) {
+            return NULL; // sin tomar: v nunca se contó
+        }
+    }
+    return NULL;
+}
+
+static void count_pin(gpio_err_t err, int pin){
+    int slot = per_pin_slot(err);
+    if (slot >= 0) {
+        if (pin >= 0 && pin < GPIO_PIN_MAX) {
+            atomic_fetch_add_explicit(&per_pin[pin][slot], 1, memory_order_relaxed);
+        }
+        return;
+    }
+    slot = bad_slot(err);
+    atomic_uint_fast64_t *c = bad_find(slot, pin, 1);
+    atomic_fetch_add_explicit(c != NULL ? c : &bad_other[slot], 1, memory_order_relaxed);
+}
+
+/*
+    ¿se puede escribir otro mensaje de este tipo? Cubeta de fichas como GCRA:
+    t es el instante en que la cubeta estaría llena de nuevo; cada mensaje lo
+    corre ERR_REFILL_NS y no puede quedar más de una ráfaga por delante de now
+*/
+static int bucket_take(atomic_llong *t, long long now){
+    long long old = atomic_load_explicit(t, memory_order_relaxed);
+    for (;;) {
+        long long next = (old > now ? old : now) + ERR_REFILL_NS;
+        if (next - now > GPIO_ERR_LOG_BURST * ERR_REFILL_NS) {
+            return 0;
+        }
+        if (atomic_compare_exchange_weak_explicit(t, &old, next, memory_order_relaxed, memory_order_relaxed)) {
+            return 1;
+        }
+    }
+}
+
+static size_t lap_of(size_t pos){
+    return pos & ~(size_t)ERR_RING_MASK;
+}
+
+// Reserva una celda de la cola (varios productores). NULL = llena
+static err_cell_t *ring_reserve(size_t *pos){
+    size_t p = atomic_load_explicit(&head, memory_order_relaxed);
+    for (;;) {
+        err_cell_t *c = &ring[p & ERR_RING_MASK];
+        size_t      s = atomic_load_explicit(&c->seq, memory_order_acquire);
+        if (s == lap_of(p)) {
+            if (atomic_compare_exchange_weak_explicit(&head, &p, p + 1, memory_order_relaxed, memory_order_relaxed)) {
+                *pos = p;
+                return c;
+            }
+        } else if ((ptrdiff_t)(s - lap_of(p)) < 0) {
+            return NULL; // la celda todavía tiene el mensaje de una vuelta anterior
+        } else {
+            p = atomic_load_explicit(&head, memory_order_relaxed);
+        }
+    }
+}
+
+static void ring_reset(void){
+    for (size_t i = 0; i < ERR_RING_SIZE; i++) {
+        atomic_store_explicit(&ring[i].seq, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&head, 0, memory_order_relaxed);
+    tail = 0;
+}
+
+// Solo el primer error desde el último flush avisa
+static void mark_pending(void){
+    if (!atomic_exchange(&pending, 1) && notify != NULL) {
+        notify();
+    }
+}
+
+/*==========================================================
+=                  API PÚBLICA (gpio_err.h)                =
+==========================================================*/
+
+void gpio_err_report(gpio_op_t op, gpio_err_t err, int pin){
+    atomic_fetch_add_explicit(&totals[err], 1, memory_order_relaxed);
+    count_pin(err, pin);
+
+    size_t      pos;
+    err_cell_t *c;
+    if (!bucket_take(&tat[err], now_ns()) || (c = ring_reserve(&pos)) == NULL) {
+        atomic_fetch_add_explicit(&suppressed, 1, memory_order_relaxed);
+        mark_pending();
+        return;
+    }
+    c->rec = (err_rec_t){ .pin = pin, .op = (uint8_t)op, .err = (uint8_t)err };
+    atomic_store_explicit(&c->seq, lap_of(pos) + 1, memory_order_release);
+    mark_pending();
+}
+
+void gpio_err_notify_attach(void (*fn)(void)){
+    notify = fn;
+}
+
+int gpio_err_pending(void){
+    return atomic_load(&pending);
+}
+
+uint64_t gpio_err_count(gpio_err_t err){
+    if (err < 0 || err >= GPIO_ERR_COUNT) {
+        return 0;
+    }
+    return atomic_load_explicit(&totals[err], memory_order_relaxed);
+}
+
+uint64_t gpio_err_pin_count(int pin, gpio_err_t err){
+    int slot = per_pin_slot(err);
+    if (slot >= 0) {
+        return (pin >= 0 && pin < GPIO_PIN_MAX) ? atomic_load_explicit(&per_pin[pin][slot], memory_order_relaxed) : 0;
+    }
+    slot = bad_slot(err);
+    if (slot < 0) {
+        return 0;
+    }
+    atomic_uint_fast64_t *c = bad_find(slot, pin, 0);
+    return c != NULL ? atomic_load_explicit(c, memory_order_relaxed) : 0;
+}
+
+uint64_t gpio_err_suppressed(void){
+    return atomic_load_explicit(&suppressed, memory_order_relaxed);
+}
+
+int gpio_err_flush(FILE *f){
+    // bajar la marca antes de mirar la cola: lo que llegue después vuelve a avisar
+    atomic_store(&pending, 0);
+    int n = 0;
+    for (;;) {
+        err_cell_t *c = &ring[tail & ERR_RING_MASK];
+        if (atomic_load_explicit(&c->seq, memory_order_acquire) != lap_of(tail) + 1) {
+            break; // vacía, o el productor reservó y todavía no publicó
+        }
+        const err_rec_t *r = &c->rec;
+        fprintf(f, err_fmt[r->err], op_name[r->op], (int)r->pin);
+        atomic_store_explicit(&c->seq, lap_of(tail) + ERR_RING_SIZE, memory_order_release); // libre para la vuelta siguiente
+        tail++;
+        n++;
+    }
+
+    uint64_t s = gpio_err_suppressed();
+    if (s != suppressed_seen) {
+        fprintf(f, "gpio: %llu mensajes de error suprimidos (ver contadores)\n",
+                (unsigned long long)(s - suppressed_seen));
+        suppressed_seen = s;
+    }
+    return n;
+}
+
+void gpio_err_dump(FILE *f){
+    static const char *const err_name[GPIO_ERR_COUNT] = {
+        "pin no válido", "puerto no válido", "pull en salida", "escritura en entrada"
+    };
+    for (int e = 0; e < GPIO_ERR_COUNT; e++) {
+        uint64_t n = gpio_err_count((gpio_err_t)e);
+        if (n == 0) {
+            continue;
+        }
+        fprintf(f, "gpio: %-22s %llu\n", err_name[e], (unsigned long long)n);
+        int slot = bad_slot((gpio_err_t)e);
+        if (slot >= 0) {
+            for (int i = 0; i < ERR_BAD_KEYS; i++) {
+                long long key = atomic_load_explicit(&bad_key[slot][i], memory_order_relaxed);
+                if (key != 0) {
+                    fprintf(f, "        %-4s %-6lld %llu\n", slot == 0 ? "pin" : "port", (key - 1) / 2,
+                            (unsigned long long)atomic_load_explicit(&bad_cnt[slot][i], memory_order_relaxed));
+                }
+            }
+            uint64_t o = atomic_load_explicit(&bad_other[slot], memory_order_relaxed);
+            if (o != 0) {
+                fprintf(f, "        otros       %llu\n", (unsigned long long)o);
+            }
+            continue;
+        }
+        for (int pin = 0; pin < GPIO_PIN_MAX; pin++) {
+            uint64_t c = gpio_err_pin_count(pin, (gpio_err_t)e);
+            if (c != 0) {
+                fprintf(f, "        pin %-6d %llu\n", pin, (unsigned long long)c);
+            }
+        }
+    }
+}
+
+void gpio_err_reset(void){
+    for (int e = 0; e < GPIO_ERR_COUNT; e++) {
+        atomic_store_explicit(&totals[e], 0, memory_order_relaxed);
+        atomic_store_explicit(&tat[e], 0, memory_order_relaxed);
+    }
+    for (int pin = 0; pin < GPIO_PIN_MAX; pin++) {
+        atomic_store_explicit(&per_pin[pin][0], 0, memory_order_relaxed);
+        atomic_store_explicit(&per_pin[pin][1], 0, memory_order_relaxed);
+    }
+    for (int s = 0; s < 2; s++) {
+        for (int i = 0; i < ERR_BAD_KEYS; i++) {
+            atomic_store_explicit(&bad_key[s][i], 0, memory_order_relaxed);
+            atomic_store_explicit(&bad_cnt[s][i], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&bad_other[s], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&suppressed, 0, memory_order_relaxed);
+    suppressed_seen = 0;
+    atomic_store(&pending, 0);
+    ring_reset();
+}
@@ -0,0 +1,766 @@
+/*
+    gpio_shm.c — IMPLEMENTACIÓN DE gpio.h SOBRE MEMORIA COMPARTIDA
+
+    ¿QUÉ ES ESTO?
+    -------------
+    - Es otro "backend" de la capa GPIO, igual que gpio_sim.c (o un futuro
+      gpio_hw.c): mismas funciones, mismo comportamiento para el firmware.
+    - La diferencia es DÓNDE viven los registros: en una región de /dev/shm
+      (shm_open + mmap) que pueden abrir varios procesos a la vez. Es como si
+      todos estuvieran conectados a la MISMA placa:
+        * el firmware escribe su LED y lee su botón
+        * otro proceso (bin/gpio_shm, un tablero, otro dispositivo simulado)
+          inyecta entradas y mira las salidas, a velocidad de memoria
+
+    ¿CÓMO SE USA?
+    -------------
+    - Se enlaza gpio_shm.o en lugar de gpio_sim.o ("make shm").
+    - GPIO_SHM_NAME=/mi_placa elige la placa (por defecto GPIO_SHM_DEFAULT).
+    - El primer proceso la crea en estado seguro; los demás se unen sin
+      borrar nada (gpio_init NO resetea una placa que ya existía).
+
+    CONCURRENCIA
+    ------------
+    - seqlock por puerto: el escritor toma "seq" con un CAS (impar = ocupado),
+      modifica y la deja par otra vez. El lector copia los registros y
+      repite si seq cambió o era impar: nunca espera a nadie.
+    - Un proceso que muere a mitad de una escritura deja seq impar para
+      siempre. Lectores y escritores que ven el MISMO valor impar durante
+      SHM_STUCK_NS (reloj real) dan al escritor por muerto: lo avisan por
+      stderr, lo cuentan (gpio_shm_stale_writers) y dejan seq par. Ese
+      puerto puede quedar con un registro a medio escribir, pero nadie se
+      cuelga.
+    - Contadores de cambios en la cabecera (seq, in_seq, out_seq) y contadores
+      de "cuántos esperan": el futex para despertar solo se usa si hay alguien
+      esperando. Escribir un pin = CAS + unas cargas/escrituras, sin syscalls.
+    - Las interrupciones (EXTI) son de cada proceso: la tabla de handlers no
+      se comparte. Un hilo espera cambios de entradas de otros procesos y
+      despierta al loop (event_signal); gpio_poll() compara y llama handlers
+      en el hilo del loop, como en gpio_sim.c.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "gpio.h"
+#include "gpio_shm.h"
+#include "gpio_err.h"
+#include "pins.h"
+#include "event.h"
+#include "trace.h"
+#include "vcd.h"
+#include "timeutil.h"
+
+#define SHM_MAGIC   0x4750494Fu // "GPIO"
+#define SHM_VERSION 1u
+#define SHM_JOIN_WAIT_NS 1000000000LL // cuánto espera el que se une a que el creador termine
+#define SHM_STUCK_NS     100000000LL  // seq impar sin moverse tanto tiempo = escritor muerto
+#define SHM_SPIN_CHECK   1024         // vueltas entre lecturas del reloj mientras se espera seq
+
+_Static_assert(PIN_COUNT <= GPIO_PIN_MAX, "pins.h define mas pines de los que simula gpio_shm.c");
+
+/*==========================================================
+=             LA "PLACA" (vive en /dev/shm)                =
+==========================================================*/
+
+/* Mismos registros que gpio_port_t de gpio_sim.c, más la secuencia del
+   seqlock; un puerto por línea de caché para que dos procesos que tocan
+   puertos distintos no se peleen la misma línea. */
+typedef struct{
+    _Alignas(64) atomic_uint seq;  // par = estable, impar = alguien escribe
+    atomic_uint_least64_t moder;   // 1 = GPIO_OUTPUT
+    atomic_uint_least64_t pu;      // 1 = GPIO_PULLUP
+    atomic_uint_least64_t pd;      // 1 = GPIO_PULLDOWN
+    atomic_uint_least64_t odr;     // valor escrito (salidas)
+    atomic_uint_least64_t idr;     // valor crudo (entradas)
+} shm_port_t;
+
+typedef struct{
+    atomic_uint state;         // 0 = vacía, 1 = inicializando, 2 = lista
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    nports;
+    atomic_uint seq;           // cambios de cualquier tipo (futex de gpio_shm_wait)
+    atomic_uint in_seq;        // cambios de entradas, modo o pull (futex del hilo de flancos)
+    atomic_uint out_seq;       // cambios de salidas
+    atomic_uint waiters;       // procesos esperando en seq
+    atomic_uint in_waiters;    // hilos esperando en in_seq
+    atomic_uint procs;         // procesos con la placa abierta
+    shm_port_t  ports[GPIO_PORT_COUNT];
+} shm_board_t;
+
+/* Copia coherente de un puerto (lo que lee el seqlock) */
+typedef struct{
+    uint64_t moder, pu, odr, idr;
+} port_snap_t;
+
+static shm_board_t *board = NULL;
+static int          board_created = 0;
+static int          board_shared  = 0;   // 0 = memoria privada (no se pudo abrir /dev/shm)
+static char         board_name[64];
+static atomic_uint_fast64_t stale_writers; // escritores dados por muertos (seq liberada)
+
+/*==========================================================
+=        INTERRUPCIONES (locales a este proceso)           =
+==========================================================*/
+
+typedef struct{
+    uint64_t rtsr; //flanco de subida habilitado
+    uint64_t ftsr; //flanco de bajada habilitado
+} gpio_exti_t;
+
+typedef struct{
+    gpio_irq_handler_t handler;
+    void *arg;
+} gpio_irq_slot_t;
+
+static gpio_exti_t     exti[GPIO_PORT_COUNT];
+static gpio_irq_slot_t irq[GPIO_PIN_MAX];
+static uint64_t        last_level[GPIO_PORT_COUNT]; // último nivel visto (para detectar flancos)
+
+static pthread_t  watcher;
+static int        watcher_running = 0;
+static atomic_int watcher_stop;
+
+/* Grabación de entradas crudas (NULL = no se graba) */
+static trace_writer_t *trace_out = NULL;
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static int pin_is_valid(int pin){
+    return (pin >= 0 && pin < GPIO_PIN_MAX);
+}
+
+static int port_is_valid(int port){
+    return (port >= 0 && port < GPIO_PORT_COUNT);
+}
+
+static inline void cpu_relax(void){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static long futex(atomic_uint *addr, int op, unsigned val, const struct timespec *ts){
+    return syscall(SYS_futex, addr, op, val, ts, NULL, 0);
+}
+
+/* ---- seqlock ---- */
+
+/* Espera de un lector o escritor que encontró seq impar */
+typedef struct{
+    unsigned  seen;  // valor impar que se está esperando
+    unsigned  spins;
+    long long t0;    // desde cuándo (reloj real; 0 = todavía no se miró)
+} port_spin_t;
+
+/*
+   Una vuelta de espera con seq == s (impar). Si s no se movió en
+   SHM_STUCK_NS, el escritor murió con el puerto tomado: se libera.
+   El reloj se lee cada SHM_SPIN_CHECK vueltas
+*/
+static void port_spin(shm_port_t *p, unsigned s, port_spin_t *w){
+    cpu_relax();
+    if (s != w->seen) {
+        w->seen  = s;
+        w->spins = 0;
+        w->t0    = 0;
+        return;
+    }
+    if (++w->spins % SHM_SPIN_CHECK != 0) {
+        return;
+    }
+    long long now = TIME_SOURCE_REAL.now_ns();
+    if (w->t0 == 0) {
+        w->t0 = now;
+        return;
+    }
+    if (now - w->t0 < SHM_STUCK_NS) {
+        return;
+    }
+    if (atomic_compare_exchange_strong(&p->seq, &s, s + 1)) {
+        atomic_fetch_add(&stale_writers, 1);
+        fprintf(stderr, "gpio_shm: puerto %d tomado hace más de %lld ms (escritor muerto?); se libera\n",
+                (int)(p - board->ports), SHM_STUCK_NS / 1000000);
+    }
+    w->t0 = 0;
+}
+
+static unsigned port_lock(shm_port_t *p){
+    port_spin_t w = { 0 };
+    for (;;) {
+        unsigned s = atomic_load_explicit(&p->seq, memory_order_relaxed);
+        if (!(s & 1u)) {
+            if (atomic_compare_exchange_weak_explicit(&p->seq, &s, s + 1,
+                                                      memory_order_acquire, memory_order_relaxed)) {
+                return s + 1;
+            }
+            cpu_relax();
+            continue;
+        }
+        port_spin(p, s, &w);
+    }
+}
+
+static void port_unlock(shm_port_t *p, unsigned s){
+    atomic_store_explicit(&p->seq, s + 1, memory_order_release);
+}
+
+static void port_snapshot(shm_port_t *p, port_snap_t *o){
+    port_spin_t w = { 0 };
+    for (;;) {
+        unsigned s0 = atomic_load_explicit(&p->seq, memory_order_acquire);
+        if (s0 & 1u) {
+            port_spin(p, s0, &w);
+            continue;
+        }
+        o->moder = atomic_load_explicit(&p->moder, memory_order_relaxed);
+        o->pu    = atomic_load_explicit(&p->pu, memory_order_relaxed);
+        o->odr   = atomic_load_explicit(&p->odr, memory_order_relaxed);
+        o->idr   = atomic_load_explicit(&p->idr, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&p->seq, memory_order_relaxed) == s0) {
+            return;
+        }
+    }
+}
+
+/* Nivel efectivo, sin ramas (mismo cálculo que gpio_sim.c) */
+static inline uint64_t snap_level(const port_snap_t *s){
+    return (s->odr & s->moder) | ((s->idr | s->pu) & ~s->moder);
+}
+
+static uint64_t port_level(int port){
+    port_snap_t s;
+    port_snapshot(&board->ports[port], &s);
+    return snap_level(&s);
+}
+
+/* ---- avisos de cambio: la syscall solo si alguien espera ---- */
+
+static void notify(int input){
+    if (input) {
+        atomic_fetch_add(&board->in_seq, 1);
+    } else {
+        atomic_fetch_add(&board->out_seq, 1);
+    }
+    atomic_fetch_add(&board->seq, 1);
+    if (!board_shared) {
+        return;
+    }
+    if (input && atomic_load(&board->in_waiters) != 0) {
+        futex(&board->in_seq, FUTEX_WAKE, INT_MAX, NULL);
+    }
+    if (atomic_load(&board->waiters) != 0) {
+        futex(&board->seq, FUTEX_WAKE, INT_MAX, NULL);
+    }
+}
+
+/* Volcado VCD de los bits "changed" de un puerto */
+static void vcd_port_changes(int port, uint64_t changed, uint64_t level){
+    long long t = now_ns();
+    while (changed != 0) {
+        int b = __builtin_ctzll(changed);
+        vcd_change(t, port * GPIO_PORT_WIDTH + b, (int)((level >> b) & 1u));
+        changed &= changed - 1;
+    }
+}
+
+/* Flancos de un puerto contra el último nivel visto: llama a los handlers.
+   Retorna 1 si hubo alguno */
+static int port_edges(int port, uint64_t after){
+    uint64_t before = last_level[port];
+    last_level[port] = after;
+    uint64_t hit = (~before & after & exti[port].rtsr) | (before & ~after & exti[port].ftsr);
+    int any = (hit != 0);
+    while (hit != 0) {
+        int b = __builtin_ctzll(hit);
+        int pin = port * GPIO_PORT_WIDTH + b;
+        if (irq[pin].handler != NULL) {
+            irq[pin].handler(pin, (int)((after >> b) & 1u), irq[pin].arg);
+        }
+        hit &= hit - 1;
+    }
+    return any;
+}
+
+/* Hilo de flancos: duerme en in_seq (futex compartido) y despierta al loop */
+static void *edge_watcher(void *arg){
+    (void)arg;
+    unsigned seen = atomic_load(&board->in_seq);
+    while (!atomic_load(&watcher_stop)) {
+        atomic_fetch_add(&board->in_waiters, 1);
+        if (atomic_load(&board->in_seq) == seen) {
+            struct timespec ts = { 0, 100000000L }; // 100 ms: revisar watcher_stop
+            futex(&board->in_seq, FUTEX_WAIT, seen, &ts);
+        }
+        atomic_fetch_sub(&board->in_waiters, 1);
+        unsigned now = atomic_load(&board->in_seq);
+        if (now != seen) {
+            seen = now;
+            event_signal(); // el loop llamará a gpio_poll()
+        }
+    }
+    return NULL;
+}
+
+static void watcher_start(void){
+    if (watcher_running || !board_shared) {
+        return;
+    }
+    atomic_store(&watcher_stop, 0);
+    if (pthread_create(&watcher, NULL, edge_watcher, NULL) == 0) {
+        watcher_running = 1;
+    }
+}
+
+static void watcher_join(void){
+    if (!watcher_running) {
+        return;
+    }
+    atomic_store(&watcher_stop, 1);
+    futex(&board->in_seq, FUTEX_WAKE, INT_MAX, NULL);
+    pthread_join(watcher, NULL);
+    watcher_running = 0;
+}
+
+static void board_clear(void){
+    for (int k = 0; k < GPIO_PORT_COUNT; k++) {
+        shm_port_t *p = &board->ports[k];
+        unsigned s = port_lock(p);
+        atomic_store_explicit(&p->moder, 0, memory_order_relaxed);
+        atomic_store_explicit(&p->pu, 0, memory_order_relaxed);
+        atomic_store_explicit(&p->pd, 0, memory_order_relaxed);
+        atomic_store_explicit(&p->odr, 0, memory_order_relaxed);
+        atomic_store_explicit(&p->idr, 0, memory_order_relaxed);
+        port_unlock(p, s);
+    }
+}
+
+/*
+   Espera corta con backoff (100 us, 200 us... hasta 10 ms) para el que se une
+   mientras el creador todavía está en ftruncate / inicializando. Reloj real
+   aunque el programa use el virtual. 0 cuando se pasó de SHM_JOIN_WAIT_NS
+*/
+static int join_backoff(long long *waited, long long *step){
+    if (*waited >= SHM_JOIN_WAIT_NS) {
+        return 0;
+    }
+    TIME_SOURCE_REAL.sleep_ns(*step);
+    *waited += *step;
+    if (*step < 10000000LL) {
+        *step *= 2;
+    }
+    return 1;
+}
+
+/*
+   Abre (o crea) la placa compartida. -1 si no se pudo (errno), 1 si el
+   sistema no tiene /dev/shm (ENOENT / ENOSYS: se sigue con una placa privada)
+*/
+static int board_open(const char *name){
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0666);
+    int created = (fd != -1);
+    if (fd == -1 && errno == EEXIST) {
+        fd = shm_open(name, O_RDWR, 0666);
+    }
+    if (fd == -1) {
+        return (errno == ENOENT || errno == ENOSYS) ? 1 : -1;
+    }
+    if (created && ftruncate(fd, sizeof(shm_board_t)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    // el creador puede estar entre shm_open(O_EXCL) y ftruncate: tamaño 0 por un rato
+    struct stat st;
+    long long waited = 0, step = 100000;
+    for (;;) {
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return -1;
+        }
+        if ((size_t)st.st_size >= sizeof(shm_board_t)) {
+            break;
+        }
+        if (created || !join_backoff(&waited, &step)) {
+            close(fd);
+            errno = EINVAL; // placa de otro tamaño (otro GPIO_PORT_COUNT) o creador colgado
+            return -1;
+        }
+    }
+    void *m = mmap(NULL, sizeof(shm_board_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        return -1;
+    }
+    shm_board_t *b = m;
+
+    // el primero que la encuentra vacía la inicializa; el resto espera a que esté lista
+    unsigned expect = 0;
+    if (atomic_compare_exchange_strong(&b->state, &expect, 1)) {
+        b->magic   = SHM_MAGIC;
+        b->version = SHM_VERSION;
+        b->nports  = GPIO_PORT_COUNT;
+        atomic_store(&b->state, 2);
+    } else {
+        while (atomic_load(&b->state) != 2) {
+            if (!join_backoff(&waited, &step)) {
+                munmap(m, sizeof(shm_board_t));
+                errno = ETIMEDOUT; // el que la inicializaba no terminó
+                return -1;
+            }
+        }
+    }
+    if (b->magic != SHM_MAGIC || b->version != SHM_VERSION || b->nports != GPIO_PORT_COUNT) {
+        munmap(m, sizeof(shm_board_t));
+        errno = EINVAL;
+        return -1;
+    }
+    board = b;
+    board_created = created;
+    board_shared  = 1;
+    atomic_fetch_add(&b->procs, 1);
+    return 0;
+}
+
+/*==========================================================
+=                    API PÚBLICA (gpio.h)                  =
+==========================================================*/
+
+/*
+   gpio_init()
+   -----------
+   Abre la placa de GPIO_SHM_NAME (o la crea en estado seguro). Si ya
+   existía NO se toca: los pines de los otros procesos siguen como estaban.
+   Si el sistema no tiene /dev/shm, sigue con una placa privada (como
+   gpio_sim). Cualquier otra falla (placa de otro tamaño o versión, creador
+   que no terminó en SHM_JOIN_WAIT_NS, sin permisos, mmap) es un error: -1,
+   con el motivo en stderr. Unirse a una placa privada en silencio haría que
+   el programa "ande" sin ver a los demás procesos.
+*/
+int gpio_init(void){
+    if (board == NULL) {
+        const char *name = getenv("GPIO_SHM_NAME");
+        snprintf(board_name, sizeof(board_name), "%s", (name != NULL && name[0] == '/') ? name : GPIO_SHM_DEFAULT);
+        int rc = board_open(board_name);
+        if (rc < 0) {
+            fprintf(stderr, "gpio_shm: no se pudo abrir %s (%s)\n", board_name, strerror(errno));
+            return -1;
+        }
+        if (rc > 0) {
+            fprintf(stderr, "gpio_shm: sin /dev/shm para %s; placa privada\n", board_name);
+            void *m = mmap(NULL, sizeof(shm_board_t), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (m == MAP_FAILED) {
+                perror("gpio_shm: mmap");
+                return -1;
+            }
+            board         = m;
+            board_created = 1;
+            board_shared  = 0;
+        }
+        atexit(gpio_shm_close);
+    }
+    //interrupciones: solo las de este proceso
+    memset(exti, 0, sizeof(exti));
+    memset(irq, 0, sizeof(irq));
+    gpio_err_reset();
+    return 0;
+}
+
+void gpio_mode(int pin, gpio_mode_t mode){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_MODE, GPIO_ERR_BAD_PIN, pin);
+        return;
+    }
+    shm_port_t *p = &board->ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    unsigned s = port_lock(p);
+    uint64_t m = atomic_load_explicit(&p->moder, memory_order_relaxed);
+    atomic_store_explicit(&p->moder, (mode == GPIO_OUTPUT) ? (m | bit) : (m & ~bit), memory_order_relaxed);
+    port_unlock(p, s);
+    notify(1);
+}
+
+void gpio_set_pull(int pin, gpio_pull_t pull){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_SET_PULL, GPIO_ERR_BAD_PIN, pin);
+        return;
+    }
+    shm_port_t *p = &board->ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    unsigned s = port_lock(p);
+    if (atomic_load_explicit(&p->moder, memory_order_relaxed) & bit) {
+        port_unlock(p, s);
+        gpio_err_report(GPIO_OP_SET_PULL, GPIO_ERR_NOT_INPUT, pin);
+        return;
+    }
+    uint64_t pu = atomic_load_explicit(&p->pu, memory_order_relaxed);
+    uint64_t pd = atomic_load_explicit(&p->pd, memory_order_relaxed);
+    atomic_store_explicit(&p->pu, (pull == GPIO_PULLUP)   ? (pu | bit) : (pu & ~bit), memory_order_relaxed);
+    atomic_store_explicit(&p->pd, (pull == GPIO_PULLDOWN) ? (pd | bit) : (pd & ~bit), memory_order_relaxed);
+    port_unlock(p, s);
+    notify(1);
+}
+
+void gpio_write(int pin, int value){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_WRITE, GPIO_ERR_BAD_PIN, pin);
+        return;
+    }
+    shm_port_t *p = &board->ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    unsigned s = port_lock(p);
+    if (!(atomic_load_explicit(&p->moder, memory_order_relaxed) & bit)) {
+        port_unlock(p, s);
+        gpio_err_report(GPIO_OP_WRITE, GPIO_ERR_NOT_OUTPUT, pin);
+        return;
+    }
+    uint64_t old = atomic_load_explicit(&p->odr, memory_order_relaxed);
+    uint64_t now = value ? (old | bit) : (old & ~bit);
+    atomic_store_explicit(&p->odr, now, memory_order_relaxed);
+    port_unlock(p, s);
+    if (old != now) {
+        notify(0);
+        if (vcd_active) {
+            vcd_change(now_ns(), pin, value != 0);
+        }
+    }
+}
+
+int gpio_read(int pin){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_READ, GPIO_ERR_BAD_PIN, pin);
+        return 0;
+    }
+    int sh = pin % GPIO_PORT_WIDTH;
+    return (int)((port_level(GPIO_PORT_OF(pin)) >> sh) & 1u);
+}
+
+uint64_t gpio_port_read(int port){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_PORT_READ, GPIO_ERR_BAD_PORT, port);
+        return 0;
+    }
+    return port_level(port);
+}
+
+int gpio_read_bank(int port, int nports, uint64_t *out){
+    if(!port_is_valid(port) || nports <= 0 || nports > GPIO_PORT_COUNT - port){
+        gpio_err_report(GPIO_OP_READ_BANK, GPIO_ERR_BAD_PORT, port);
+        return 0;
+    }
+    for (int k = 0; k < nports; k++) {
+        out[k] = port_level(port + k);
+    }
+    return nports;
+}
+
+void gpio_read_all(uint64_t *out){
+    for (int k = 0; k < GPIO_PORT_COUNT; k++) {
+        out[k] = port_level(k);
+    }
+}
+
+/* ODR nuevo = (viejo fuera de m) | (value dentro de m), con m limitado a salidas */
+static void port_write_masked(int port, uint64_t mask, uint64_t value){
+    shm_port_t *p = &board->ports[port];
+    unsigned s = port_lock(p);
+    uint64_t m   = mask & atomic_load_explicit(&p->moder, memory_order_relaxed);
+    uint64_t old = atomic_load_explicit(&p->odr, memory_order_relaxed);
+    uint64_t now = (old & ~m) | (value & m);
+    atomic_store_explicit(&p->odr, now, memory_order_relaxed);
+    port_unlock(p, s);
+    if (old != now) {
+        notify(0);
+        if (vcd_active) {
+            vcd_port_changes(port, old ^ now, now);
+        }
+    }
+}
+
+void gpio_port_write(int port, uint64_t value){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_PORT_WRITE, GPIO_ERR_BAD_PORT, port);
+        return;
+    }
+    port_write_masked(port, ~0ULL, value);
+}
+
+void gpio_write_mask(int port, uint64_t mask, uint64_t value){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_WRITE_MASK, GPIO_ERR_BAD_PORT, port);
+        return;
+    }
+    port_write_masked(port, mask, value);
+}
+
+/*
+   gpio_simulate_input(pin, value)
+   -------------------------------
+   Escribe el crudo en la placa compartida: lo ven todos los procesos. Los
+   handlers de ESTE proceso se llaman ya (como en gpio_sim.c); los de los
+   demás, desde su gpio_poll().
+*/
+void gpio_simulate_input(int pin, int value){
+    if (!pin_is_valid(pin)) {
+        gpio_err_report(GPIO_OP_SIMULATE_INPUT, GPIO_ERR_BAD_PIN, pin);
+        return;
+    }
+    int port = GPIO_PORT_OF(pin);
+    shm_port_t *p = &board->ports[port];
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    unsigned s = port_lock(p);
+    uint64_t raw_before = atomic_load_explicit(&p->idr, memory_order_relaxed);
+    uint64_t raw_after  = value ? (raw_before | bit) : (raw_before & ~bit);
+    atomic_store_explicit(&p->idr, raw_after, memory_order_relaxed);
+    port_unlock(p, s);
+    if (raw_before == raw_after) {
+        return;
+    }
+    notify(1);
+
+    if (trace_out != NULL) {
+        trace_writer_add(trace_out, now_ns(), pin, value != 0);
+    }
+    if (vcd_active || (exti[port].rtsr | exti[port].ftsr) != 0) {
+        uint64_t after = port_level(port);
+        if (vcd_active) {
+            vcd_change(now_ns(), pin, (after & bit) != 0);
+        }
+        if (port_edges(port, after)) {
+            event_signal(); //despertar al loop principal
+        }
+    }
+}
+
+void gpio_trace_attach(struct trace_writer *w){
+    trace_out = w;
+}
+
+int gpio_irq_attach(int pin, gpio_edge_t edge, gpio_irq_handler_t handler, void *arg){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_IRQ_ATTACH, GPIO_ERR_BAD_PIN, pin);
+        return -1;
+    }
+    int port = GPIO_PORT_OF(pin);
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    if ((exti[port].rtsr | exti[port].ftsr) == 0) {
+        last_level[port] = port_level(port); // referencia para los flancos de este puerto
+    }
+    irq[pin].handler = handler;
+    irq[pin].arg = arg;
+    exti[port].rtsr = (edge & GPIO_EDGE_RISING)  ? (exti[port].rtsr | bit) : (exti[port].rtsr & ~bit);
+    exti[port].ftsr = (edge & GPIO_EDGE_FALLING) ? (exti[port].ftsr | bit) : (exti[port].ftsr & ~bit);
+    watcher_start();
+    return 0;
+}
+
+void gpio_irq_detach(int pin){
+    if(!pin_is_valid(pin)){
+        return;
+    }
+    int port = GPIO_PORT_OF(pin);
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    exti[port].rtsr &= ~bit;
+    exti[port].ftsr &= ~bit;
+    irq[pin].handler = NULL;
+    irq[pin].arg = NULL;
+}
+
+/*
+   gpio_poll()
+   -----------
+   Flancos que escribió otro proceso: para cada puerto con interrupciones,
+   nivel actual contra el último visto.
+*/
+void gpio_poll(void){
+    for (int port = 0; port < GPIO_PORT_COUNT; port++) {
+        if ((exti[port].rtsr | exti[port].ftsr) != 0) {
+            port_edges(port, port_level(port));
+        }
+    }
+}
+
+/*==========================================================
+=                 API PROPIA (gpio_shm.h)                  =
+==========================================================*/
+
+const char *gpio_shm_name(void){
+    return board_name;
+}
+
+int gpio_shm_created(void){
+    return board_created;
+}
+
+uint32_t gpio_shm_seq(void){
+    return board != NULL ? atomic_load(&board->seq) : 0;
+}
+
+uint32_t gpio_shm_in_seq(void){
+    return board != NULL ? atomic_load(&board->in_seq) : 0;
+}
+
+uint32_t gpio_shm_out_seq(void){
+    return board != NULL ? atomic_load(&board->out_seq) : 0;
+}
+
+uint64_t gpio_shm_stale_writers(void){
+    return atomic_load(&stale_writers);
+}
+
+int gpio_shm_wait(uint32_t seen, long long timeout_ms){
+    if (board == NULL || !board_shared) {
+        return 0;
+    }
+    struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    atomic_fetch_add(&board->waiters, 1);
+    if (atomic_load(&board->seq) == seen) {
+        futex(&board->seq, FUTEX_WAIT, seen, timeout_ms < 0 ? NULL : &ts);
+    }
+    atomic_fetch_sub(&board->waiters, 1);
+    return atomic_load(&board->seq) != seen;
+}
+
+void gpio_shm_reset(void){
+    if (board == NULL) {
+        return;
+    }
+    board_clear();
+    notify(1);
+    notify(0);
+}
+
+void gpio_shm_close(void){
+    if (board == NULL) {
+        return;
+    }
+    watcher_join();
+    if (board_shared) {
+        atomic_fetch_sub(&board->procs, 1);
+    }
+    munmap(board, sizeof(shm_board_t));
+    board = NULL;
+}
+
+int gpio_shm_unlink(const char *name){
+    return shm_unlink(name != NULL ? name : GPIO_SHM_DEFAULT);
+}
@@ -0,0 +1,160 @@
+/*
+  gpio_shm_tool.c — Mirar y manejar la placa compartida desde otro proceso
+
+  Se conecta a la misma placa que boton_switch_shm / boton_toggle_shm
+  (gpio_shm.h) y hace de "banco de pruebas": inyecta entradas crudas y lee
+  lo que el firmware escribe, sin terminal en raw, sin pipes ni sockets.
+
+  Uso:
+    ./bin/gpio_shm [-b /nombre] COMANDO
+      get PIN           nivel actual del pin
+      set PIN 0|1       inyecta un nivel crudo (como el teclado del firmware)
+      pulse PIN MS      1 durante MS milisegundos y luego 0
+      dump [PUERTOS]    niveles de los primeros PUERTOS puertos (por defecto 1)
+      watch [SEGUNDOS]  imprime cada cambio de nivel (0 = hasta Ctrl-C)
+      reset             todos los pines de la placa a estado seguro
+      unlink            borra la placa de /dev/shm
+
+  PIN puede ser un numero o un nombre de pins.h (led, button).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "gpio_shm.h"
+#include "gpio_err.h"
+#include "pins.h"
+#include "timeutil.h"
+
+#define PINS_NAME_(id, name, num, mode, pull) { #name, (num) },
+
+static const struct{
+    const char *name;
+    int         pin;
+} pin_names[] = {
+    PINS_TABLE(PINS_NAME_)
+};
+
+static int parse_pin(const char *s){
+    for (size_t i = 0; i < sizeof(pin_names) / sizeof(pin_names[0]); i++) {
+        if (strcmp(s, pin_names[i].name) == 0) {
+            return pin_names[i].pin;
+        }
+    }
+    char *end;
+    long v = strtol(s, &end, 0);
+    return (*end == '\0' && v >= 0 && v < GPIO_PIN_MAX) ? (int)v : -1;
+}
+
+static const char *pin_label(int pin){
+    for (size_t i = 0; i < sizeof(pin_names) / sizeof(pin_names[0]); i++) {
+        if (pin_names[i].pin == pin) {
+            return pin_names[i].name;
+        }
+    }
+    return "";
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-b /nombre] COMANDO\n"
+            "  get PIN | set PIN 0|1 | pulse PIN MS | dump [PUERTOS] | watch [SEGUNDOS] | reset | unlink\n"
+            "  -b  placa compartida (por defecto $GPIO_SHM_NAME o %s)\n"
+            "  PIN: numero o nombre de pins.h\n", argv0, GPIO_SHM_DEFAULT);
+}
+
+/* Imprime cada cambio de nivel hasta que pasen "secs" segundos (0 = sin fin) */
+static void watch(long long secs){
+    static uint64_t before[GPIO_PORT_COUNT], after[GPIO_PORT_COUNT];
+    long long t0 = now_ms();
+    long long end = secs > 0 ? t0 + secs * 1000 : 0;
+
+    gpio_read_all(before);
+    for (;;) {
+        uint32_t seen = gpio_shm_seq();
+        long long left = end ? end - now_ms() : 1000;
+        if (left <= 0) {
+            return;
+        }
+        gpio_shm_wait(seen, left);
+        gpio_read_all(after);
+        for (int port = 0; port < GPIO_PORT_COUNT; port++) {
+            uint64_t changed = before[port] ^ after[port];
+            while (changed != 0) {
+                int b = __builtin_ctzll(changed);
+                int pin = port * GPIO_PORT_WIDTH + b;
+                printf("%8lld ms  pin %4d %-8s -> %d\n", now_ms() - t0, pin, pin_label(pin),
+                       (int)((after[port] >> b) & 1u));
+                changed &= changed - 1;
+            }
+            before[port] = after[port];
+        }
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char **argv){
+    int i = 1;
+    if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+        setenv("GPIO_SHM_NAME", argv[i + 1], 1);
+        i += 2;
+    }
+    if (i >= argc) { usage(argv[0]); return 1; }
+    const char *cmd = argv[i];
+    const char *a1 = (i + 1 < argc) ? argv[i + 1] : NULL;
+    const char *a2 = (i + 2 < argc) ? argv[i + 2] : NULL;
+
+    if (strcmp(cmd, "unlink") == 0) {
+        const char *name = getenv("GPIO_SHM_NAME");
+        if (gpio_shm_unlink(name) != 0) {
+            perror("gpio_shm: unlink");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (gpio_init() != 0) {
+        return 1;
+    }
+    int rc = 0;
+
+    if (strcmp(cmd, "get") == 0 && a1 != NULL) {
+        int pin = parse_pin(a1);
+        if (pin < 0) { usage(argv[0]); return 1; }
+        printf("%d\n", gpio_read(pin));
+    } else if (strcmp(cmd, "set") == 0 && a1 != NULL && a2 != NULL) {
+        int pin = parse_pin(a1);
+        if (pin < 0) { usage(argv[0]); return 1; }
+        gpio_simulate_input(pin, atoi(a2) != 0);
+    } else if (strcmp(cmd, "pulse") == 0 && a1 != NULL && a2 != NULL) {
+        int pin = parse_pin(a1);
+        if (pin < 0) { usage(argv[0]); return 1; }
+        gpio_simulate_input(pin, 1);
+        sleep_ms(atoll(a2));
+        gpio_simulate_input(pin, 0);
+    } else if (strcmp(cmd, "dump") == 0) {
+        int nports = a1 != NULL ? atoi(a1) : 1;
+        if (nports < 1 || nports > GPIO_PORT_COUNT) nports = 1;
+        uint64_t lv[GPIO_PORT_COUNT];
+        gpio_read_bank(0, nports, lv);
+        printf("placa %s (%s)  seq=%u in=%u out=%u\n", gpio_shm_name(),
+               gpio_shm_created() ? "nueva" : "existente",
+               gpio_shm_seq(), gpio_shm_in_seq(), gpio_shm_out_seq());
+        for (int port = 0; port < nports; port++) {
+            printf("  puerto %2d: %016llx\n", port, (unsigned long long)lv[port]);
+        }
+    } else if (strcmp(cmd, "watch") == 0) {
+        watch(a1 != NULL ? atoll(a1) : 0);
+    } else if (strcmp(cmd, "reset") == 0) {
+        gpio_shm_reset();
+    } else {
+        usage(argv[0]);
+        rc = 1;
+    }
+
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+    return rc;
+}
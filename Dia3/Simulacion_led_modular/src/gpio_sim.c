@@ -18,45 +18,73 @@
 */
 
 
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "gpio.h"
 #include "pins.h"
+#include "gpio_pins.h"
+#include "gpio_err.h"
+#include "event.h"
+#include "trace.h"
+#include "vcd.h"
+#include "timeutil.h"
 
 /*==========================================================
 =           REPRESENTACIÓN INTERNA (SIMULADA)              =
 ==========================================================*/
 
 /*
-   Cada pin "físico" del micro lo modelamos como una "ranura" (slot)
-   con los datos mínimos que nos interesan para simular GPIO:
-
-   - mode: si el pin está configurado como entrada o salida (GPIO_INPUT/OUTPUT).
-   - pull: qué resistencia interna tiene cuando está en modo INPUT
-           (GPIO_NOPULL / GPIO_PULLUP / GPIO_PULLDOWN).
-   - value: último valor "efectivo"
-       * Si es OUTPUT: lo que escribimos con gpio_write (0/1).
-       * Si es INPUT : NO lo tocamos aquí; lo leemos combinando input_raw + pull.
-   - input_raw: la "fuente cruda" para entradas, que viene del "mundo externo".
-       * En simulación lo cambiamos desde teclado con gpio_sim_set_input().
+   Igual que en un micro real, los pines se agrupan en PUERTOS de 64 pines y
+   cada dato de configuración es una palabra donde el bit i es el pin i del
+   puerto (como MODER/PUPDR/ODR/IDR en STM32):
+
+   - moder: 1 = salida, 0 = entrada (GPIO_OUTPUT/GPIO_INPUT).
+   - pu/pd: resistencia interna cuando está en modo INPUT. PUPDR en STM32 usa
+            2 bits por pin; aquí lo guardamos como dos "planos" (pull-up y
+            pull-down) para poder combinarlos con operaciones de bits.
+   - odr:   último valor escrito con gpio_write (solo cuenta en salidas).
+   - idr:   la "fuente cruda" para entradas, que viene del "mundo externo".
+       * En simulación lo cambiamos desde teclado con gpio_simulate_input().
        * En hardware real, ese "crudo" viene del pin físico (IDR, PINx, etc.).
+
+   Total: 5 bits por pin (antes un struct de 16 bytes por pin).
 */
 
-typedef struct{
-    gpio_mode_t mode; //GPIO_INPUT o GPIO_OUTPUT
-    gpio_pull_t pull; //GPIO_NOPULL, GPIO_PULLUP, GPIO_PULLDOWN
-    int value; //Ultimo valor efectivo escrito (output) o leido (input)
-    int input_raw; //valor "crudo" de la entrada (antes de debounce)
-} gpio_slot_t;
+/*
+   La estructura gpio_port_t vive en gpio_pins.h: los accesores por pin
+   generados desde pins.h (pin_led_write, pin_button_read...) leen y escriben
+   estos mismos registros sin pasar por las validaciones de abajo.
+
+   Arreglo de puertos. Los IDs lógicos (PIN_LED, PIN_BUTTON) vienen de pins.h
+   y caen en el puerto 0; el resto de pines queda disponible para bancos grandes.
+*/
+
+_Static_assert(PIN_COUNT <= GPIO_PIN_MAX, "pins.h define mas pines de los que simula gpio_sim.c");
+
+gpio_port_t gpio_ports[GPIO_PORT_COUNT];
 
 /*
-   Arreglo con un slot por pin. La cantidad de pines viene de pins.h (PIN_COUNT).
-   IMPORTANTE: en una placa real, PIN_COUNT y los IDs (PIN_LED, PIN_BUTTON) los
-   defines tú según tu hardware.
+   Interrupciones por flanco (como el EXTI de STM32):
+   - rtsr/ftsr: un bit por pin, 1 = interrumpir en subida / bajada
+     (mismos nombres que los registros del EXTI)
+   - irq[]: handler + argumento por pin (la "tabla de vectores")
 */
 
-static gpio_slot_t  g[PIN_COUNT]; //array de pines g[PIN_COUNT] hace referencia a los pines logicos definidos en pins.h
+typedef struct{
+    uint64_t rtsr; //flanco de subida habilitado
+    uint64_t ftsr; //flanco de bajada habilitado
+} gpio_exti_t;
+
+typedef struct{
+    gpio_irq_handler_t handler;
+    void *arg;
+} gpio_irq_slot_t;
+
+static gpio_exti_t     exti[GPIO_PORT_COUNT];
+static gpio_irq_slot_t irq[GPIO_PIN_MAX];
+
+/* Grabación de entradas crudas (NULL = no se graba) */
+static trace_writer_t *trace_out = NULL;
 
 /*==========================================================
 =                 FUNCIONES AUXILIARES (privadas)          =
@@ -66,7 +94,28 @@ static gpio_slot_t  g[PIN_COUNT]; //array de pines g[PIN_COUNT] hace referencia
    En C el acceso fuera de rango es UB (undefined behavior), así que chequeamos. */
 
 static int pin_is_valid(int pin){
-    return (pin >= 0 && pin < PIN_COUNT);
+    return (pin >= 0 && pin < GPIO_PIN_MAX);
+}
+
+static int port_is_valid(int port){
+    return (port >= 0 && port < GPIO_PORT_COUNT);
+}
+
+/* Nivel efectivo de un puerto, sin ramas:
+   - salidas  -> odr
+   - entradas -> crudo OR pull-up (pull-down y sin pull leen el crudo tal cual) */
+static inline uint64_t port_level(const gpio_port_t *p){
+    return (p->odr & p->moder) | ((p->idr | p->pu) & ~p->moder);
+}
+
+/* Volcado VCD de los bits "changed" de un puerto (escrituras de puerto completo) */
+static void vcd_port_changes(int port, uint64_t changed, uint64_t level){
+    long long t = now_ns();
+    while (changed != 0) {
+        int b = __builtin_ctzll(changed);
+        vcd_change(t, port * GPIO_PORT_WIDTH + b, (int)((level >> b) & 1u));
+        changed &= changed - 1;
+    }
 }
 
 /*==========================================================
@@ -87,15 +136,15 @@ static int pin_is_valid(int pin){
      pondrías estados iniciales seguros, etc.
 */
 
-void gpio_init(void){
-    //limpiamos toda la estructura a 0
-    memset(g, 0, sizeof(g));
-    for (int i =0; i < PIN_COUNT; i++){
-        g[i].mode = GPIO_INPUT; //por defecto, todos los pines son entradas
-        g[i].pull = GPIO_NOPULL; //sin pull-up ni pull-down
-        g[i].value = 0; //valor inicial 0
-        g[i].input_raw = 0; //entrada cruda inicializada a 0
-    }
+int gpio_init(void){
+    //todo a 0: moder=0 (INPUT), sin pull, odr=0, idr=0
+    memset(gpio_ports, 0, sizeof(gpio_ports));
+    //sin interrupciones registradas
+    memset(exti, 0, sizeof(exti));
+    memset(irq, 0, sizeof(irq));
+    //contadores de error a cero
+    gpio_err_reset();
+    return 0; //un arreglo en memoria: no puede fallar
 }
 
 /*
@@ -109,13 +158,19 @@ void gpio_init(void){
 void gpio_mode(int pin, gpio_mode_t mode){
     /*
          Validamos el pin antes de configurarlo.
-         Si no es válido, mostramos un error y salimos sin hacer nada.
+         Si no es válido, contamos el error (gpio_err.h) y salimos sin hacer nada.
     */
     if(!pin_is_valid(pin)){
-        fprintf(stderr, "gpio_mode: Pin %d no es válido.\n", pin);
+        gpio_err_report(GPIO_OP_MODE, GPIO_ERR_BAD_PIN, pin);
         return;
     }
-    g[pin].mode = mode; //configuramos el modo del pin
+    gpio_port_t *p = &gpio_ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    if (mode == GPIO_OUTPUT) {
+        p->moder |= bit;  //configuramos el pin como salida
+    } else {
+        p->moder &= ~bit; //configuramos el pin como entrada
+    }
 }
 
 /*
@@ -132,14 +187,18 @@ void gpio_mode(int pin, gpio_mode_t mode){
 void gpio_set_pull(int pin, gpio_pull_t pull){
     //Validamos el pin antes de onfigurarlo.
     if(!pin_is_valid(pin)){
-        fprintf(stderr, "gpio_set_pull: Pin %d no es válido.\n", pin);
+        gpio_err_report(GPIO_OP_SET_PULL, GPIO_ERR_BAD_PIN, pin);
         return;
     }
-    if (g[pin].mode != GPIO_INPUT) {
-        fprintf(stderr, "gpio_set_pull: Pin %d no está configurado como entrada.\n", pin);
+    gpio_port_t *p = &gpio_ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    if (p->moder & bit) {
+        gpio_err_report(GPIO_OP_SET_PULL, GPIO_ERR_NOT_INPUT, pin);
         return;
     }
-    g[pin].pull = pull; //configuramos la resistencia interna del pin
+    //configuramos la resistencia interna del pin (un bit en cada plano)
+    p->pu = (pull == GPIO_PULLUP)   ? (p->pu | bit) : (p->pu & ~bit);
+    p->pd = (pull == GPIO_PULLDOWN) ? (p->pd | bit) : (p->pd & ~bit);
 }
 
 /*
@@ -149,7 +208,7 @@ void gpio_set_pull(int pin, gpio_pull_t pull){
 
    - Si el pin NO es OUTPUT, ignoramos (en HW podrías forzar/avisar error).
    - Normalizamos "value" a 0/1 (todo diferente de 0 cuenta como 1).
-   - Guardamos en g[pin].value como "cache" del estado de salida.
+   - Guardamos el bit en el odr del puerto como "cache" del estado de salida.
 
    En HW REAL:
    - Escribirías el bit correspondiente en el registro ODR/PORTx.
@@ -157,14 +216,26 @@ void gpio_set_pull(int pin, gpio_pull_t pull){
 void gpio_write(int pin, int value){
     //Validamos el pin antes de escribir en él.
     if(!pin_is_valid(pin)){
-        fprintf(stderr, "gpio_write: Pin %d no es válido.\n", pin);
+        gpio_err_report(GPIO_OP_WRITE, GPIO_ERR_BAD_PIN, pin);
         return;
     }
-    if (g[pin].mode != GPIO_OUTPUT) {
-        fprintf(stderr, "gpio_write: Pin %d no está configurado como salida.\n", pin);
+    gpio_port_t *p = &gpio_ports[GPIO_PORT_OF(pin)];
+    uint64_t bit = GPIO_BIT_OF(pin);
+    if (!(p->moder & bit)) {
+        gpio_err_report(GPIO_OP_WRITE, GPIO_ERR_NOT_OUTPUT, pin);
         return;
     }
-    g[pin].value = (value != 0) ? 1 : 0; //normalizamos value a 0 o 1
+    //todo valor distinto de 0 cuenta como 1
+    uint64_t old = p->odr;
+    if (value) {
+        p->odr |= bit;
+    } else {
+        p->odr &= ~bit;
+    }
+    //volcado VCD: solo si de verdad cambió
+    if (vcd_active && ((old ^ p->odr) & bit)) {
+        vcd_change(now_ns(), pin, value != 0);
+    }
 }
 
 /*
@@ -174,11 +245,11 @@ void gpio_write(int pin, int value){
    - Si el pin es OUTPUT: retornamos el "cache" (lo que escribimos).
      (En HW podrías leer ODR o IDR, dependiendo de la familia.)
    - Si el pin es INPUT :
-       -> combinamos la "fuente cruda" (input_raw) con el pull interno.
+       -> combinamos la "fuente cruda" (bit del idr) con el pull interno.
 
    LÓGICA DE SIMULACIÓN PARA INPUT:
-   - Si input_raw == 1   -> retorna 1 (hay señal externa)
-   - Si input_raw == 0   -> depende del pull:
+   - Si crudo == 1      -> retorna 1 (hay señal externa)
+   - Si crudo == 0      -> depende del pull:
         * PULLUP     -> 1  (tira hacia 1 por defecto)
         * PULLDOWN   -> 0  (tira hacia 0 por defecto)
         * NOPULL     -> 0  (para evitar "ruido"; podríamos randomizar, pero no ayuda a aprender)
@@ -187,30 +258,100 @@ void gpio_write(int pin, int value){
 int gpio_read(int pin){
     //Validamos que el pin sea válido
     if(!pin_is_valid(pin)){
-        fprintf(stderr, "gpio_read: Pin %d no es válido.\n", pin);
+        gpio_err_report(GPIO_OP_READ, GPIO_ERR_BAD_PIN, pin);
         return 0; //retornamos 0 por defecto
     }
 
-    if(g[pin].mode == GPIO_OUTPUT){
-        //Si es salida, retornamos el valor cacheado
-        return g[pin].value;
-    } 
-    else if (g[pin].mode == GPIO_INPUT) {
-        //Si es entrada, combinamos input_raw con pull
-        if (g[pin].input_raw) {
-            return 1; //input_raw es 1, retornamos 1
-        } else {
-            //input_raw es 0, depende del pull
-            switch (g[pin].pull) {
-                case GPIO_PULLUP:   return 1; //pull-up: tira a 1
-                case GPIO_PULLDOWN: return 0; //pull-down: tira a 0
-                case GPIO_NOPULL:   return 0; //sin pull: retornamos 0 por defecto
-            }
-        }
+    //el nivel efectivo de todo el puerto sale de port_level(); nos quedamos con nuestro bit
+    int sh = pin % GPIO_PORT_WIDTH;
+    return (int)((port_level(&gpio_ports[GPIO_PORT_OF(pin)]) >> sh) & 1u);
+}
+
+/*
+   gpio_port_read(port)
+   --------------------
+   Devuelve los 64 niveles del puerto en una palabra (bit i = pin i del puerto),
+   con la misma lógica que gpio_read() pero para todo el banco a la vez.
+
+   En HW REAL:
+   - Un solo acceso al registro IDR del puerto.
+*/
+uint64_t gpio_port_read(int port){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_PORT_READ, GPIO_ERR_BAD_PORT, port);
+        return 0;
     }
+    return port_level(&gpio_ports[port]);
+}
 
-    fprintf(stderr, "gpio_read: Pin %d no está configurado como entrada o salida.\n", pin);
-    return 0; //retornamos 0 por defecto si no es ni entrada ni salida
+/*
+   gpio_read_bank(port, nports, out)
+   ---------------------------------
+   Igual que gpio_port_read() para nports puertos seguidos: se valida el rango
+   una vez y cada palabra sale de port_level() (odr en salidas, crudo | pull-up
+   en entradas), sin ramas por pin ni por puerto.
+
+   En HW REAL:
+   - Una lectura de IDR por puerto.
+*/
+int gpio_read_bank(int port, int nports, uint64_t *out){
+    if(!port_is_valid(port) || nports <= 0 || nports > GPIO_PORT_COUNT - port){
+        gpio_err_report(GPIO_OP_READ_BANK, GPIO_ERR_BAD_PORT, port);
+        return 0;
+    }
+    const gpio_port_t *p = &gpio_ports[port];
+    for (int k = 0; k < nports; k++) {
+        out[k] = port_level(&p[k]);
+    }
+    return nports;
+}
+
+void gpio_read_all(uint64_t *out){
+    for (int k = 0; k < GPIO_PORT_COUNT; k++) {
+        out[k] = port_level(&gpio_ports[k]);
+    }
+}
+
+/*
+   gpio_port_write(port, value)
+   ----------------------------
+   Escribe el ODR completo del puerto. Los bits de pines configurados como
+   entrada se ignoran (igual que gpio_write sobre una entrada).
+
+   En HW REAL:
+   - Escritura directa en ODR.
+*/
+void gpio_port_write(int port, uint64_t value){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_PORT_WRITE, GPIO_ERR_BAD_PORT, port);
+        return;
+    }
+    gpio_port_t *p = &gpio_ports[port];
+    uint64_t old = p->odr;
+    p->odr = (p->odr & ~p->moder) | (value & p->moder);
+    if (vcd_active) {
+        vcd_port_changes(port, old ^ p->odr, p->odr);
+    }
+}
+
+/*
+   gpio_write_mask(port, mask, value)
+   ----------------------------------
+   Modifica SOLO los pines de "mask" (el resto queda igual), como el registro
+   BSRR de STM32: cambiar 3 LEDs de un puerto es una sola operación.
+*/
+void gpio_write_mask(int port, uint64_t mask, uint64_t value){
+    if(!port_is_valid(port)){
+        gpio_err_report(GPIO_OP_WRITE_MASK, GPIO_ERR_BAD_PORT, port);
+        return;
+    }
+    gpio_port_t *p = &gpio_ports[port];
+    uint64_t m = mask & p->moder; //solo salidas
+    uint64_t old = p->odr;
+    p->odr = (p->odr & ~m) | (value & m);
+    if (vcd_active) {
+        vcd_port_changes(port, old ^ p->odr, p->odr);
+    }
 }
 
 
@@ -233,22 +374,118 @@ int gpio_read(int pin){
 */
 void gpio_simulate_input(int pin, int value) {
     if (!pin_is_valid(pin)) {
-        // printf("[GPIO] gpio_sim_set_input: pin inválido %d\n", pin);
+        gpio_err_report(GPIO_OP_SIMULATE_INPUT, GPIO_ERR_BAD_PIN, pin);
+        return;
+    }
+    int port = GPIO_PORT_OF(pin);
+    gpio_port_t *p = &gpio_ports[port];
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    uint64_t before = port_level(p);
+    uint64_t raw_before = p->idr;
+    if (value) {
+        p->idr |= bit;
+    } else {
+        p->idr &= ~bit;
+    }
+    uint64_t after = port_level(p);
+
+    //grabar solo los cambios reales del crudo
+    if (trace_out != NULL && ((raw_before ^ p->idr) & bit)) {
+        trace_writer_add(trace_out, now_ns(), pin, value != 0);
+    }
+    //volcado VCD del nivel (lo que ve el firmware, con el pull aplicado)
+    if (vcd_active && ((before ^ after) & bit)) {
+        vcd_change(now_ns(), pin, (after & bit) != 0);
+    }
+
+    //¿hubo flanco en un pin con interrupción habilitada?
+    uint64_t rise = ~before & after & exti[port].rtsr;
+    uint64_t fall = before & ~after & exti[port].ftsr;
+    if ((rise | fall) & bit) {
+        if (irq[pin].handler != NULL) {
+            irq[pin].handler(pin, (after & bit) ? 1 : 0, irq[pin].arg);
+        }
+        event_signal(); //despertar al loop principal
+    }
+}
+
+/*
+   gpio_trace_attach(w)
+   --------------------
+   *** SOLO PARA SIMULACIÓN EN PC ***
+
+   A partir de ahora cada cambio crudo que entra por gpio_simulate_input()
+   se graba en la traza w (instante, pin, valor). Con una traza grabada se
+   puede repetir exactamente el mismo escenario sin teclado (ver replay.c).
+*/
+void gpio_trace_attach(struct trace_writer *w){
+    trace_out = w;
+}
+
+/*
+   gpio_irq_attach(pin, edge, handler, arg)
+   ----------------------------------------
+   *** Interrupción simulada (EXTI) ***
+
+   Habilita la interrupción del pin en los flancos pedidos y guarda el handler.
+   Se dispara desde gpio_simulate_input() cuando el nivel efectivo (crudo + pull)
+   cambia en ese sentido.
+
+   En HW REAL:
+   - Configurar RTSR/FTSR/IMR del EXTI, habilitar la IRQ en el NVIC y poner
+     el handler en la tabla de vectores.
+*/
+int gpio_irq_attach(int pin, gpio_edge_t edge, gpio_irq_handler_t handler, void *arg){
+    if(!pin_is_valid(pin)){
+        gpio_err_report(GPIO_OP_IRQ_ATTACH, GPIO_ERR_BAD_PIN, pin);
+        return -1;
+    }
+    int port = GPIO_PORT_OF(pin);
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    irq[pin].handler = handler;
+    irq[pin].arg = arg;
+    exti[port].rtsr = (edge & GPIO_EDGE_RISING)  ? (exti[port].rtsr | bit) : (exti[port].rtsr & ~bit);
+    exti[port].ftsr = (edge & GPIO_EDGE_FALLING) ? (exti[port].ftsr | bit) : (exti[port].ftsr & ~bit);
+    return 0;
+}
+
+void gpio_irq_detach(int pin){
+    if(!pin_is_valid(pin)){
         return;
     }
-    g[pin].input_raw = (value != 0) ? 1 : 0;
+    int port = GPIO_PORT_OF(pin);
+    uint64_t bit = GPIO_BIT_OF(pin);
+
+    exti[port].rtsr &= ~bit;
+    exti[port].ftsr &= ~bit;
+    irq[pin].handler = NULL;
+    irq[pin].arg = NULL;
+}
+
+/*
+   gpio_poll()
+   -----------
+   Aquí todas las entradas pasan por gpio_simulate_input() de este mismo
+   proceso, que ya llamó al handler: no hay nada que atender.
+*/
+void gpio_poll(void){
 }
 
 /*==========================================================
 =                  NOTAS Y CONSEJOS PRÁCTICOS              =
 ==========================================================
 
-1) ¿Por qué devolver 0 en NOPULL sin input_raw?
+1) ¿Por qué devolver 0 en NOPULL sin crudo?
    - En la realidad, un pin sin pull puede "flotar" y leer valores aleatorios.
    - Para aprender es mejor un comportamiento determinista (0) que no confunda.
 
 2) ¿Por qué no imprimir errores todo el tiempo?
-   - Puedes descomentar los printf de error si te ayuda a depurar.
+   - Un pin mal configurado dentro de un loop rápido serían miles de fprintf
+     bloqueantes por segundo. Los errores van a gpio_err_report(): contador
+     atómico + unos pocos mensajes por segundo a una cola en memoria, que el
+     loop escribe con gpio_err_flush() cuando le conviene.
    - En firmware real quizá usarías asserts, logs por UART, o códigos de retorno.
 
 3) Portar a HW real (cuando tengas MCU):
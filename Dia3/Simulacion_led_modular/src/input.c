@@ -0,0 +1,194 @@
+/*
+  input.c — Hilo lector de entrada con cola SPSC
+
+  Hilo lector:
+    poll(fd, stop) -> tty_read_burst() de todo lo disponible -> un evento por byte
+    con la misma marca de tiempo -> publicar -> event_signal()
+
+  Si la cola se llena (entrada pegada o desde archivo) el hilo espera a que el
+  loop haga lugar en vez de tirar teclas: lo que no entra queda en el buffer
+  del kernel y el productor frena solo. La espera es un futex ("room") que
+  input_poll_burst() incrementa y despierta solo si el lector está dormido:
+  el consumidor no hace syscalls mientras no haya una espera.
+
+  Para pararlo se escribe en un eventfd que también vigila el poll(), así
+  el hilo no necesita timeouts ni despertarse a preguntar.
+*/
+
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "input.h"
+#include "spsc.h"
+#include "event.h"
+#include "timeutil.h"
+#include "tty.h"
+
+#define INPUT_RING_SIZE 8192 // teclas en vuelo (potencia de 2)
+
+static input_ev_t ring[INPUT_RING_SIZE];
+static spsc_t     q;
+static pthread_t  reader;
+static int        running = 0;
+static int        in_fd   = -1;
+static int        stop_fd = -1;
+static atomic_int at_eof;
+static atomic_ullong stalls;
+static atomic_uint   room;           // futex: el loop sacó teclas de una cola llena
+static atomic_int    reader_waiting; // 1 = el lector duerme (o va a dormir) en room
+static atomic_int    stopping;       // input_stop(): también despierta la espera en room
+
+/*==========================================================
+=                     HILO LECTOR                          =
+==========================================================*/
+
+/*
+   Cola llena: dormir hasta que input_poll_burst() saque algo. La marca
+   reader_waiting va antes de volver a mirar la cola, así una consumición
+   entre el primer intento y el futex no se pierde (el valor de room cambia
+   y el FUTEX_WAIT vuelve enseguida). 1 si hay que terminar
+*/
+static int wait_room(void){
+    unsigned seen = atomic_load(&room);
+    atomic_store(&reader_waiting, 1);
+    if (spsc_reserve(&q) < 0 && !atomic_load(&stopping)) {
+        syscall(SYS_futex, &room, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+    }
+    atomic_store(&reader_waiting, 0);
+    return atomic_load(&stopping);
+}
+
+static void *reader_main(void *arg){
+    (void)arg;
+    struct pollfd pfd[2] = {
+        { .fd = in_fd,   .events = POLLIN },
+        { .fd = stop_fd, .events = POLLIN },
+    };
+    static unsigned char buf[TTY_BURST_MAX];
+
+    for (;;) {
+        if (poll(pfd, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (pfd[1].revents & POLLIN) {
+            break; // input_stop()
+        }
+        if (!(pfd[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+        }
+
+        // una sola lectura trae todo lo pendiente (pegados, scripts)
+        int n = tty_read_burst(in_fd, buf, TTY_BURST_MAX);
+        if (n == 0) {
+            continue; // nada (falsa alarma de poll): otro poll
+        }
+        if (n < 0) {
+            atomic_store(&at_eof, 1); // fin de archivo / pipe cerrado
+            event_signal();
+            break;
+        }
+
+        // todos los bytes de una lectura comparten el instante
+        long long t = now_ns();
+        for (int k = 0; k < n; ) {
+            long i = spsc_reserve(&q);
+            if (i < 0) {
+                // cola llena (entrada por script/archivo): no se descarta nada,
+                // se despierta al loop y se espera a que haga lugar
+                atomic_fetch_add(&stalls, 1);
+                event_signal();
+                if (wait_room()) {
+                    return NULL; // input_stop() mientras esperábamos
+                }
+                continue;
+            }
+            ring[i].t_ns = t;
+            ring[i].key  = buf[k++];
+            spsc_publish(&q);
+        }
+        event_signal(); // despertar al loop
+    }
+    return NULL;
+}
+
+/*==========================================================
+=                        API PÚBLICA                        =
+==========================================================*/
+
+int input_start(int fd){
+    if (running) {
+        return -1;
+    }
+    stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd == -1) {
+        return -1;
+    }
+    in_fd = fd;
+    spsc_init(&q, INPUT_RING_SIZE);
+    atomic_store(&at_eof, 0);
+    atomic_store(&stalls, 0);
+    atomic_store(&reader_waiting, 0);
+    atomic_store(&stopping, 0);
+    if (pthread_create(&reader, NULL, reader_main, NULL) != 0) {
+        close(stop_fd);
+        stop_fd = -1;
+        return -1;
+    }
+    running = 1;
+    return 0;
+}
+
+void input_stop(void){
+    if (!running) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t r = write(stop_fd, &one, sizeof(one));
+    (void)r;
+    atomic_store(&stopping, 1);
+    atomic_fetch_add(&room, 1);
+    syscall(SYS_futex, &room, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    pthread_join(reader, NULL);
+    close(stop_fd);
+    stop_fd = -1;
+    running = 0;
+}
+
+int input_poll_burst(input_ev_t *evs, int max){
+    size_t first;
+    size_t n = spsc_peek(&q, &first);
+    if (n > (size_t)max) {
+        n = (size_t)max;
+    }
+    for (size_t k = 0; k < n; k++) {
+        evs[k] = ring[(first + k) & q.mask];
+    }
+    spsc_consume(&q, n); // un solo store para todo el lote
+    if (n > 0) {
+        // el lugar recién hecho tiene que verse antes de mirar reader_waiting
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&reader_waiting, memory_order_relaxed)) {
+            atomic_fetch_add(&room, 1);
+            syscall(SYS_futex, &room, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+    }
+    return (int)n;
+}
+
+int input_eof(void){
+    // EOF y cola vacía: ya no queda nada por leer
+    size_t first;
+    return atomic_load(&at_eof) && spsc_peek(&q, &first) == 0;
+}
+
+uint64_t input_stalls(void){
+    return atomic_load(&stalls);
+}
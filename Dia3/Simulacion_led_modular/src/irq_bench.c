@@ -0,0 +1,251 @@
+/*
+  irq_bench.c — Latencia flanco -> handler: interrupción (nvic.h) vs polling
+
+  Un hilo "mundo" mueve el botón (gpio_simulate_input) a intervalos al azar
+  y anota el instante de cada flanco. Sobre los MISMOS flancos se mide:
+    - NVIC: el flanco pasa por EXTI -> nvic_gpio_route -> IRQ de prioridad
+      alta; el handler anota cuánto tardó en entrar
+    - polling: el hilo principal lee el pin cada POLL_MS (40 ms, el de
+      main_switch.c), como un loop sin interrupciones
+  Para que haya preempción, además hay una IRQ de prioridad baja a 1 kHz
+  cuyo handler ocupa 200 us: los flancos que caen encima la interrumpen
+  (columna "anidadas").
+
+  Niveles de carga: cantidad de hilos que gastan CPU sin parar (compiten con
+  el núcleo de interrupciones y con el loop de polling).
+
+  Uso:
+    ./bin/irq [-n flancos] [-p poll_ms] [-l carga,...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "gpio.h"
+#include "pins.h"
+#include "nvic.h"
+#include "latency.h"
+#include "timeutil.h"
+
+#define IRQ_EDGE     0   // flanco del botón: la más urgente
+#define IRQ_BG       5   // carga de fondo
+#define PRIO_EDGE    1
+#define PRIO_BG      8
+#define BG_PERIOD_NS 1000000LL
+#define BG_BUSY_NS   200000LL
+#define HOGS_MAX     16
+
+typedef struct{
+    int       edges;
+    long long poll_ms;
+    int       loads[8];
+    int       nloads;
+} irq_opts_t;
+
+static _Atomic long long t_edge;       // instante del último flanco (lo escribe el mundo)
+static atomic_int        stop_world, stop_hogs, stop_bg;
+static lat_hist_t        h_irq;         // solo lo escribe el handler
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void){
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/*==========================================================
+=                         HANDLERS                         =
+==========================================================*/
+
+static void on_edge_irq(int irq, void *arg){
+    (void)irq;
+    (void)arg;
+    lat_hist_record(&h_irq, (uint64_t)(TIME_SOURCE_REAL.now_ns() - atomic_load(&t_edge)));
+}
+
+static void on_bg_irq(int irq, void *arg){
+    (void)irq;
+    (void)arg;
+    long long until = TIME_SOURCE_REAL.now_ns() + BG_BUSY_NS;
+    while (TIME_SOURCE_REAL.now_ns() < until) {
+        // trabajo "largo" de prioridad baja
+    }
+}
+
+/*==========================================================
+=                           HILOS                          =
+==========================================================*/
+
+typedef struct{
+    int       edges;
+    long long min_gap_ns, max_gap_ns;
+    atomic_int done;
+} world_t;
+
+// Mundo exterior: flancos al azar, separados más que el periodo de polling
+static void *world_main(void *arg){
+    world_t *w = arg;
+    int level = 0;
+    for (int k = 0; k < w->edges && !atomic_load(&stop_world); k++) {
+        long long gap = w->min_gap_ns + (long long)(rng_next() % (uint64_t)(w->max_gap_ns - w->min_gap_ns));
+        TIME_SOURCE_REAL.sleep_ns(gap);
+        level ^= 1;
+        atomic_store(&t_edge, TIME_SOURCE_REAL.now_ns());
+        gpio_simulate_input(PIN_BUTTON, level);
+    }
+    atomic_store(&w->done, 1);
+    return NULL;
+}
+
+static void *hog_main(void *arg){
+    (void)arg;
+    volatile uint64_t x = 0;
+    while (!atomic_load_explicit(&stop_hogs, memory_order_relaxed)) {
+        x++;
+    }
+    return NULL;
+}
+
+static void *bg_main(void *arg){
+    (void)arg;
+    long long next = TIME_SOURCE_REAL.now_ns();
+    while (!atomic_load(&stop_bg)) {
+        next += BG_PERIOD_NS;
+        TIME_SOURCE_REAL.sleep_until_ns(next);
+        nvic_set_pending(IRQ_BG);
+    }
+    return NULL;
+}
+
+/*==========================================================
+=                        UNA CORRIDA                       =
+==========================================================*/
+
+static void print_row(int load, const char *mode, const lat_hist_t *h, uint64_t nested, uint64_t missed){
+    printf("%6d  %-14s %8llu %10.1f %10.1f %10.1f %10.1f %9llu %8llu\n", load, mode,
+           (unsigned long long)h->count,
+           lat_hist_percentile(h, 50) / 1e3, lat_hist_percentile(h, 99) / 1e3,
+           (h->count ? h->max : 0) / 1e3, (h->count ? (double)h->sum / (double)h->count : 0) / 1e3,
+           (unsigned long long)nested, (unsigned long long)missed);
+}
+
+static int run_load(const irq_opts_t *o, int hogs){
+    pthread_t hog[HOGS_MAX], world, bg;
+    world_t   w = { .edges = o->edges, .min_gap_ns = (o->poll_ms + 5) * 1000000LL,
+                    .max_gap_ns = (o->poll_ms + 20) * 1000000LL };
+    lat_hist_t h_poll;
+    lat_hist_reset(&h_poll);
+    lat_hist_reset(&h_irq);
+    nvic_stats_reset();
+
+    gpio_simulate_input(PIN_BUTTON, 0);
+    atomic_store(&stop_hogs, 0);
+    atomic_store(&stop_world, 0);
+    atomic_store(&stop_bg, 0);
+    for (int k = 0; k < hogs; k++) {
+        pthread_create(&hog[k], NULL, hog_main, NULL);
+    }
+    pthread_create(&bg, NULL, bg_main, NULL);
+    pthread_create(&world, NULL, world_main, &w);
+
+    // loop de polling, como main_switch.c sin interrupciones
+    int last = 0;
+    uint64_t missed = 0;
+    long long next = TIME_SOURCE_REAL.now_ns();
+    while (!atomic_load(&w.done)) {
+        next += o->poll_ms * 1000000LL;
+        TIME_SOURCE_REAL.sleep_until_ns(next);
+        int lv = gpio_read(PIN_BUTTON); // una palabra alineada: el mundo la escribe entera
+        if (lv != last) {
+            lat_hist_record(&h_poll, (uint64_t)(TIME_SOURCE_REAL.now_ns() - atomic_load(&t_edge)));
+            last = lv;
+        }
+    }
+    pthread_join(world, NULL);
+    atomic_store(&stop_bg, 1);
+    pthread_join(bg, NULL);
+    atomic_store(&stop_hogs, 1);
+    for (int k = 0; k < hogs; k++) {
+        pthread_join(hog[k], NULL);
+    }
+    if (gpio_read(PIN_BUTTON) != last) {
+        missed++; // el último flanco no llegó a verse por polling
+    }
+
+    const nvic_stats_t *st = nvic_stats(IRQ_EDGE);
+    print_row(hogs, "NVIC", &h_irq, st->nested, (uint64_t)o->edges - h_irq.count);
+    char name[32];
+    snprintf(name, sizeof(name), "polling %lld ms", o->poll_ms);
+    print_row(hogs, name, &h_poll, 0, missed);
+    return 0;
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-n flancos] [-p poll_ms] [-l carga,...]\n"
+            "  -n  flancos por nivel de carga (por defecto 60)\n"
+            "  -p  periodo del polling en ms (por defecto 40, POLL_MS de main_switch.c)\n"
+            "  -l  hilos que gastan CPU, por nivel (por defecto 0,1,4; hasta %d)\n", argv0, HOGS_MAX);
+}
+
+int main(int argc, char **argv){
+    irq_opts_t o = { .edges = 60, .poll_ms = 40, .loads = { 0, 1, 4 }, .nloads = 3 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-n") == 0) {
+            o.edges = atoi(v);
+        } else if (strcmp(a, "-p") == 0) {
+            o.poll_ms = atoll(v);
+        } else if (strcmp(a, "-l") == 0) {
+            o.nloads = 0;
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", v);
+            for (char *tok = strtok(buf, ","); tok != NULL && o.nloads < 8; tok = strtok(NULL, ",")) {
+                int n = atoi(tok);
+                if (n >= 0 && n <= HOGS_MAX) {
+                    o.loads[o.nloads++] = n;
+                }
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.edges < 1 || o.poll_ms < 1 || o.nloads == 0) { usage(argv[0]); return 1; }
+
+    if (gpio_init() != 0) {
+        return 1;
+    }
+    gpio_mode(PIN_BUTTON, GPIO_INPUT);
+    gpio_set_pull(PIN_BUTTON, GPIO_PULLDOWN);
+    if (nvic_init() != 0) {
+        perror("nvic_init");
+        return 1;
+    }
+    nvic_attach(IRQ_EDGE, on_edge_irq, NULL);
+    nvic_set_priority(IRQ_EDGE, PRIO_EDGE);
+    nvic_attach(IRQ_BG, on_bg_irq, NULL);
+    nvic_set_priority(IRQ_BG, PRIO_BG);
+    nvic_gpio_route(PIN_BUTTON, GPIO_EDGE_BOTH, IRQ_EDGE);
+    nvic_enable(IRQ_EDGE);
+    nvic_enable(IRQ_BG);
+
+    printf("%6s  %-14s %8s %10s %10s %10s %10s %9s %8s\n",
+           "carga", "modo", "flancos", "p50 us", "p99 us", "max us", "prom us", "anidadas", "perdidos");
+    for (int k = 0; k < o.nloads; k++) {
+        run_load(&o, o.loads[k]);
+    }
+    printf("\nLíneas del último nivel de carga (fondo: prioridad %d, %lld us cada %lld us):\n", PRIO_BG, BG_BUSY_NS / 1000, BG_PERIOD_NS / 1000);
+    nvic_dump(stdout);
+    nvic_shutdown();
+    return 0;
+}
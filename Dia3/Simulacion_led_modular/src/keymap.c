@@ -0,0 +1,150 @@
+/*
+  keymap.c — Decodificación de teclas por tabla
+
+  Un lote de teclas (input_poll_burst) se recorre una sola vez: por cada
+  byte, la entrada de la tabla dice qué hacer. Los pines se cambian con
+  gpio_simulate_input(), igual que antes hacían los mains a mano.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "keymap.h"
+#include "gpio.h"
+#include "latency.h"
+
+/*==========================================================
+=                   ACCIONES (uso interno)                 =
+==========================================================*/
+
+// Nivel actual del pin (lo mismo que miraban los mains antes de cambiarlo)
+static int raw_level(int pin){
+    return gpio_read(pin);
+}
+
+// Cambia el crudo; si cambia, la latencia del pin se mide desde la tecla
+static void set_pin(int pin, int value, long long key_ns){
+    if (raw_level(pin) != value) {
+        latency_mark(pin, key_ns);
+    }
+    gpio_simulate_input(pin, value);
+}
+
+// Fin de un pulso virtual
+static void on_release(swtimer_t *t, void *arg){
+    (void)t;
+    keymap_entry_t *e = arg;
+    gpio_simulate_input(e->pin, 0);
+}
+
+/*==========================================================
+=                        API PÚBLICA                        =
+==========================================================*/
+
+void keymap_init(keymap_t *m){
+    memset(m, 0, sizeof(*m));
+    for (int k = 0; k < 256; k++) {
+        timer_setup(&m->key[k].release, on_release, &m->key[k]);
+    }
+}
+
+int keymap_bind(keymap_t *m, unsigned char key, key_action_t action, int pin, long long pulse_ms){
+    if (pin < 0 || pin >= GPIO_PIN_MAX || action == KEY_CMD) {
+        return -1;
+    }
+    keymap_entry_t *e = &m->key[key];
+    timer_stop(&e->release);
+    e->action   = action;
+    e->pin      = pin;
+    e->cmd      = 0;
+    e->pulse_ms = (pulse_ms > 0) ? pulse_ms : 1;
+    return 0;
+}
+
+void keymap_bind_cmd(keymap_t *m, unsigned char key, int cmd){
+    keymap_entry_t *e = &m->key[key];
+    timer_stop(&e->release);
+    e->action = KEY_CMD;
+    e->cmd    = cmd;
+}
+
+int keymap_parse(keymap_t *m, const char *spec){
+    static const struct { const char *name; key_action_t action; } names[] = {
+        { "press", KEY_PRESS }, { "release", KEY_RELEASE },
+        { "toggle", KEY_TOGGLE }, { "pulse", KEY_PULSE },
+    };
+    // se recorre spec en el lugar (sin copia): no hay largo máximo que truncar
+    for (const char *tok = spec; *tok != '\0'; ) {
+        if (*tok == ',') {
+            tok++; // ",," o coma final: nada que asignar
+            continue;
+        }
+        // tok = "K=accion:pin[:ms]" hasta la próxima coma
+        if (tok[1] != '=') {
+            return -1;
+        }
+        unsigned char key = (unsigned char)tok[0];
+        const char *act = tok + 2;
+        const char *colon = strchr(act, ':');
+        const char *comma = strchr(act, ',');
+        if (colon == NULL || (comma != NULL && colon > comma)) {
+            return -1;
+        }
+        char *end;
+        long pin = strtol(colon + 1, &end, 10);
+        long long ms = 0;
+        if (*end == ':') {
+            ms = strtoll(end + 1, &end, 10);
+        }
+        if (*end != '\0' && *end != ',') {
+            return -1;
+        }
+
+        key_action_t action = KEY_NONE;
+        size_t len = (size_t)(colon - act);
+        for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            if (strlen(names[i].name) == len && strncmp(act, names[i].name, len) == 0) {
+                action = names[i].action;
+            }
+        }
+        if (action == KEY_NONE || keymap_bind(m, key, action, (int)pin, ms) != 0) {
+            return -1;
+        }
+        tok = end;
+    }
+    return 0;
+}
+
+int keymap_dispatch(keymap_t *m, const input_ev_t *evs, int n, keymap_cmd_fn on_cmd, void *arg){
+    for (int i = 0; i < n; i++) {
+        keymap_entry_t *e = &m->key[evs[i].key & 0xff];
+        switch (e->action) {
+            case KEY_PRESS:
+                set_pin(e->pin, 1, evs[i].t_ns);
+                break;
+            case KEY_RELEASE:
+                set_pin(e->pin, 0, evs[i].t_ns);
+                break;
+            case KEY_TOGGLE:
+                set_pin(e->pin, !raw_level(e->pin), evs[i].t_ns);
+                break;
+            case KEY_PULSE:
+                if (!timer_active(&e->release)) {
+                    // 1 "suficiente" y el timer lo suelta
+                    set_pin(e->pin, 1, evs[i].t_ns);
+                    timer_start(&e->release, e->pulse_ms, 0);
+                }
+                break;
+            case KEY_CMD:
+                if (on_cmd != NULL) {
+                    int r = on_cmd(e->cmd, arg);
+                    if (r != 0) {
+                        return r;
+                    }
+                }
+                break;
+            default:
+                break; // tecla sin asignar
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+  latency.c — Histogramas de latencia log-lineales (estilo HdrHistogram)
+
+  Ideas clave:
+  - Valores < 32 ns van cada uno a su cubeta (exactos).
+  - Para valores mayores, msb = bit más alto. La cubeta es:
+        fila    = msb - LAT_SUB_BITS + 1
+        columna = los LAT_SUB_BITS bits siguientes al msb
+    o sea, 32 cubetas iguales dentro de cada potencia de 2.
+  - El percentil se reporta como el valor más alto de su cubeta (conservador).
+  - Los histogramas por pin se reservan recién cuando el pin tiene su primera
+    muestra (4096 pines * ~9 KB sería demasiado para tenerlos todos).
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "latency.h"
+#include "gpio.h"
+
+static inline int bucket_of(uint64_t v){
+    if (v < LAT_SUB) {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    if (msb >= LAT_MAX_BITS) {
+        return LAT_BUCKETS - 1; // saturamos en la última cubeta
+    }
+    int shift = msb - LAT_SUB_BITS;
+    return (shift + 1) * LAT_SUB + (int)((v >> shift) - LAT_SUB);
+}
+
+// Valor más alto que cae en la cubeta b
+static inline uint64_t bucket_top(int b){
+    if (b < LAT_SUB) {
+        return (uint64_t)b;
+    }
+    int shift = b / LAT_SUB - 1;
+    uint64_t lo = (uint64_t)(b % LAT_SUB + LAT_SUB) << shift;
+    return lo + ((1ULL << shift) - 1);
+}
+
+void lat_hist_reset(lat_hist_t *h){
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+void lat_hist_record(lat_hist_t *h, uint64_t ns){
+    h->bucket[bucket_of(ns)]++;
+    h->count++;
+    h->sum += ns;
+    if (ns < h->min) h->min = ns;
+    if (ns > h->max) h->max = ns;
+}
+
+uint64_t lat_hist_percentile(const lat_hist_t *h, double p){
+    if (h->count == 0) {
+        return 0;
+    }
+    // rango (1..count) de la muestra buscada
+    uint64_t rank = (uint64_t)((p / 100.0) * (double)h->count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->count) rank = h->count;
+
+    uint64_t acc = 0;
+    for (int b = 0; b < LAT_BUCKETS; b++) {
+        acc += h->bucket[b];
+        if (acc >= rank) {
+            uint64_t v = bucket_top(b);
+            return (v > h->max) ? h->max : v; // nunca más que el máximo real
+        }
+    }
+    return h->max;
+}
+
+void lat_hist_print(const lat_hist_t *h, const char *name, FILE *f){
+    if (h->count == 0) {
+        fprintf(f, "%-12s sin muestras\n", name);
+        return;
+    }
+    fprintf(f, "%-12s n=%-8llu min=%.3f p50=%.3f p99=%.3f p999=%.3f max=%.3f prom=%.3f ms\n",
+            name, (unsigned long long)h->count,
+            h->min / 1e6,
+            lat_hist_percentile(h, 50.0) / 1e6,
+            lat_hist_percentile(h, 99.0) / 1e6,
+            lat_hist_percentile(h, 99.9) / 1e6,
+            h->max / 1e6,
+            (double)h->sum / (double)h->count / 1e6);
+}
+
+/*==========================================================
+=                   LATENCIA POR PIN                       =
+==========================================================*/
+
+static lat_hist_t *hist[GPIO_PIN_MAX];   // histograma por pin (lazy)
+static long long   mark[GPIO_PIN_MAX];   // instante del primer flanco crudo pendiente (0 = nada)
+
+static int pin_ok(int pin){
+    return pin >= 0 && pin < GPIO_PIN_MAX;
+}
+
+void latency_mark(int pin, long long t_ns){
+    if (pin_ok(pin) && mark[pin] == 0) {
+        mark[pin] = t_ns ? t_ns : 1; // 0 está reservado para "sin marca"
+    }
+}
+
+void latency_done(int pin, long long t_ns){
+    if (!pin_ok(pin) || mark[pin] == 0) {
+        return;
+    }
+    if (hist[pin] == NULL) {
+        hist[pin] = malloc(sizeof(lat_hist_t));
+        if (hist[pin] == NULL) {
+            return;
+        }
+        lat_hist_reset(hist[pin]);
+    }
+    long long d = t_ns - mark[pin];
+    lat_hist_record(hist[pin], (uint64_t)(d > 0 ? d : 0));
+    mark[pin] = 0;
+}
+
+void latency_cancel(int pin){
+    if (pin_ok(pin)) {
+        mark[pin] = 0;
+    }
+}
+
+const lat_hist_t *latency_hist(int pin){
+    return pin_ok(pin) ? hist[pin] : NULL;
+}
+
+void latency_dump(FILE *f){
+    int any = 0;
+    for (int pin = 0; pin < GPIO_PIN_MAX; pin++) {
+        if (hist[pin] != NULL) {
+            char name[24];
+            snprintf(name, sizeof(name), "pin %d", pin);
+            lat_hist_print(hist[pin], name, f);
+            any = 1;
+        }
+    }
+    if (!any) {
+        fprintf(f, "latencia: sin muestras\n");
+    }
+}
+
+void latency_reset(void){
+    for (int pin = 0; pin < GPIO_PIN_MAX; pin++) {
+        free(hist[pin]);
+        hist[pin] = NULL;
+        mark[pin] = 0;
+    }
+}
@@ -4,85 +4,301 @@
     - Botón 1 => LED ON (1)
     - Botón 0 => LED OFF (0)
   Con debounce por nivel: el LED solo cambia cuando el nivel es estable.
+  Sin polling en reposo: el loop duerme en event_wait() hasta que llega una
+  tecla, un flanco del botón (interrupción simulada), un error de GPIO o vence
+  un timer. Las teclas las lee un hilo aparte (input.c) y llegan por una cola
+  sin syscalls. El muestreo cada POLL_MS es un timer periódico que solo corre
+  mientras el debounce tiene un cambio pendiente, y los errores de GPIO se
+  escriben cuando aparecen (a lo sumo uno cada ERR_FLUSH_MS).
   Teclado:
     '1' = presiona (pone 1 crudo)
     '0' = suelta  (pone 0 crudo)
-    'q' = salir
+    'l' = imprime histogramas de latencia (flanco crudo -> LED)
+    'T' = imprime corridas y tiempo de CPU de cada tarea (task.h)
+    'q' = salir (también imprime la latencia)
+  Las teclas se decodifican con una tabla (keymap.h): todo lo que llegó junto
+  (pegado, script) se atiende en una sola vuelta del loop.
+  Opciones:
+    --record TRAZA = graba cada cambio crudo del botón en TRAZA (ver replay)
+    --vcd ONDAS    = vuelca botón y LED en formato VCD (GTKWave)
+    --keymap MAPA  = teclas extra, p. ej. "a=press:2,z=release:2,t=toggle:3"
+    --batch GUION  = sin terminal: teclas y esperas desde GUION ("-" = stdin,
+                     formato en batch.h); al terminar imprime un resumen
+    --virtual      = con --batch, reloj virtual: las esperas no duermen
+    --out ARCHIVO  = con --batch, cambios de LED (con su instante) a ARCHIVO
+                     en lugar de stdout; el resumen va a stderr
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "pins.h"
 #include "gpio.h"
-#include "debounce.h"
+#include "gpio_pins.h"
+#include "gpio_err.h"
+#include "app.h"
 #include "timeutil.h"
+#include "timer.h"
 #include "tty.h"
+#include "input.h"
+#include "keymap.h"
+#include "event.h"
+#include "task.h"
+#include "latency.h"
+#include "trace.h"
+#include "vcd.h"
+#include "batch.h"
 
-int main(void){
-    const int POLL_MS = 40; // 40ms para el polling
-    const long long DEBOUNCE_MS = 50; // 50ms para el debounce
-    
-    //1. Hanilitamos el esatdo raw de la terminal
-    tty_raw_enable();
-    //2. y volvemos a dejarlo en modo noraml al salir
-    atexit(tty_raw_disable);
-
-    //3. Inicializamos la capa GPIO
-    gpio_init();
-    //4. Configuramos el LED como salida
-    gpio_mode(PIN_LED, GPIO_OUTPUT);
-    //5. Configuramos el botón como entrada con pull-up
-    gpio_mode(PIN_BUTTON, GPIO_INPUT);
-    //6. Configuramos la resistencia pull-up del botón
-    gpio_set_pull(PIN_BUTTON, GPIO_PULLDOWN); // Resistencia interna a GND (0 por defecto)
-
-    int last_led =0; //cache para imprimir solo cuando cambie
-    long long next_tick = now_ms(); // Programamos el primer tick
-
-    puts("SWITCH MODE");
-    puts("Presiona '1' para encender el LED, '0' para apagarlo.");
-    puts("Presiona 'q' para salir.");
+static const int       POLL_MS     = 40; // 40ms para el polling
+static const long long DEBOUNCE_MS = 50; // 50ms para el debounce
+static const long long SETTLE_MS   = 130; // fin de la entrada -> salir: DEBOUNCE_MS + 2 * POLL_MS
 
-    //Bucle primcipal
-    while(1){
-        //t. teclado no bloqueante
-        int c = tty_getch_nonblock();
-        if(c != EOF){
-            if(c == 'q'){
-                puts("Saliendo...");
-                break; // salir del bucle
-            } else if(c == '1'){
-                gpio_simulate_input(PIN_BUTTON, 1); // Simula botón presionado
-            } else if(c == '0'){
-                gpio_simulate_input(PIN_BUTTON, 0); // Simula botón soltado
-            }
-            
+static app_t          app;      // botón -> debounce -> LED
+static trace_writer_t rec;      // grabación (--record)
+static int            recording = 0;
+static keymap_t       keys;     // tecla -> acción
+static task_t         t_keys;   // tarea: teclado
+static task_t         t_errors; // tarea: mensajes de error de GPIO
+static int            quit = 0;
+static const char    *batch_path = NULL; // --batch
+static FILE          *out;                // cambios de LED y respuestas a comandos
+static long long      batch_t0;           // instante 0 de los eventos de --batch
+
+static const long long ERR_FLUSH_MS = 100; // separación mínima entre dos escrituras de errores de GPIO
+
+enum { EV_INPUT = 1u << 0, EV_GPIO_ERR = 1u << 1 }; // eventos de las tareas
+
+enum { CMD_QUIT = 1, CMD_LATENCY, CMD_TASKS };
+
+//Imprimir el estado del LED (solo se llama cuando cambia)
+static void on_led(app_t *a, int led){
+    (void)a;
+    if(batch_path != NULL){
+        long long t = now_ns() - batch_t0; // desde el arranque: misma base con reloj real y virtual
+        fprintf(out, "%lld.%03lld LED %s\n", t / 1000000, t / 1000 % 1000, led ? "ON" : "OFF");
+        return;
+    }
+    printf("LED: %s\n", led ? "ON" : "OFF");
+}
+
+//Teclas que no tocan pines
+static int on_cmd(int cmd, void *arg){
+    (void)arg;
+    if(cmd == CMD_LATENCY){
+        latency_dump(out);
+        return 0;
+    }
+    if(cmd == CMD_TASKS){
+        task_dump(out);
+        return 0;
+    }
+    fputs("Saliendo...\n", out);
+    return 1; // CMD_QUIT: cortar el lote y salir del bucle
+}
+
+//Tarea teclado: duerme hasta que el hilo de entrada publica teclas y las
+//atiende en lotes por la tabla de teclas (latencia medida desde que se leyó)
+static int keys_task(task_t *t){
+    static input_ev_t evs[256];
+    int n;
+    TASK_BEGIN(t);
+    while(!quit){
+        TASK_WAIT_EVENT(t, EV_INPUT);
+        while(!quit && (n = input_poll_burst(evs, 256)) > 0){
+            quit = keymap_dispatch(&keys, evs, n, on_cmd, NULL);
+        }
+        // fin de la entrada sin 'q' (pipe, archivo): dejar que termine el debounce y salir
+        if(!quit && input_eof()){
+            TASK_SLEEP_MS(t, SETTLE_MS);
+            quit = 1;
+        }
+    }
+    TASK_END(t);
+}
+
+//Tarea errores: duerme hasta que gpio_err avisa; después de escribir, ERR_FLUSH_MS de pausa
+static int errors_task(task_t *t){
+    TASK_BEGIN(t);
+    for(;;){
+        TASK_WAIT_EVENT(t, EV_GPIO_ERR);
+        gpio_err_flush(stderr);
+        TASK_SLEEP_MS(t, ERR_FLUSH_MS);
+    }
+    TASK_END(t);
+}
+
+int main(int argc, char **argv){
+    //0. Opciones: --record TRAZA, --vcd ONDAS, --keymap MAPA, --batch GUION [--virtual] [--out ARCHIVO]
+    const char *rec_path = NULL;
+    const char *vcd_path = NULL;
+    const char *map_spec = NULL;
+    const char *out_path = NULL;
+    int         virt     = 0;
+    for(int i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--record") == 0 && i + 1 < argc){
+            rec_path = argv[++i];
+        } else if(strcmp(argv[i], "--vcd") == 0 && i + 1 < argc){
+            vcd_path = argv[++i];
+        } else if(strcmp(argv[i], "--keymap") == 0 && i + 1 < argc){
+            map_spec = argv[++i];
+        } else if(strcmp(argv[i], "--batch") == 0 && i + 1 < argc){
+            batch_path = argv[++i];
+        } else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc){
+            out_path = argv[++i];
+        } else if(strcmp(argv[i], "--virtual") == 0){
+            virt = 1;
+        } else {
+            fprintf(stderr, "uso: %s [--record TRAZA] [--vcd ONDAS] [--keymap MAPA]\n"
+                            "       [--batch GUION [--virtual] [--out ARCHIVO]]\n", argv[0]);
+            return 1;
         }
+    }
+    if(batch_path == NULL && (virt || out_path != NULL)){
+        fprintf(stderr, "--virtual y --out van con --batch\n");
+        return 1;
+    }
 
-        //7. Polling del botón cada POLL_MS ms
-        if(now_ms() >= next_tick){
-            //leer el esstado curdo dedl boton|
-            int raw = gpio_read(PIN_BUTTON);
-            
-            //8. Aplicar debounce al estado crudo
-            int stable = debounce_state(raw, DEBOUNCE_MS); // Aplicar debounce
+    //1. Hanilitamos el esatdo raw de la terminal (solo si hay una y no es batch)
+    if(batch_path == NULL && isatty(STDIN_FILENO)){
+        tty_raw_enable();
+        //2. y volvemos a dejarlo en modo noraml al salir
+        atexit(tty_raw_disable);
+    }
 
-            //9. LED sigue el esatdo esatble del botón
-            gpio_write(PIN_LED, stable); // Escribir el estado estable al LED
+    //2b. Salida de eventos: en batch con buffer grande (un write cada 64 KiB, no uno por LED)
+    out = stdout;
+    if(batch_path != NULL){
+        if(out_path != NULL && (out = fopen(out_path, "w")) == NULL){
+            perror(out_path);
+            return 1;
+        }
+        setvbuf(out, NULL, _IOFBF, 1 << 16);
+    }
+    //2c. El reloj virtual va antes que todo lo que mira la hora (timers, debounce)
+    if(virt){
+        vclock_enable(0);
+    }
+    batch_t0 = now_ns();
 
-            //10. Imprimir el estado del LED solo si ha cambiado
-            if(stable != last_led){
-                last_led = stable; // Actualizar el cache
-                printf("LED: %s\n", stable ? "ON" : "OFF"); // Imprimir estado del LED
-            }
+    //3. Inicializamos la capa GPIO y los timers
+    if(gpio_init() != 0){
+        return 1; // el motivo ya está en stderr
+    }
+    pins_config(); // modo y pull de todos los pines de pins.h
+    timer_service_init();
 
-            //11. Programar el siguiente tick
-            next_tick += POLL_MS; // Incrementar el tiempo del próximo tick
+    //4. LED salida, botón entrada con pull-down e interrupción en ambos flancos
+    if(app_init(&app, APP_SWITCH, PIN_BUTTON, PIN_LED, POLL_MS, DEBOUNCE_MS, on_led, NULL) != 0){
+        fprintf(stderr, "app_init: pines no válidos\n");
+        return 1;
+    }
 
+    //4b. Teclas: '1'/'0' mueven el botón, 'l' latencia, 'q' salir (+ las de --keymap)
+    keymap_init(&keys);
+    keymap_bind(&keys, '1', KEY_PRESS, PIN_BUTTON, 0);
+    keymap_bind(&keys, '0', KEY_RELEASE, PIN_BUTTON, 0);
+    keymap_bind_cmd(&keys, 'l', CMD_LATENCY);
+    keymap_bind_cmd(&keys, 'T', CMD_TASKS);
+    keymap_bind_cmd(&keys, 'q', CMD_QUIT);
+    if(map_spec != NULL && keymap_parse(&keys, map_spec) != 0){
+        fprintf(stderr, "--keymap: mapa no válido: %s\n", map_spec);
+        return 1;
+    }
+
+    //5. Grabación opcional de las entradas crudas
+    if(rec_path != NULL){
+        if(trace_writer_open(&rec, rec_path, now_ns()) != 0){
+            perror(rec_path);
+            return 1;
+        }
+        gpio_trace_attach(&rec);
+        recording = 1;
+    }
+
+    //6. Volcado VCD opcional (botón crudo + LED)
+    if(vcd_path != NULL){
+        static const int   vcd_pins[]  = { PIN_BUTTON, PIN_LED };
+        static const char *vcd_names[] = { "boton", "led" };
+        if(vcd_open(vcd_path, vcd_pins, vcd_names, 2) != 0){
+            perror(vcd_path);
+            return 1;
         }
+    }
 
-        //12. Dormir hasta el próximo tick
-        sleep_ms(1); // Dormir para no consumir 100% CPU
+    //7. Despertador del loop (flancos GPIO, teclado) y el hilo que lee el teclado
+    if(event_init() != 0 || (batch_path == NULL && input_start(STDIN_FILENO) != 0)){
+        perror("event_init");
+        return 1;
+    }
+    gpio_err_notify_attach(event_signal); // un error de GPIO despierta al loop
+
+    if(batch_path == NULL){
+        puts("SWITCH MODE");
+        puts("Presiona '1' para encender el LED, '0' para apagarlo.");
+        puts("Presiona 'l' para ver la latencia, 'T' las tareas, 'q' para salir.");
+    }
+
+    //8. Tareas del loop (el muestreo del botón es un timer de app.c)
+    tick_update();
+    task_start(&t_keys, "teclado", keys_task, NULL);
+    task_start(&t_errors, "errores", errors_task, NULL);
+
+    //8b. Sin terminal: el guion reemplaza a event_wait (mismas teclas, timers y tareas)
+    int           status = 0;
+    batch_stats_t bst;
+    if(batch_path != NULL){
+        batch_cfg_t cfg = { batch_path, &keys, on_cmd, NULL, SETTLE_MS };
+        status = (batch_run(&cfg, &bst) != 0);
+        quit = 1;
+    }
+
+    //Bucle primcipal
+    while(!quit){
+        //9. Dormir hasta: tecla, flanco, el próximo timer o una tarea lista
+        if(event_wait(task_ms_until_next()) != 0){
+            task_post(&t_keys, EV_INPUT);
+        }
+        if(gpio_err_pending()){
+            task_post(&t_errors, EV_GPIO_ERR);
+        }
+        gpio_poll(); // flancos que llegaron de fuera del proceso (placa compartida)
+
+        //10. Una lectura del reloj para toda la iteración (timers + debounce + tareas)
+        tick_update();
+
+        //11. Timers vencidos (muestreo del botón, despertar tareas) y tareas listas
+        timer_run_due(tick_ms());
+        task_run_ready();
+    }
+    FILE *info = (batch_path != NULL) ? stderr : stdout; // en batch, stdout/--out queda solo con eventos
+    if(recording){
+        gpio_trace_attach(NULL);
+        fprintf(info, "Traza: %llu registros en %s\n", (unsigned long long)rec.count, rec_path);
+        trace_writer_close(&rec);
+    }
+    if(vcd_active){
+        vcd_stats_t st;
+        vcd_close();
+        vcd_stats(&st);
+        fprintf(info, "VCD: %llu cambios en %s (%llu perdidos)\n",
+                (unsigned long long)st.changes, vcd_path, (unsigned long long)st.dropped);
+    }
+    input_stop();
+    if(input_stalls() > 0){
+        fprintf(info, "Entrada: %llu esperas con la cola llena\n", (unsigned long long)input_stalls());
+    }
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+    latency_dump(info);
+    task_dump(info);
+    if(batch_path != NULL){
+        fprintf(info, "LED: %llu cambios\n", (unsigned long long)app.led_changes);
+        batch_print(&bst, info);
+        if(out != stdout){
+            fclose(out);
+        }
     }
-    return 0; // Salir del programa
-}
\ No newline at end of file
+    event_close();
+    return status; // Salir del programa
+}
@@ -5,84 +5,293 @@
     - No necesitas presionar '0'. Simulamos un “pulso virtual” 0->1->0 suficientemente largo
       para que pase el debounce y el polling lo vea.
 
+  Sin polling en reposo: el muestreo (cada POLL_MS) y el fin del pulso virtual
+  son timers; el loop duerme en event_wait() hasta una tecla, un flanco, un
+  error de GPIO o el próximo vencimiento. Las teclas las lee un hilo aparte
+  (input.c) y llegan por una cola sin syscalls.
+
   Teclado:
     '1' = genera un press virtual (mantiene 1 ms suficiente y luego suelta)
-    'q' = salir
+    'l' = imprime histogramas de latencia (flanco crudo -> LED)
+    'T' = imprime corridas y tiempo de CPU de cada tarea (task.h)
+    'q' = salir (también imprime la latencia)
+  Las teclas se decodifican con una tabla (keymap.h): el '1' es un KEY_PULSE,
+  y todo lo que llegó junto se atiende en una sola vuelta del loop.
+
+  Opciones:
+    --record TRAZA = graba cada cambio crudo del botón en TRAZA (ver replay)
+    --vcd ONDAS    = vuelca botón y LED en formato VCD (GTKWave)
+    --keymap MAPA  = teclas extra, p. ej. "a=press:2,z=release:2,p=pulse:4:60"
+    --batch GUION  = sin terminal: teclas y esperas desde GUION ("-" = stdin,
+                     formato en batch.h); al terminar imprime un resumen
+    --virtual      = con --batch, reloj virtual: las esperas no duermen
+    --out ARCHIVO  = con --batch, cambios de LED (con su instante) a ARCHIVO
+                     en lugar de stdout; el resumen va a stderr
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "pins.h"
 #include "gpio.h"
-#include "debounce.h"
+#include "gpio_pins.h"
+#include "gpio_err.h"
+#include "app.h"
 #include "timeutil.h"
+#include "timer.h"
 #include "tty.h"
+#include "input.h"
+#include "keymap.h"
+#include "event.h"
+#include "task.h"
+#include "latency.h"
+#include "trace.h"
+#include "vcd.h"
+#include "batch.h"
+
+static const int POLL_MS         = 5;   // Periodo de muestreo
+static const int DEBOUNCE_MS     = 50;  // Ventana de estabilidad requerida
+static const int PULSE_MARGIN_MS = 5;   // Margen extra para asegurar detección
+static const int SETTLE_MS       = 120; // Fin de la entrada -> salir: 2 * (DEBOUNCE + MARGEN + POLL)
+
+static app_t          app;            // botón -> debounce -> LED (modo toggle)
+static trace_writer_t rec;            // grabación (--record)
+static int            recording = 0;
+static keymap_t       keys;           // tecla -> acción
+static task_t         t_keys;         // tarea: teclado
+static task_t         t_errors;       // tarea: mensajes de error de GPIO
+static int            quit = 0;
+static const char    *batch_path = NULL; // --batch
+static FILE          *out;                // cambios de LED y respuestas a comandos
+static long long      batch_t0;           // instante 0 de los eventos de --batch
+
+static const long long ERR_FLUSH_MS = 100; // separación mínima entre dos escrituras de errores de GPIO
+
+enum { EV_INPUT = 1u << 0, EV_GPIO_ERR = 1u << 1 }; // eventos de las tareas
+
+enum { CMD_QUIT = 1, CMD_LATENCY, CMD_TASKS };
+
+// Imprimir solo al cambiar
+static void on_led(app_t *a, int led){
+    (void)a;
+    if (batch_path != NULL){
+        long long t = now_ns() - batch_t0; // desde el arranque: misma base con reloj real y virtual
+        fprintf(out, "%lld.%03lld LED %s\n", t / 1000000, t / 1000 % 1000, led ? "ENCENDIDO" : "APAGADO");
+        return;
+    }
+    printf("LED: %s\n", led ? "ENCENDIDO" : "APAGADO");
+}
+
+// Teclas que no tocan pines
+static int on_cmd(int cmd, void *arg){
+    (void)arg;
+    if (cmd == CMD_LATENCY){
+        latency_dump(out);
+        return 0;
+    }
+    if (cmd == CMD_TASKS){
+        task_dump(out);
+        return 0;
+    }
+    fputs("Saliendo...\n", out);
+    return 1; // CMD_QUIT
+}
 
-int main(void){
-    const int POLL_MS         = 5;   // Periodo de muestreo
-    const int DEBOUNCE_MS     = 50;  // Ventana de estabilidad requerida
-    const int PULSE_MARGIN_MS = 5;   // Margen extra para asegurar detección
-
-    tty_raw_enable();
-    atexit(tty_raw_disable);
-
-    gpio_init();
-    gpio_mode(PIN_LED, GPIO_OUTPUT);
-    gpio_mode(PIN_BUTTON, GPIO_INPUT);
-    gpio_set_pull(PIN_BUTTON, GPIO_PULLDOWN); // por defecto 0
-
-    // Estado “visual” para no spamear prints
-    int last_led = -1;
-    long long next_tick = now_ms();
-
-    // Pulso virtual (para no necesitar tecla '0')
-    int        virt_pressed    = 0;
-    long long  virt_release_at = 0;
-
-    puts("TOGGLE: '1' = alterna LED (pulso virtual). 'q' = salir.");
-
-    while (1){
-        // 1) Teclado no bloqueante
-        int ch = tty_getch_nonblock();
-        if (ch != EOF){
-            if (ch=='q' || ch=='Q') { puts("Saliendo..."); break; }
-            if (ch=='1' && !virt_pressed){
-                // Generamos un press: poner 1 “suficiente” para pasar el debounce
-                gpio_simulate_input(PIN_BUTTON, 1);
-                virt_pressed    = 1;
-                virt_release_at = now_ms() + DEBOUNCE_MS + PULSE_MARGIN_MS;
-            }
+// Tarea teclado: vaciar la cola en lotes y decodificar con la tabla
+// (latencia medida desde que se leyó la tecla)
+static int keys_task(task_t *t){
+    static input_ev_t evs[256];
+    int n;
+    TASK_BEGIN(t);
+    while (!quit){
+        TASK_WAIT_EVENT(t, EV_INPUT);
+        while (!quit && (n = input_poll_burst(evs, 256)) > 0){
+            quit = keymap_dispatch(&keys, evs, n, on_cmd, NULL);
+        }
+        // fin de la entrada sin 'q' (pipe, archivo): dejar que termine el debounce y salir
+        if (!quit && input_eof()){
+            TASK_SLEEP_MS(t, SETTLE_MS);
+            quit = 1;
         }
+    }
+    TASK_END(t);
+}
 
-        long long now = now_ms();
+// Tarea errores: duerme hasta que gpio_err avisa; después de escribir, ERR_FLUSH_MS de pausa
+static int errors_task(task_t *t){
+    TASK_BEGIN(t);
+    for (;;){
+        TASK_WAIT_EVENT(t, EV_GPIO_ERR);
+        gpio_err_flush(stderr);
+        TASK_SLEEP_MS(t, ERR_FLUSH_MS);
+    }
+    TASK_END(t);
+}
 
-        // 2) Polling ANTES de liberar el “pulso”
-        if (now >= next_tick){
-            int raw = gpio_read(PIN_BUTTON);
+int main(int argc, char **argv){
+    const char *rec_path = NULL;
+    const char *vcd_path = NULL;
+    const char *map_spec = NULL;
+    const char *out_path = NULL;
+    int         virt     = 0;
+    for (int i = 1; i < argc; i++){
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc){
+            rec_path = argv[++i];
+        } else if (strcmp(argv[i], "--vcd") == 0 && i + 1 < argc){
+            vcd_path = argv[++i];
+        } else if (strcmp(argv[i], "--keymap") == 0 && i + 1 < argc){
+            map_spec = argv[++i];
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc){
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc){
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--virtual") == 0){
+            virt = 1;
+        } else {
+            fprintf(stderr, "uso: %s [--record TRAZA] [--vcd ONDAS] [--keymap MAPA]\n"
+                            "       [--batch GUION [--virtual] [--out ARCHIVO]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (batch_path == NULL && (virt || out_path != NULL)){
+        fprintf(stderr, "--virtual y --out van con --batch\n");
+        return 1;
+    }
 
-            // Si hay flanco 0->1 estable, alternar LED
-            if (debounce_press(raw, DEBOUNCE_MS)){
-                int led = gpio_read(PIN_LED);
-                gpio_write(PIN_LED, !led);
-            }
+    // Terminal en modo raw solo si hay una y no es batch
+    if (batch_path == NULL && isatty(STDIN_FILENO)){
+        tty_raw_enable();
+        atexit(tty_raw_disable);
+    }
 
-            // Imprimir solo al cambiar
-            int led_now = gpio_read(PIN_LED);
-            if (led_now != last_led){
-                printf("LED: %s\n", led_now ? "ENCENDIDO" : "APAGADO");
-                last_led = led_now;
-            }
+    // Eventos: en batch con buffer grande (un write cada 64 KiB, no uno por LED)
+    out = stdout;
+    if (batch_path != NULL){
+        if (out_path != NULL && (out = fopen(out_path, "w")) == NULL){
+            perror(out_path);
+            return 1;
+        }
+        setvbuf(out, NULL, _IOFBF, 1 << 16);
+    }
+    // El reloj virtual va antes que todo lo que mira la hora (timers, debounce)
+    if (virt){
+        vclock_enable(0);
+    }
+    batch_t0 = now_ns();
 
-            next_tick += POLL_MS;
+    if (gpio_init() != 0){
+        return 1; // el motivo ya está en stderr
+    }
+    pins_config();
+    timer_service_init();
+
+    if (app_init(&app, APP_TOGGLE, PIN_BUTTON, PIN_LED, POLL_MS, DEBOUNCE_MS, on_led, NULL) != 0){
+        fprintf(stderr, "app_init: pines no válidos\n");
+        return 1;
+    }
+
+    // '1' = pulso 0->1->0 "suficiente" para pasar el debounce (ignorado mientras dura)
+    keymap_init(&keys);
+    keymap_bind(&keys, '1', KEY_PULSE, PIN_BUTTON, DEBOUNCE_MS + PULSE_MARGIN_MS);
+    keymap_bind_cmd(&keys, 'l', CMD_LATENCY);
+    keymap_bind_cmd(&keys, 'T', CMD_TASKS);
+    keymap_bind_cmd(&keys, 'q', CMD_QUIT);
+    keymap_bind_cmd(&keys, 'Q', CMD_QUIT);
+    if (map_spec != NULL && keymap_parse(&keys, map_spec) != 0){
+        fprintf(stderr, "--keymap: mapa no válido: %s\n", map_spec);
+        return 1;
+    }
+
+    if (rec_path != NULL){
+        if (trace_writer_open(&rec, rec_path, now_ns()) != 0){
+            perror(rec_path);
+            return 1;
         }
+        gpio_trace_attach(&rec);
+        recording = 1;
+    }
 
-        // 3) AHORA sí: liberar el pulso (poner 0) después de haber muestreado
-        if (virt_pressed && now_ms() >= virt_release_at){
-            gpio_simulate_input(PIN_BUTTON, 0);
-            virt_pressed = 0;
+    if (vcd_path != NULL){
+        static const int   vcd_pins[]  = { PIN_BUTTON, PIN_LED };
+        static const char *vcd_names[] = { "boton", "led" };
+        if (vcd_open(vcd_path, vcd_pins, vcd_names, 2) != 0){
+            perror(vcd_path);
+            return 1;
         }
+    }
+
+    if (event_init() != 0 || (batch_path == NULL && input_start(STDIN_FILENO) != 0)){
+        perror("event_init");
+        return 1;
+    }
+    gpio_err_notify_attach(event_signal); // un error de GPIO despierta al loop
+
+    app_kick(&app); // primer muestreo para imprimir el estado inicial
+
+    if (batch_path == NULL){
+        puts("TOGGLE: '1' = alterna LED (pulso virtual). 'l' = latencia. 'T' = tareas. 'q' = salir.");
+    }
 
-        sleep_ms(1);
+    // Tareas del loop (muestreo y fin de pulso son timers de app.c / keymap.c)
+    tick_update();
+    task_start(&t_keys, "teclado", keys_task, NULL);
+    task_start(&t_errors, "errores", errors_task, NULL);
+
+    // Sin terminal: el guion reemplaza a event_wait (mismas teclas, timers y tareas)
+    int           status = 0;
+    batch_stats_t bst;
+    if (batch_path != NULL){
+        batch_cfg_t cfg = { batch_path, &keys, on_cmd, NULL, SETTLE_MS };
+        status = (batch_run(&cfg, &bst) != 0);
+        quit = 1;
+    }
+
+    while (!quit){
+        // 0) Dormir hasta tecla, flanco, el próximo timer o una tarea lista
+        if (event_wait(task_ms_until_next()) != 0){
+            task_post(&t_keys, EV_INPUT);
+        }
+        if (gpio_err_pending()){
+            task_post(&t_errors, EV_GPIO_ERR);
+        }
+        gpio_poll(); // flancos que llegaron de fuera del proceso (placa compartida)
+
+        // 1) Una sola lectura del reloj para timers, debounce y tareas
+        tick_update();
+
+        // 2) Muestreo, fin de pulso y tareas, según lo que haya vencido
+        timer_run_due(tick_ms());
+        task_run_ready();
+    }
+    FILE *info = (batch_path != NULL) ? stderr : stdout; // en batch, stdout/--out queda solo con eventos
+    if (recording){
+        gpio_trace_attach(NULL);
+        fprintf(info, "Traza: %llu registros en %s\n", (unsigned long long)rec.count, rec_path);
+        trace_writer_close(&rec);
+    }
+    if (vcd_active){
+        vcd_stats_t st;
+        vcd_close();
+        vcd_stats(&st);
+        fprintf(info, "VCD: %llu cambios en %s (%llu perdidos)\n",
+                (unsigned long long)st.changes, vcd_path, (unsigned long long)st.dropped);
+    }
+    input_stop();
+    if (input_stalls() > 0){
+        fprintf(info, "Entrada: %llu esperas con la cola llena\n", (unsigned long long)input_stalls());
+    }
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+    latency_dump(info);
+    task_dump(info);
+    if (batch_path != NULL){
+        fprintf(info, "LED: %llu cambios\n", (unsigned long long)app.led_changes);
+        batch_print(&bst, info);
+        if (out != stdout){
+            fclose(out);
+        }
     }
-    return 0;
+    event_close();
+    return status;
 }
@@ -0,0 +1,345 @@
+/*
+    nvic.c — CONTROLADOR DE INTERRUPCIONES SIMULADO (implementación de nvic.h)
+
+    Estado compartido (todo atómico, sin locks):
+    - pending / enabled: una palabra de 64 bits (un bit por línea)
+    - prio_mask[p]: líneas con prioridad p. Elegir la más urgente = hasta 16
+      AND contra pending & enabled y un ctz
+    - cur_prio: prioridad que corre ahora en el núcleo
+      (NVIC_PRIO_LEVELS = "modo hilo", ningún handler activo)
+
+    Preempción: si llega algo más urgente que cur_prio, set_pending manda
+    NVIC_SIGNAL al hilo del núcleo; el manejador de la señal (SA_NODEFER,
+    así se puede anidar otra vez) llama a dispatch() con la prioridad
+    actual como techo. Cada nivel anidado necesita ser estrictamente más
+    urgente, así que la pila crece como mucho NVIC_PRIO_LEVELS veces.
+
+    Reloj: siempre CLOCK_MONOTONIC (el núcleo vive en tiempo real aunque el
+    resto use el reloj virtual).
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "nvic.h"
+#include "timeutil.h"
+
+#define NVIC_SIGNAL     SIGRTMIN
+#define NVIC_THREAD_MODE NVIC_PRIO_LEVELS
+
+typedef struct{
+    nvic_handler_t handler;
+    void          *arg;
+} nvic_vector_t;
+
+static nvic_vector_t         vectors[NVIC_IRQ_COUNT];
+static uint8_t               prio[NVIC_IRQ_COUNT];
+static _Atomic uint64_t      prio_mask[NVIC_PRIO_LEVELS] = { UINT64_MAX }; // todas arrancan en 0
+static _Atomic uint64_t      pending, enabled, active;
+static _Atomic long long     t_raise[NVIC_IRQ_COUNT];
+static nvic_stats_t          stats[NVIC_IRQ_COUNT];
+static _Atomic uint64_t      lost[NVIC_IRQ_COUNT];   // lo escriben otros hilos
+
+static atomic_int            cur_prio = NVIC_THREAD_MODE;
+static atomic_int            primask;
+static atomic_int            in_dispatch;             // niveles dentro de dispatch()
+static atomic_uint           wake;                    // futex del núcleo dormido
+static atomic_int            sleeping;
+static atomic_int            stop;
+static int                   running;
+static pthread_t             core;
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static int irq_is_valid(int irq){
+    return irq >= 0 && irq < NVIC_IRQ_COUNT;
+}
+
+// Prioridad más urgente entre las listas (NVIC_THREAD_MODE si no hay)
+static int best_ready_prio(uint64_t ready){
+    for (int p = 0; p < NVIC_PRIO_LEVELS; p++) {
+        if (ready & atomic_load_explicit(&prio_mask[p], memory_order_relaxed)) {
+            return p;
+        }
+    }
+    return NVIC_THREAD_MODE;
+}
+
+// Avisa al núcleo que hay algo de prioridad p listo
+static void kick(int p){
+    if (!running || atomic_load(&primask)) {
+        return;
+    }
+    int cur = atomic_load(&cur_prio);
+    if (cur == NVIC_THREAD_MODE) {
+        atomic_fetch_add(&wake, 1);
+        if (atomic_load(&sleeping)) {
+            syscall(SYS_futex, &wake, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+    } else if (p < cur) {
+        pthread_kill(core, NVIC_SIGNAL); // preempción
+    }
+}
+
+/*
+    Saca la línea lista más urgente que cur, -1 si no hay. Si la saca, deja
+    cur_prio en su prioridad ANTES de borrar el bit pendiente: una IRQ más
+    urgente que llegue desde ahí ya ve el núcleo ocupado y manda la señal
+    (si no, kick() solo tocaría el futex y esperaría a que termine el handler)
+*/
+static int take(int cur){
+    for (;;) {
+        uint64_t ready = atomic_load(&pending) & atomic_load(&enabled);
+        int p = best_ready_prio(ready);
+        if (p >= cur) {
+            return -1;
+        }
+        atomic_store(&cur_prio, p);
+        // lo que llegó antes de publicar p no mandó señal: si le gana, volver a elegir
+        if (best_ready_prio(atomic_load(&pending) & atomic_load(&enabled)) < p) {
+            atomic_store(&cur_prio, cur);
+            continue;
+        }
+        uint64_t m   = ready & atomic_load_explicit(&prio_mask[p], memory_order_relaxed);
+        int      irq = __builtin_ctzll(m);
+        uint64_t bit = 1ULL << irq;
+        if (atomic_fetch_and(&pending, ~bit) & bit) {
+            return irq;
+        }
+        // otro nivel de dispatch la tomó primero: devolver la prioridad y volver a mirar
+        atomic_store(&cur_prio, cur);
+    }
+}
+
+static void run(int irq, int cur){
+    nvic_stats_t *st = &stats[irq];
+    uint64_t bit = 1ULL << irq;
+    lat_hist_record(&st->latency, (uint64_t)(TIME_SOURCE_REAL.now_ns() - atomic_load(&t_raise[irq])));
+    st->count++;
+    if (cur != NVIC_THREAD_MODE) {
+        st->nested++;
+    }
+    atomic_fetch_or(&active, bit);   // cur_prio ya la puso take()
+    vectors[irq].handler(irq, vectors[irq].arg);
+    atomic_store(&cur_prio, cur);
+    atomic_fetch_and(&active, ~bit);
+}
+
+// Corre en orden de urgencia todo lo que le gana a la prioridad actual
+static void dispatch(void){
+    for (;;) {
+        int cur = atomic_load(&cur_prio);
+        atomic_fetch_add(&in_dispatch, 1);
+        if (atomic_load(&primask)) {
+            atomic_fetch_sub(&in_dispatch, 1);
+            return;
+        }
+        int irq = take(cur);
+        if (irq >= 0) {
+            run(irq, cur);
+        }
+        atomic_fetch_sub(&in_dispatch, 1);
+        if (irq < 0) {
+            return;
+        }
+    }
+}
+
+static void on_signal(int sig){
+    (void)sig;
+    int saved = errno;
+    dispatch();
+    errno = saved;
+}
+
+static void *core_main(void *arg){
+    (void)arg;
+    while (!atomic_load(&stop)) {
+        unsigned seen = atomic_load(&wake);
+        atomic_store(&sleeping, 1);
+        if ((atomic_load(&pending) & atomic_load(&enabled)) == 0 || atomic_load(&primask)) {
+            syscall(SYS_futex, &wake, FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+        }
+        atomic_store(&sleeping, 0);
+        dispatch();
+    }
+    return NULL;
+}
+
+static void gpio_to_irq(int pin, int level, void *arg){
+    (void)pin;
+    (void)level;
+    nvic_set_pending((int)(intptr_t)arg);
+}
+
+/*==========================================================
+=                    API PÚBLICA (nvic.h)                  =
+==========================================================*/
+
+int nvic_init(void){
+    if (running) {
+        return 0;
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sa.sa_flags   = SA_NODEFER | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(NVIC_SIGNAL, &sa, NULL) != 0) {
+        return -1;
+    }
+    for (int irq = 0; irq < NVIC_IRQ_COUNT; irq++) {
+        lat_hist_reset(&stats[irq].latency);
+    }
+    atomic_store(&stop, 0);
+    atomic_store(&cur_prio, NVIC_THREAD_MODE);
+    if (pthread_create(&core, NULL, core_main, NULL) != 0) {
+        return -1;
+    }
+    running = 1;
+    return 0;
+}
+
+void nvic_shutdown(void){
+    if (!running) {
+        return;
+    }
+    atomic_store(&stop, 1);
+    atomic_fetch_add(&wake, 1);
+    syscall(SYS_futex, &wake, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    pthread_join(core, NULL);
+    running = 0;
+}
+
+int nvic_attach(int irq, nvic_handler_t handler, void *arg){
+    if (!irq_is_valid(irq) || handler == NULL) {
+        return -1;
+    }
+    vectors[irq].handler = handler;
+    vectors[irq].arg     = arg;
+    return 0;
+}
+
+int nvic_set_priority(int irq, int p){
+    if (!irq_is_valid(irq) || p < 0 || p >= NVIC_PRIO_LEVELS) {
+        return -1;
+    }
+    uint64_t bit = 1ULL << irq;
+    atomic_fetch_and(&prio_mask[prio[irq]], ~bit);
+    prio[irq] = (uint8_t)p;
+    atomic_fetch_or(&prio_mask[p], bit);
+    return 0;
+}
+
+void nvic_enable(int irq){
+    if (!irq_is_valid(irq) || vectors[irq].handler == NULL) {
+        return;
+    }
+    uint64_t bit = 1ULL << irq;
+    atomic_fetch_or(&enabled, bit);
+    if (atomic_load(&pending) & bit) {
+        kick(prio[irq]);
+    }
+}
+
+void nvic_disable(int irq){
+    if (irq_is_valid(irq)) {
+        atomic_fetch_and(&enabled, ~(1ULL << irq));
+    }
+}
+
+void nvic_set_pending(int irq){
+    if (!irq_is_valid(irq)) {
+        return;
+    }
+    uint64_t bit = 1ULL << irq;
+    if (atomic_load_explicit(&pending, memory_order_relaxed) & bit) {
+        atomic_fetch_add_explicit(&lost[irq], 1, memory_order_relaxed);
+        return;
+    }
+    atomic_store(&t_raise[irq], TIME_SOURCE_REAL.now_ns());
+    if (atomic_fetch_or(&pending, bit) & bit) {
+        atomic_fetch_add_explicit(&lost[irq], 1, memory_order_relaxed);
+        return;
+    }
+    if (atomic_load(&enabled) & bit) {
+        kick(prio[irq]);
+    }
+}
+
+void nvic_clear_pending(int irq){
+    if (irq_is_valid(irq)) {
+        atomic_fetch_and(&pending, ~(1ULL << irq));
+    }
+}
+
+int nvic_is_pending(int irq){
+    return irq_is_valid(irq) && (atomic_load(&pending) >> irq & 1);
+}
+
+int nvic_is_active(int irq){
+    return irq_is_valid(irq) && (atomic_load(&active) >> irq & 1);
+}
+
+void nvic_irq_lock(void){
+    atomic_store(&primask, 1);
+    while (atomic_load(&in_dispatch) > 0) {
+        sched_yield(); // el handler en curso termina y dispatch ve la máscara
+    }
+}
+
+void nvic_irq_unlock(void){
+    atomic_store(&primask, 0);
+    uint64_t ready = atomic_load(&pending) & atomic_load(&enabled);
+    if (ready) {
+        kick(best_ready_prio(ready));
+    }
+}
+
+int nvic_gpio_route(int pin, gpio_edge_t edge, int irq){
+    if (!irq_is_valid(irq)) {
+        return -1;
+    }
+    return gpio_irq_attach(pin, edge, gpio_to_irq, (void *)(intptr_t)irq);
+}
+
+const nvic_stats_t *nvic_stats(int irq){
+    if (!irq_is_valid(irq)) {
+        return NULL;
+    }
+    stats[irq].lost = atomic_load(&lost[irq]);
+    return &stats[irq];
+}
+
+void nvic_stats_reset(void){
+    for (int irq = 0; irq < NVIC_IRQ_COUNT; irq++) {
+        stats[irq].count  = 0;
+        stats[irq].nested = 0;
+        stats[irq].lost   = 0;
+        atomic_store(&lost[irq], 0);
+        lat_hist_reset(&stats[irq].latency);
+    }
+}
+
+void nvic_dump(FILE *f){
+    fprintf(f, "%4s %5s %10s %9s %9s %10s %10s %10s\n",
+           "irq", "prio", "corridas", "anidadas", "perdidas", "p50 us", "p99 us", "max us");
+    for (int irq = 0; irq < NVIC_IRQ_COUNT; irq++) {
+        const nvic_stats_t *st = nvic_stats(irq);
+        if (st->count == 0 && st->lost == 0) {
+            continue;
+        }
+        fprintf(f, "%4d %5d %10llu %9llu %9llu %10.1f %10.1f %10.1f\n", irq, prio[irq],
+                (unsigned long long)st->count, (unsigned long long)st->nested, (unsigned long long)st->lost,
+                lat_hist_percentile(&st->latency, 50) / 1e3, lat_hist_percentile(&st->latency, 99) / 1e3,
+                (st->latency.count ? st->latency.max : 0) / 1e3);
+    }
+}
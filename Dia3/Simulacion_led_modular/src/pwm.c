@@ -0,0 +1,276 @@
+/*
+  pwm.c — Motor de PWM por software con agenda ordenada de flancos
+
+  Ideas clave:
+  - Eventos de un periodo: el inicio (suben todos, un gpio_write_mask por
+    puerto) y las bajadas de "edges", ya ordenadas por tiempo.
+  - La agenda se rearma solo al empezar un periodo y solo si hubo
+    pwm_set_duty(): se leen los registros sombra, qsort por (instante,
+    puerto) y se funden las bajadas iguales en una sola máscara.
+  - Al empezar el periodo se escribe port_mask entero con port_set: así un
+    canal que pasó de 100 % a 0 % baja ahí, sin evento propio.
+  - Si el motor va más de un periodo tarde (CPU saturado), no intenta
+    recuperar periodos viejos: re-ancla el periodo en "ahora" y cuenta un
+    overrun. La frecuencia real reportada muestra esa pérdida.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/prctl.h>
+#include "pwm.h"
+#include "gpio.h"
+#include "timeutil.h"
+
+int pwm_init(pwm_t *p, int nchan, long long period_ns){
+    memset(p, 0, sizeof(*p));
+    if (nchan < 1 || nchan > GPIO_PIN_MAX || period_ns < 1) {
+        return -1;
+    }
+    p->period_ns = period_ns;
+    p->nchan     = nchan;
+    p->pin       = malloc((size_t)nchan * sizeof(int));
+    p->duty      = calloc((size_t)nchan, sizeof(uint32_t));
+    p->duty_next = calloc((size_t)nchan, sizeof(uint32_t));
+    p->edges     = malloc((size_t)nchan * sizeof(pwm_edge_t));
+    if (p->pin == NULL || p->duty == NULL || p->duty_next == NULL || p->edges == NULL) {
+        pwm_free(p);
+        return -1;
+    }
+    for (int ch = 0; ch < nchan; ch++) {
+        p->pin[ch] = -1;
+    }
+    p->next    = -1;
+    p->t_start = -1; // arranca en el primer pwm_step
+    atomic_store(&p->pending, 1);
+    lat_hist_reset(&p->jitter);
+    return 0;
+}
+
+void pwm_free(pwm_t *p){
+    pwm_stop(p);
+    free(p->pin);
+    free(p->duty);
+    free((void *)p->duty_next);
+    free(p->edges);
+    p->pin = NULL;
+    p->duty = NULL;
+    p->duty_next = NULL;
+    p->edges = NULL;
+    p->nchan = 0;
+}
+
+int pwm_channel(pwm_t *p, int ch, int pin){
+    if (ch < 0 || ch >= p->nchan || pin < 0 || pin >= GPIO_PIN_MAX) {
+        return -1;
+    }
+    gpio_mode(pin, GPIO_OUTPUT);
+    gpio_write(pin, 0);
+    p->pin[ch] = pin;
+    atomic_store(&p->pending, 1);
+    return 0;
+}
+
+void pwm_set_duty(pwm_t *p, int ch, uint32_t duty){
+    if (ch < 0 || ch >= p->nchan) {
+        return;
+    }
+    atomic_store_explicit(&p->duty_next[ch], duty > PWM_DUTY_MAX ? PWM_DUTY_MAX : duty, memory_order_relaxed);
+    atomic_store_explicit(&p->pending, 1, memory_order_release);
+}
+
+static long long duty_to_ns(long long period_ns, uint32_t duty){
+    return (long long)(((unsigned __int128)period_ns * duty) >> 16);
+}
+
+long long pwm_high_ns(const pwm_t *p, int ch){
+    if (ch < 0 || ch >= p->nchan) {
+        return 0;
+    }
+    return duty_to_ns(p->period_ns, p->duty[ch]);
+}
+
+/*==========================================================
+=                 AGENDA DEL PERIODO (privada)             =
+==========================================================*/
+
+static int edge_cmp(const void *a, const void *b){
+    const pwm_edge_t *x = a, *y = b;
+    if (x->at != y->at) {
+        return (x->at > y->at) - (x->at < y->at);
+    }
+    return x->port - y->port;
+}
+
+// Toma los duty pedidos y arma la agenda ordenada: O(c log c)
+static void rebuild(pwm_t *p){
+    for (int k = 0; k < p->nports; k++) {
+        p->port_mask[p->ports[k]] = 0;
+        p->port_set[p->ports[k]]  = 0;
+    }
+    p->nports = 0;
+
+    int n = 0;
+    for (int ch = 0; ch < p->nchan; ch++) {
+        int pin = p->pin[ch];
+        if (pin < 0) {
+            continue;
+        }
+        int      port = GPIO_PORT_OF(pin);
+        uint64_t bit  = GPIO_BIT_OF(pin);
+        uint32_t d    = atomic_load_explicit(&p->duty_next[ch], memory_order_relaxed);
+        p->duty[ch] = d;
+
+        if (p->port_mask[port] == 0) {
+            p->ports[p->nports++] = port;
+        }
+        p->port_mask[port] |= bit;
+        if (d == 0) {
+            continue;              // no sube
+        }
+        p->port_set[port] |= bit;
+        if (d >= PWM_DUTY_MAX) {
+            continue;              // no baja
+        }
+        p->edges[n].at   = duty_to_ns(p->period_ns, d);
+        p->edges[n].port = port;
+        p->edges[n].mask = bit;
+        n++;
+    }
+    qsort(p->edges, (size_t)n, sizeof(pwm_edge_t), edge_cmp);
+
+    // fundir bajadas del mismo puerto en el mismo instante
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (m > 0 && p->edges[m - 1].at == p->edges[i].at && p->edges[m - 1].port == p->edges[i].port) {
+            p->edges[m - 1].mask |= p->edges[i].mask;
+        } else {
+            p->edges[m++] = p->edges[i];
+        }
+    }
+    p->nedges = m;
+    p->rebuilds++;
+}
+
+static void period_begin(pwm_t *p, long long t){
+    if (atomic_exchange_explicit(&p->pending, 0, memory_order_acquire)) {
+        rebuild(p);
+    }
+    for (int k = 0; k < p->nports; k++) {
+        int port = p->ports[k];
+        gpio_write_mask(port, p->port_mask[port], p->port_set[port]);
+    }
+    if (p->periods == 0) {
+        p->t_first = t;
+    }
+    p->periods++;
+    p->t_start = t;
+    p->next = 0;
+}
+
+/*==========================================================
+=                        API PÚBLICA                       =
+==========================================================*/
+
+long long pwm_step(pwm_t *p, long long now){
+    if (p->t_start < 0) {
+        p->t_start = now; // primer periodo: ya
+    }
+    for (;;) {
+        long long t = (p->next < 0) ? p->t_start : p->t_start + p->edges[p->next].at;
+        if (t > now) {
+            return t;
+        }
+        lat_hist_record(&p->jitter, (uint64_t)(now - t));
+        p->t_last = now;
+
+        if (p->next < 0) {
+            if (now - t >= p->period_ns) {
+                p->overruns += (uint64_t)((now - t) / p->period_ns);
+                t = now; // re-anclar: los periodos perdidos no se recuperan
+            }
+            period_begin(p, t);
+        } else {
+            const pwm_edge_t *e = &p->edges[p->next];
+            gpio_write_mask(e->port, e->mask, 0);
+            p->edge_writes++;
+            p->next++;
+        }
+        if (p->next >= p->nedges) {
+            p->next = -1;
+            p->t_start += p->period_ns; // próximo inicio
+        }
+    }
+}
+
+static long long thread_cpu_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void *pwm_thread(void *arg){
+    pwm_t *p = arg;
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0); // sin los 50 us de holgura por defecto al dormir
+    long long cpu0 = thread_cpu_ns();
+    long long next = pwm_step(p, now_ns());
+    while (!atomic_load_explicit(&p->stop, memory_order_relaxed)) {
+        if (next - p->spin_ns > now_ns()) {
+            sleep_until_ns(next - p->spin_ns);
+        }
+        while (now_ns() < next) {
+            // espera activa: los últimos spin_ns
+        }
+        next = pwm_step(p, now_ns());
+    }
+    p->cpu_ns = thread_cpu_ns() - cpu0;
+    return NULL;
+}
+
+int pwm_start(pwm_t *p, long long spin_ns){
+    if (p->running) {
+        return 0;
+    }
+    p->spin_ns = spin_ns < 0 ? 0 : spin_ns;
+    atomic_store(&p->stop, 0);
+    if (pthread_create(&p->thread, NULL, pwm_thread, p) != 0) {
+        return -1;
+    }
+    p->running = 1;
+    return 0;
+}
+
+void pwm_stop(pwm_t *p){
+    if (!p->running) {
+        return;
+    }
+    atomic_store(&p->stop, 1);
+    pthread_join(p->thread, NULL);
+    p->running = 0;
+}
+
+void pwm_stats(const pwm_t *p, pwm_stats_t *st){
+    // del primer inicio al fin del periodo en curso
+    long long end  = (p->next < 0) ? p->t_start : p->t_start + p->period_ns;
+    long long span = end - p->t_first;
+    memset(st, 0, sizeof(*st));
+    st->periods     = p->periods;
+    st->edge_writes = p->edge_writes;
+    st->rebuilds    = p->rebuilds;
+    st->overruns    = p->overruns;
+    st->hz_target   = 1e9 / (double)p->period_ns;
+    st->hz_real     = (p->periods > 0 && span > 0) ? 1e9 * (double)p->periods / (double)span : 0;
+    st->cpu_pct     = (p->cpu_ns > 0 && p->t_last > p->t_first)
+                    ? 100.0 * (double)p->cpu_ns / (double)(p->t_last - p->t_first) : 0;
+    st->jitter_p50  = lat_hist_percentile(&p->jitter, 50);
+    st->jitter_p99  = lat_hist_percentile(&p->jitter, 99);
+    st->jitter_max  = p->jitter.count ? p->jitter.max : 0;
+}
+
+void pwm_stats_reset(pwm_t *p){
+    p->periods     = 0;
+    p->edge_writes = 0;
+    p->rebuilds    = 0;
+    p->overruns    = 0;
+    lat_hist_reset(&p->jitter);
+}
@@ -0,0 +1,221 @@
+/*
+  pwm_load.c — Cuántos canales de PWM por software aguanta un núcleo
+
+  Para cada cantidad de canales (pines 0..N-1) arranca el motor de pwm.h en
+  su hilo, durante unos segundos cambia duties al azar desde el hilo
+  principal (como haría el firmware) y reporta:
+    - frecuencia pedida y lograda (periodos / tiempo real)
+    - periodos salteados por ir tarde (overruns)
+    - escrituras de bajada por segundo y agendas rearmadas
+    - jitter: atraso de cada flanco respecto de su instante (p50/p99/max)
+    - CPU del hilo del motor
+
+  Con -v corre además una verificación en tiempo VIRTUAL: después de cada
+  flanco lee los pines y comprueba que cada pulso en alto mida exactamente
+  el duty vigente de su periodo, aunque el duty cambie a mitad de periodo
+  (sin glitches).
+
+  Uso:
+    ./bin/pwm [-c canales,...] [-f hz] [-t segundos] [-s spin_us] [-u cambio_ms] [-v]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "gpio_err.h"
+#include "pwm.h"
+#include "timeutil.h"
+
+typedef struct{
+    int       chans[8];
+    int       nchans;
+    double    hz;
+    double    secs;
+    long long spin_ns;
+    long long update_ms;  // cada cuánto se cambian duties (0 = nunca)
+    int       verify;
+} pwm_opts_t;
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void){
+    // xorshift64*: rápido y reproducible
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+// duty al azar, sin 0 ni 100 % (esos no tienen flancos)
+static uint32_t rng_duty(void){
+    return 1u + (uint32_t)(rng_next() % (PWM_DUTY_MAX - 1));
+}
+
+/*==========================================================
+=                     CARGA (tiempo real)                  =
+==========================================================*/
+
+static int run_load(const pwm_opts_t *o, int nch){
+    pwm_t p;
+    if (gpio_init() != 0) {
+        return -1;
+    }
+    if (pwm_init(&p, nch, (long long)(1e9 / o->hz)) != 0) {
+        fprintf(stderr, "pwm: no se pudo crear el motor\n");
+        return -1;
+    }
+    for (int ch = 0; ch < nch; ch++) {
+        pwm_channel(&p, ch, ch);
+        pwm_set_duty(&p, ch, rng_duty());
+    }
+    if (pwm_start(&p, o->spin_ns) != 0) {
+        perror("pwm_start");
+        pwm_free(&p);
+        return -1;
+    }
+
+    // cambios de duty desde este hilo (registro sombra: el motor los toma al inicio del periodo)
+    long long t_end = now_ms() + (long long)(o->secs * 1000);
+    while (now_ms() < t_end) {
+        if (o->update_ms > 0) {
+            sleep_ms(o->update_ms);
+            for (int k = 0; k < 8; k++) {
+                pwm_set_duty(&p, (int)(rng_next() % (uint64_t)nch), rng_duty());
+            }
+        } else {
+            sleep_ms(t_end - now_ms());
+        }
+    }
+    pwm_stop(&p);
+
+    pwm_stats_t st;
+    pwm_stats(&p, &st);
+    double secs = st.hz_real > 0 ? (double)st.periods / st.hz_real : 0;
+    printf("%8d %10.0f %10.1f %9llu %12.0f %9llu %9.2f %9.2f %9.2f %7.1f\n",
+           nch, st.hz_target, st.hz_real, (unsigned long long)st.overruns,
+           secs > 0 ? (double)st.edge_writes / secs : 0, (unsigned long long)st.rebuilds,
+           st.jitter_p50 / 1e3, st.jitter_p99 / 1e3, st.jitter_max / 1e3, st.cpu_pct);
+    pwm_free(&p);
+    return 0;
+}
+
+/*==========================================================
+=               VERIFICACIÓN (tiempo virtual)              =
+==========================================================*/
+
+/* Cada pulso en alto debe medir el duty vigente de su periodo. Retorna
+   cuántos pulsos no coincidieron */
+static uint64_t run_verify(int nch, double hz, uint64_t periods){
+    pwm_t p;
+    vclock_enable(0);
+    if (gpio_init() != 0) {
+        return 1;
+    }
+    if (pwm_init(&p, nch, (long long)(1e9 / hz)) != 0) {
+        return 1;
+    }
+    int       *prev = calloc((size_t)nch, sizeof(int));
+    long long *rise = calloc((size_t)nch, sizeof(long long));
+    for (int ch = 0; ch < nch; ch++) {
+        pwm_channel(&p, ch, ch);
+        pwm_set_duty(&p, ch, rng_duty());
+    }
+
+    uint64_t pulses = 0, bad = 0;
+    long long next = pwm_step(&p, now_ns());
+    while (p.periods < periods) {
+        long long t = now_ns();
+        for (int ch = 0; ch < nch; ch++) {
+            int lv = gpio_read(ch);
+            if (lv && !prev[ch]) {
+                rise[ch] = t;
+            } else if (!lv && prev[ch]) {
+                pulses++;
+                bad += (t - rise[ch] != pwm_high_ns(&p, ch));
+            }
+            prev[ch] = lv;
+        }
+        // duties nuevos en cualquier momento, también a mitad de periodo
+        if (rng_next() % 4 == 0) {
+            pwm_set_duty(&p, (int)(rng_next() % (uint64_t)nch), rng_duty());
+        }
+        vclock_set_ns(next);
+        next = pwm_step(&p, now_ns());
+    }
+    printf("verificación: %d canales, %llu periodos, %llu pulsos, %llu agendas, %llu con ancho distinto al duty\n",
+           nch, (unsigned long long)p.periods, (unsigned long long)pulses,
+           (unsigned long long)p.rebuilds, (unsigned long long)bad);
+    free(prev);
+    free(rise);
+    pwm_free(&p);
+    time_source_set(NULL);
+    return bad;
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-c canales,...] [-f hz] [-t segundos] [-s spin_us] [-u cambio_ms] [-v]\n"
+            "  -c  cantidades de canales (por defecto 1,16,64,256,1024,4096)\n"
+            "  -f  frecuencia del PWM en Hz (por defecto 1000)\n"
+            "  -t  segundos por cantidad de canales (por defecto 1)\n"
+            "  -s  espera activa antes de cada flanco, en us (por defecto 50)\n"
+            "  -u  cada cuántos ms se cambian duties al azar (por defecto 10, 0 = nunca)\n"
+            "  -v  verificar anchos de pulso en tiempo virtual antes de medir\n", argv0);
+}
+
+int main(int argc, char **argv){
+    pwm_opts_t o = { .chans = { 1, 16, 64, 256, 1024, 4096 }, .nchans = 6, .hz = 1000, .secs = 1,
+                     .spin_ns = 50000, .update_ms = 10, .verify = 0 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strcmp(a, "-v") == 0) {
+            o.verify = 1;
+            continue;
+        }
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-c") == 0) {
+            o.nchans = 0;
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", v);
+            for (char *tok = strtok(buf, ","); tok != NULL && o.nchans < 8; tok = strtok(NULL, ",")) {
+                int n = atoi(tok);
+                if (n >= 1 && n <= GPIO_PIN_MAX) {
+                    o.chans[o.nchans++] = n;
+                }
+            }
+        } else if (strcmp(a, "-f") == 0) {
+            o.hz = atof(v);
+        } else if (strcmp(a, "-t") == 0) {
+            o.secs = atof(v);
+        } else if (strcmp(a, "-s") == 0) {
+            o.spin_ns = atoll(v) * 1000;
+        } else if (strcmp(a, "-u") == 0) {
+            o.update_ms = atoll(v);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.hz <= 0 || o.hz > 1e9 || o.nchans == 0) { usage(argv[0]); return 1; }
+
+    if (o.verify && run_verify(64, o.hz, 2000) != 0) {
+        return 1;
+    }
+
+    printf("%8s %10s %10s %9s %12s %9s %9s %9s %9s %7s\n",
+           "canales", "Hz pedido", "Hz real", "perdidos", "escrit./s", "agendas",
+           "jit p50us", "jit p99us", "jit maxus", "CPU %");
+    for (int k = 0; k < o.nchans; k++) {
+        if (run_load(&o, o.chans[k]) != 0) {
+            return 1;
+        }
+    }
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+    return 0;
+}
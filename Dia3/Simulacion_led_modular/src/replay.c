@@ -0,0 +1,303 @@
+/*
+  replay.c — Repite una traza grabada a través del firmware, sin terminal
+
+  Toma una traza de transiciones crudas (grabada con --record en
+  boton_switch / boton_toggle, ver trace.h) y la pasa por la misma pila que
+  el programa interactivo:
+
+      gpio_simulate_input -> "ISR" -> timer de muestreo -> debounce -> LED
+
+  con el reloj VIRTUAL (timeutil.h): no se duerme nunca, el reloj salta al
+  próximo vencimiento de timer o a la próxima transición de la traza. Así una
+  traza de horas se repite en lo que tarde el CPU, y siempre da lo mismo.
+
+  - una instancia de app (app.h) por cada pin de entrada de la traza, con su
+    LED en un pin libre (se asignan desde el último pin hacia abajo)
+  - "firma": hash de cada cambio de LED (instante, pin, nivel). Dos corridas
+    con la misma traza y parámetros deben dar la misma firma (regresión).
+
+  Uso:
+    ./bin/replay [-m switch|toggle] [-d debounce_ms] [-p poll_ms] [-a algoritmo] [-x veces] [-v] [-l]
+                 [-V ondas.vcd] TRAZA
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "gpio_err.h"
+#include "app.h"
+#include "timeutil.h"
+#include "timer.h"
+#include "latency.h"
+#include "trace.h"
+#include "vcd.h"
+
+typedef struct{
+    app_mode_t  mode;
+    long long   debounce_ms;
+    int         poll_ms;
+    int         algo;     // debounce_algo_t (debounce.h)
+    int         repeat;   // cuántas veces se repite la traza
+    int         verbose;  // imprimir cada cambio de LED
+    int         lat_all;  // imprimir la latencia aunque haya muchos pines
+    const char *path;
+    const char *vcd_path; // volcado VCD de entradas y LEDs (NULL = no)
+} replay_opts_t;
+
+static app_t    *apps;                  // una por pin de entrada
+static int       napps;
+static uint64_t  signature = 0xcbf29ce484222325ULL; // FNV-1a
+static int       verbose;
+
+/*==========================================================
+=                     APLICACIÓN                           =
+==========================================================*/
+
+static void fnv_mix(uint64_t v){
+    for (int i = 0; i < 8; i++) {
+        signature ^= (v >> (8 * i)) & 0xff;
+        signature *= 0x100000001b3ULL;
+    }
+}
+
+static void on_led(app_t *a, int led){
+    long long t = now_ns();
+    fnv_mix((uint64_t)t);
+    fnv_mix(((uint64_t)a->out_pin << 1) | (uint64_t)led);
+    if (verbose) {
+        printf("%lld.%06lld ms  pin %d -> LED %d = %d\n",
+               t / 1000000, t % 1000000, a->in_pin, a->out_pin, led);
+    }
+}
+
+/*
+   Crea una app por cada pin de entrada que aparece en la traza.
+   Los LEDs van en pines que la traza no usa, desde el último hacia abajo.
+*/
+static int setup_apps(trace_reader_t *r, const replay_opts_t *o){
+    static uint8_t used[GPIO_PIN_MAX];
+    long long t;
+    int pin, value;
+
+    memset(used, 0, sizeof(used));
+    napps = 0;
+    trace_reader_rewind(r);
+    while (trace_reader_next(r, &t, &pin, &value)) {
+        if (pin >= GPIO_PIN_MAX) {
+            fprintf(stderr, "replay: pin %d fuera de rango\n", pin);
+            return -1;
+        }
+        if (!used[pin]) {
+            used[pin] = 1;
+            napps++;
+        }
+    }
+    trace_reader_rewind(r);
+    if (napps * 2 > GPIO_PIN_MAX) {
+        fprintf(stderr, "replay: %d pines de entrada, no quedan pines para los LEDs\n", napps);
+        return -1;
+    }
+
+    apps = calloc((size_t)(napps > 0 ? napps : 1), sizeof(*apps));
+    if (apps == NULL) {
+        return -1;
+    }
+    int out = GPIO_PIN_MAX - 1;
+    int k = 0;
+    for (int in = 0; in < GPIO_PIN_MAX; in++) {
+        if (used[in] != 1) {
+            continue; // libre o ya tomado por un LED
+        }
+        while (used[out]) {
+            out--;
+        }
+        used[out] = 2;
+        if (app_init(&apps[k], o->mode, in, out, o->poll_ms, o->debounce_ms, on_led, NULL) != 0) {
+            return -1;
+        }
+        if (app_set_algo(&apps[k], (debounce_algo_t)o->algo) != 0) {
+            return -1;
+        }
+        k++;
+        out--;
+    }
+    return 0;
+}
+
+// VCD con los pares entrada/LED de todas las instancias: "inN" y "ledN"
+static int open_vcd(const char *path){
+    int   *pins  = malloc(sizeof(int) * 2 * (size_t)(napps > 0 ? napps : 1));
+    char **names = malloc(sizeof(char *) * 2 * (size_t)(napps > 0 ? napps : 1));
+    char  *text  = malloc(16 * 2 * (size_t)(napps > 0 ? napps : 1));
+    int rc = -1;
+    if (pins != NULL && names != NULL && text != NULL) {
+        for (int k = 0; k < napps; k++) {
+            pins[2 * k]      = apps[k].in_pin;
+            pins[2 * k + 1]  = apps[k].out_pin;
+            names[2 * k]     = text + 32 * k;
+            names[2 * k + 1] = text + 32 * k + 16;
+            snprintf(names[2 * k], 16, "in%d", apps[k].in_pin);
+            snprintf(names[2 * k + 1], 16, "led%d", apps[k].in_pin);
+        }
+        rc = vcd_open(path, pins, (const char *const *)names, 2 * napps);
+    }
+    free(pins);
+    free(names);
+    free(text);
+    return rc;
+}
+
+/*==========================================================
+=                        MAIN                              =
+==========================================================*/
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-m switch|toggle] [-d debounce_ms] [-p poll_ms] [-a algoritmo] [-x veces] [-v] [-l]\n"
+            "          [-V ondas.vcd] TRAZA\n"
+            "  -m  lógica de la app (por defecto switch)\n"
+            "  -d  ventana de debounce en ms (por defecto 50)\n"
+            "  -p  periodo de muestreo en ms (por defecto 5)\n"
+            "  -a  debounce: timer|integrator|shift8|shift16|shift32 (por defecto timer)\n"
+            "  -x  repetir la traza N veces seguidas (por defecto 1)\n"
+            "  -v  imprimir cada cambio de LED\n"
+            "  -l  latencia de todos los pines (por defecto solo si son <= 16)\n"
+            "  -V  volcar entradas y LEDs en formato VCD (tiempo simulado)\n", argv0);
+}
+
+int main(int argc, char **argv){
+    replay_opts_t o = { .mode = APP_SWITCH, .debounce_ms = 50, .poll_ms = 5, .algo = DEBOUNCE_TIMER,
+                        .repeat = 1, .verbose = 0, .lat_all = 0, .path = NULL, .vcd_path = NULL };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strcmp(a, "-v") == 0) {
+            o.verbose = 1;
+            continue;
+        }
+        if (strcmp(a, "-l") == 0) {
+            o.lat_all = 1;
+            continue;
+        }
+        if (a[0] != '-') {
+            o.path = a;
+            continue;
+        }
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-m") == 0) {
+            o.mode = strcmp(v, "toggle") == 0 ? APP_TOGGLE : APP_SWITCH;
+        } else if (strcmp(a, "-d") == 0) {
+            o.debounce_ms = atoll(v);
+        } else if (strcmp(a, "-p") == 0) {
+            o.poll_ms = atoi(v);
+        } else if (strcmp(a, "-a") == 0) {
+            if ((o.algo = debounce_algo_parse(v)) < 0) { usage(argv[0]); return 1; }
+        } else if (strcmp(a, "-x") == 0) {
+            o.repeat = atoi(v);
+        } else if (strcmp(a, "-V") == 0) {
+            o.vcd_path = v;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.path == NULL) { usage(argv[0]); return 1; }
+    if (o.repeat < 1) o.repeat = 1;
+    if (o.poll_ms < 1) o.poll_ms = 1;
+    verbose = o.verbose;
+
+    trace_reader_t r;
+    if (trace_reader_open(&r, o.path) != 0) {
+        fprintf(stderr, "replay: %s no es una traza válida\n", o.path);
+        return 1;
+    }
+
+    // reloj virtual desde el inicio de la traza: los instantes coinciden con la grabación
+    long long t0 = r.hdr->t0_ns;
+    vclock_enable(t0 / 1000000);
+    vclock_set_ns(t0);
+    tick_update();
+    if (gpio_init() != 0) {
+        trace_reader_close(&r);
+        return 1;
+    }
+    timer_service_init();
+    if (setup_apps(&r, &o) != 0) {
+        trace_reader_close(&r);
+        return 1;
+    }
+
+    if (o.vcd_path != NULL && open_vcd(o.vcd_path) != 0) {
+        perror(o.vcd_path);
+        trace_reader_close(&r);
+        return 1;
+    }
+
+    long long wall0 = TIME_SOURCE_REAL.now_ns();
+    uint64_t  transitions = 0, fired = 0;
+    long long offset = 0, t = t0, last = t0;
+    int       pin, value;
+
+    for (int rep = 0; rep < o.repeat; rep++) {
+        trace_reader_rewind(&r);
+        while (trace_reader_next(&r, &t, &pin, &value)) {
+            fired += (uint64_t)timer_vclock_run_until(t + offset);
+            gpio_simulate_input(pin, value);
+            transitions++;
+            last = t + offset;
+        }
+        // dejar que todo se asiente (los timers de muestreo se paran solos;
+        // los algoritmos por muestras pueden necesitar hasta 32 muestreos)
+        long long settle_ms = o.debounce_ms + 2LL * o.poll_ms;
+        if (o.algo != DEBOUNCE_TIMER && settle_ms < 34LL * o.poll_ms) {
+            settle_ms = 34LL * o.poll_ms;
+        }
+        fired += (uint64_t)timer_vclock_run_until(last + settle_ms * 1000000LL);
+        // la próxima vuelta arranca un segundo después, para no pisar la anterior
+        offset = now_ns() + 1000000000LL - t0;
+    }
+    long long wall = TIME_SOURCE_REAL.now_ns() - wall0;
+
+    if (vcd_active) {
+        vcd_stats_t st;
+        vcd_close();
+        vcd_stats(&st);
+        printf("VCD: %llu cambios en %s (%llu perdidos)\n",
+               (unsigned long long)st.changes, o.vcd_path, (unsigned long long)st.dropped);
+    }
+
+    uint64_t led_changes = 0;
+    for (int k = 0; k < napps; k++) {
+        led_changes += apps[k].led_changes;
+    }
+    double secs = wall > 0 ? wall / 1e9 : 1e-9;
+    long long sim = now_ns() - t0;
+
+    printf("Traza: %s (%llu registros)\n", o.path, (unsigned long long)r.hdr->count);
+    printf("Modo: %s  debounce %lld ms (%s)  muestreo %d ms  x%d\n",
+           o.mode == APP_SWITCH ? "switch" : "toggle", o.debounce_ms, debounce_algo_name[o.algo],
+           o.poll_ms, o.repeat);
+    printf("Pines de entrada: %d\n", napps);
+    printf("Transiciones: %llu  muestreos: %llu  cambios de LED: %llu\n",
+           (unsigned long long)transitions, (unsigned long long)fired,
+           (unsigned long long)led_changes);
+    printf("Tiempo simulado: %.3f s  real: %.3f s  (x%.0f)\n",
+           sim / 1e9, secs, sim / 1e9 / secs);
+    printf("Velocidad: %.2f M transiciones/s\n", transitions / secs / 1e6);
+    printf("Firma: %016llx\n", (unsigned long long)signature);
+    if (o.lat_all || napps <= 16) {
+        latency_dump(stdout);
+    } else {
+        printf("(%d pines: latencia por pin con -l)\n", napps);
+    }
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+
+    free(apps);
+    trace_reader_close(&r);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+    spi_dev.c — Esclavos SPI simulados (ver spi_dev.h)
+
+    Los dos trabajan sobre los buffers del maestro que les pasa spi_sim.c:
+    los datos salen de regs[] / del guion directo a rx (un memcpy por tramo),
+    sin buffers intermedios.
+*/
+
+#include <string.h>
+#include "spi_dev.h"
+
+/*==========================================================
+=                 SENSOR CON MAPA DE REGISTROS             =
+==========================================================*/
+
+static void regdev_select(void *ctx){
+    spi_regdev_t *d = ctx;
+    d->have_cmd = 0;
+    d->selects++;
+    if (d->sample != NULL) {
+        d->sample(d, d->arg);
+    }
+}
+
+static void regdev_xfer(void *ctx, const uint8_t *mosi, uint8_t *miso, size_t len){
+    spi_regdev_t *d = ctx;
+    size_t i = 0;
+    if (!d->have_cmd) {
+        uint8_t cmd = mosi ? mosi[0] : 0xFF;
+        d->reading  = (cmd & SPI_REGDEV_READ) != 0;
+        d->addr     = cmd & (SPI_REGDEV_REGS - 1);
+        d->have_cmd = 1;
+        if (miso != NULL) {
+            miso[0] = 0x00;
+        }
+        i = 1;
+    }
+    while (i < len) {
+        // tramo contiguo hasta el final del mapa (el auto-incremento da la vuelta)
+        size_t seg = SPI_REGDEV_REGS - d->addr;
+        if (seg > len - i) {
+            seg = len - i;
+        }
+        if (d->reading) {
+            if (miso != NULL) {
+                memcpy(miso + i, &d->regs[d->addr], seg);
+            }
+        } else {
+            if (mosi != NULL) {
+                memcpy(&d->regs[d->addr], mosi + i, seg);
+            } else {
+                memset(&d->regs[d->addr], 0xFF, seg);
+            }
+            if (miso != NULL) {
+                memset(miso + i, 0x00, seg);
+            }
+            d->writes += seg;
+        }
+        d->addr = (uint8_t)((d->addr + seg) & (SPI_REGDEV_REGS - 1));
+        i += seg;
+    }
+}
+
+void spi_regdev_init(spi_regdev_t *d){
+    memset(d, 0, sizeof(*d));
+}
+
+spi_slave_t spi_regdev_slave(spi_regdev_t *d){
+    spi_slave_t s = { .select = regdev_select, .xfer = regdev_xfer, .deselect = NULL, .ctx = d };
+    return s;
+}
+
+/*==========================================================
+=                       ESCLAVO CON GUION                  =
+==========================================================*/
+
+static void script_select(void *ctx){
+    spi_script_t *s = ctx;
+    s->off = 0;
+    s->step_bad = 0;
+    if (s->step >= s->nsteps) {
+        s->overruns++;
+    }
+}
+
+static void script_xfer(void *ctx, const uint8_t *mosi, uint8_t *miso, size_t len){
+    spi_script_t *s = ctx;
+    if (s->step >= s->nsteps) {
+        if (miso != NULL) {
+            memset(miso, 0x00, len);
+        }
+        return;
+    }
+    const spi_script_step_t *st = &s->steps[s->step];
+    size_t n = (s->off < st->len) ? st->len - s->off : 0;
+    if (n > len) {
+        n = len;
+    }
+    if (n < len) {
+        s->step_bad = 1; // el maestro mandó más de lo que dice el guion
+    }
+    if (st->expect != NULL && n > 0) {
+        if (mosi != NULL) {
+            s->step_bad |= memcmp(mosi, st->expect + s->off, n) != 0;
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                s->step_bad |= st->expect[s->off + i] != 0xFF; // tx NULL = 0xFF
+            }
+        }
+    }
+    if (miso != NULL) {
+        if (st->reply != NULL) {
+            memcpy(miso, st->reply + s->off, n);
+        } else {
+            memset(miso, 0x00, n);
+        }
+        memset(miso + n, 0x00, len - n);
+    }
+    s->off += n;
+}
+
+static void script_deselect(void *ctx){
+    spi_script_t *s = ctx;
+    if (s->step >= s->nsteps) {
+        return;
+    }
+    if (s->step_bad || s->off != s->steps[s->step].len) {
+        s->mismatches++;
+    }
+    s->step++;
+}
+
+void spi_script_init(spi_script_t *s, const spi_script_step_t *steps, size_t nsteps){
+    memset(s, 0, sizeof(*s));
+    s->steps  = steps;
+    s->nsteps = nsteps;
+}
+
+spi_slave_t spi_script_slave(spi_script_t *s){
+    spi_slave_t sl = { .select = script_select, .xfer = script_xfer, .deselect = script_deselect, .ctx = s };
+    return sl;
+}
+
+int spi_script_done(const spi_script_t *s){
+    return s->step == s->nsteps && s->mismatches == 0 && s->overruns == 0;
+}
@@ -0,0 +1,215 @@
+/*
+  spi_load.c — Cuántos sensores SPI se leen por tick y cuánto cuesta cada uno
+
+  1) Prueba del protocolo con spi_script_t: escribe un registro de control y
+     lee el WHO_AM_I contra un guion byte a byte.
+  2) Para cada cantidad de sensores (spi_regdev_t en CS consecutivos desde
+     PIN_SPI_CS0), en tiempo VIRTUAL: cada tick encola con UN
+     spi_submit_batch() la lectura de x/y/z (comando + 6 bytes) de todos los
+     sensores, espera a que terminen y verifica cada muestra. Reporta:
+       - tiempo de bus por tick y ocupación del periodo
+       - costo fijo por transacción (CS setup/hold/gap) sobre el tiempo de bus
+       - espera máxima en cola y ticks que no entraron en su periodo
+       - costo de software (encolar + completar) por transacción, en reloj real
+
+  Uso:
+    ./bin/spi [-n sensores,...] [-c MHz] [-p periodo_us] [-k ticks]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "pins.h"
+#include "spi.h"
+#include "spi_dev.h"
+#include "timeutil.h"
+
+#define SENSOR_WHO_AM_I  0x0F
+#define SENSOR_CTRL      0x20
+#define SENSOR_OUT_X     0x28 // x, y, z de 16 bits (little endian) desde acá
+#define SENSOR_OUT_LEN   6
+#define SENSOR_MAX       56   // CS en PIN_SPI_CS0 .. PIN_SPI_CS0 + 55 (mismo puerto)
+
+typedef struct{
+    int       counts[8];
+    int       ncounts;
+    double    mhz;
+    long long period_ns;
+    long long ticks;
+} spi_opts_t;
+
+/*==========================================================
+=                    PRUEBA DEL PROTOCOLO                  =
+==========================================================*/
+
+static int run_script_check(void){
+    static const uint8_t w_tx[]  = { SENSOR_CTRL, 0x57 };
+    static const uint8_t r_tx[]  = { SPI_REGDEV_READ | SENSOR_WHO_AM_I, 0xFF };
+    static const uint8_t r_rep[] = { 0x00, 0x33 };
+    static const spi_script_step_t steps[] = {
+        { w_tx, NULL,  sizeof(w_tx) },
+        { r_tx, r_rep, sizeof(r_tx) },
+    };
+    spi_script_t sc;
+    spi_script_init(&sc, steps, sizeof(steps) / sizeof(steps[0]));
+    spi_slave_t sl = spi_script_slave(&sc);
+    spi_cfg_t cfg = { .hz = 1000000, .cs_setup_ns = 100, .cs_hold_ns = 100, .gap_ns = 100 };
+    if (spi_init(1, &cfg) != 0 || spi_attach(1, PIN_SPI_CS0, &sl) != 0) {
+        return -1;
+    }
+
+    uint8_t rx[2];
+    spi_xfer_t w = { .tx = w_tx, .rx = NULL, .len = sizeof(w_tx), .cs = PIN_SPI_CS0 };
+    spi_xfer_t r = { .tx = r_tx, .rx = rx,   .len = sizeof(r_tx), .cs = PIN_SPI_CS0 };
+    spi_transfer(1, &w);
+    spi_transfer(1, &r);
+    spi_deinit(1);
+
+    int ok = spi_script_done(&sc) && rx[1] == 0x33 && gpio_read(PIN_SPI_CS0) == 1;
+    printf("guion: %zu/%zu pasos, %llu distintos, WHO_AM_I = 0x%02X, CS %s -> %s\n",
+           sc.step, sc.nsteps, (unsigned long long)sc.mismatches, rx[1],
+           gpio_read(PIN_SPI_CS0) ? "alto" : "bajo", ok ? "ok" : "FALLA");
+    return ok ? 0 : -1;
+}
+
+/*==========================================================
+=                  LECTURA POR LOTES (virtual)             =
+==========================================================*/
+
+// "medición" del sensor: depende de cuántas veces se lo leyó, para verificarla
+static void sensor_sample(spi_regdev_t *d, void *arg){
+    uint16_t base = (uint16_t)(d->selects * 3u + (uintptr_t)arg);
+    for (int k = 0; k < 3; k++) {
+        uint16_t v = (uint16_t)(base + k);
+        d->regs[SENSOR_OUT_X + 2 * k]     = (uint8_t)v;
+        d->regs[SENSOR_OUT_X + 2 * k + 1] = (uint8_t)(v >> 8);
+    }
+}
+
+static int run_batch(const spi_opts_t *o, int n){
+    static const uint8_t cmd[1 + SENSOR_OUT_LEN] = { SPI_REGDEV_READ | SENSOR_OUT_X };
+    spi_regdev_t dev[SENSOR_MAX];
+    spi_xfer_t   xs[SENSOR_MAX];
+    uint8_t      rx[SENSOR_MAX][1 + SENSOR_OUT_LEN];
+
+    spi_cfg_t cfg = { .hz = (uint32_t)(o->mhz * 1e6), .cs_setup_ns = 50, .cs_hold_ns = 50, .gap_ns = 100 };
+    if (spi_init(0, &cfg) != 0) {
+        fprintf(stderr, "spi: reloj no válido\n");
+        return -1;
+    }
+    for (int k = 0; k < n; k++) {
+        spi_regdev_init(&dev[k]);
+        dev[k].sample = sensor_sample;
+        dev[k].arg    = (void *)(uintptr_t)(k * 1000);
+        spi_slave_t sl = spi_regdev_slave(&dev[k]);
+        spi_attach(0, PIN_SPI_CS0 + k, &sl);
+        xs[k] = (spi_xfer_t){ .tx = cmd, .rx = rx[k], .len = sizeof(cmd), .cs = PIN_SPI_CS0 + k };
+    }
+
+    uint64_t bad = 0, late = 0;
+    long long sw_ns = 0;
+    long long t_tick = now_ns();
+    for (long long t = 0; t < o->ticks; t++) {
+        long long r0 = TIME_SOURCE_REAL.now_ns();
+        spi_submit_batch(0, xs, (size_t)n);
+        sw_ns += TIME_SOURCE_REAL.now_ns() - r0;
+        while (xs[n - 1].status != SPI_XFER_DONE) {
+            sleep_until_ns(spi_next_ns());
+            r0 = TIME_SOURCE_REAL.now_ns();
+            spi_poll();
+            sw_ns += TIME_SOURCE_REAL.now_ns() - r0;
+        }
+        for (int k = 0; k < n; k++) {
+            uint16_t base = (uint16_t)((t + 1) * 3 + k * 1000);
+            for (int a = 0; a < 3; a++) {
+                uint16_t v = (uint16_t)(rx[k][1 + 2 * a] | (rx[k][2 + 2 * a] << 8));
+                bad += (v != (uint16_t)(base + a));
+            }
+        }
+        t_tick += o->period_ns;
+        if (now_ns() > t_tick) {
+            late++;               // el lote no entró en el periodo
+            t_tick = now_ns();
+        }
+        sleep_until_ns(t_tick);
+    }
+
+    spi_stats_t st;
+    spi_stats(0, &st);
+    spi_deinit(0);
+    double per_tick = (double)st.busy_ns / (double)o->ticks;
+    printf("%9d %10.1f %9zu %11.2f %9.1f %10.1f %11.2f %9llu %9.0f %6llu\n",
+           n, o->mhz, (size_t)n * sizeof(cmd), per_tick / 1e3, 100.0 * per_tick / (double)o->period_ns,
+           100.0 * st.overhead, st.wait_max_ns / 1e3, (unsigned long long)late,
+           (double)sw_ns / (double)st.xfers, (unsigned long long)bad);
+    return bad != 0;
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-n sensores,...] [-c MHz] [-p periodo_us] [-k ticks]\n"
+            "  -n  cantidades de sensores, hasta %d (por defecto 1,8,32,56)\n"
+            "  -c  reloj SCK en MHz (por defecto 10)\n"
+            "  -p  periodo del tick en us (por defecto 1000)\n"
+            "  -k  ticks por cantidad de sensores (por defecto 10000)\n", argv0, SENSOR_MAX);
+}
+
+int main(int argc, char **argv){
+    spi_opts_t o = { .counts = { 1, 8, 32, 56 }, .ncounts = 4, .mhz = 10, .period_ns = 1000000,
+                     .ticks = 10000 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-n") == 0) {
+            o.ncounts = 0;
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", v);
+            for (char *tok = strtok(buf, ","); tok != NULL && o.ncounts < 8; tok = strtok(NULL, ",")) {
+                int n = atoi(tok);
+                if (n >= 1 && n <= SENSOR_MAX) {
+                    o.counts[o.ncounts++] = n;
+                }
+            }
+        } else if (strcmp(a, "-c") == 0) {
+            o.mhz = atof(v);
+        } else if (strcmp(a, "-p") == 0) {
+            o.period_ns = atoll(v) * 1000;
+        } else if (strcmp(a, "-k") == 0) {
+            o.ticks = atoll(v);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.ncounts == 0 || o.mhz <= 0 || o.mhz > 4000 || o.period_ns <= 0 || o.ticks <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vclock_enable(0);
+    if (gpio_init() != 0) {
+        return 1;
+    }
+    if (run_script_check() != 0) {
+        return 1;
+    }
+
+    printf("%9s %10s %9s %11s %9s %10s %11s %9s %9s %6s\n",
+           "sensores", "SCK MHz", "bytes/tk", "bus us/tk", "ocup. %", "fijo %",
+           "espera us", "tarde", "sw ns/tr", "malos");
+    int rc = 0;
+    for (int k = 0; k < o.ncounts; k++) {
+        int r = run_batch(&o, o.counts[k]);
+        if (r < 0) {
+            return 1;
+        }
+        rc |= r;
+    }
+    time_source_set(NULL);
+    return rc;
+}
@@ -0,0 +1,307 @@
+/*
+    spi_sim.c — BUS SPI SIMULADO (implementación de spi.h)
+
+    - cola por bus: lista enlazada por los mismos descriptores (x->next), sin
+      reservar memoria ni copiar datos
+    - el horario se calcula al encolar: cada transacción empieza cuando el
+      bus queda libre (+ gap) y dura cs_setup + bits + cs_hold. Así encolar
+      es O(1) y spi_next_ns() es leer la cabeza
+    - spi_poll() completa en orden las que ya terminaron: el esclavo recibe
+      los punteros del maestro (cero copias) y CS se mueve con gpio_write()
+    - esclavos: tabla directa pin -> esclavo (un acceso por transacción);
+      desconectar libera la ranura (xfer == NULL) y la reusa el próximo attach
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "spi.h"
+#include "gpio.h"
+#include "timeutil.h"
+
+#define SPI_SLAVE_MAX 64 // esclavos por bus
+
+typedef struct{
+    int          used;
+    spi_cfg_t    cfg;
+    spi_xfer_t  *head, *tail;     // cola
+    long long    bus_free;        // fin de la última transacción agendada
+    int          cs_hold_pin;     // CS que quedó bajo por keep_cs (-1 = ninguno)
+
+    spi_slave_t  slaves[SPI_SLAVE_MAX]; // xfer == NULL = ranura libre
+    int          nslaves;             // ranuras usadas alguna vez (las libres se reusan)
+    int8_t      *slot_of;         // pin -> índice en slaves (-1 = nada)
+
+    // estadísticas
+    uint64_t     xfers, bytes, batches;
+    long long    busy_ns, wire_ns, wait_max_ns;
+    long long    t_first, t_last;
+} spi_bus_t;
+
+static spi_bus_t buses[SPI_COUNT];
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static int spi_is_valid(int bus){
+    return bus >= 0 && bus < SPI_COUNT && buses[bus].used;
+}
+
+static long long wire_time(const spi_bus_t *B, size_t len){
+    return (long long)((unsigned __int128)len * 8u * 1000000000ULL / B->cfg.hz);
+}
+
+// Agenda x detrás de lo ya encolado
+static void schedule(spi_bus_t *B, spi_xfer_t *x, spi_xfer_t *prev, long long now){
+    long long start;
+    long long setup = B->cfg.cs_setup_ns;
+    // CS que va a estar bajo cuando le toque a x (keep_cs de la anterior)
+    int held = (prev != NULL) ? (prev->keep_cs ? prev->cs : -1) : B->cs_hold_pin;
+    if (held == x->cs) {
+        start = B->bus_free;      // CS sigue bajo: continúa sin setup ni gap
+        setup = 0;
+    } else if (held >= 0) {
+        // otro esclavo sigue seleccionado: primero se suelta su CS (hold + gap)
+        start = (B->bus_free > now ? B->bus_free : now) + B->cfg.cs_hold_ns + B->cfg.gap_ns;
+    } else {
+        start = B->bus_free + B->cfg.gap_ns;
+    }
+    if (start < now) {
+        start = now; // bus ocioso; con CS todavía bajo (held == x->cs) sigue sin setup
+    }
+    long long wire = wire_time(B, x->len);
+    long long dur  = setup + wire + (x->keep_cs ? 0 : B->cfg.cs_hold_ns);
+
+    x->t_queued = now;
+    x->t_start  = start;
+    x->t_end    = start + dur;
+    x->status   = SPI_XFER_QUEUED;
+    x->next     = NULL;
+    B->bus_free = x->t_end;
+    if (start - now > B->wait_max_ns) {
+        B->wait_max_ns = start - now;
+    }
+}
+
+static void complete(spi_bus_t *B, spi_xfer_t *x){
+    int8_t k = B->slot_of[x->cs];
+    const spi_slave_t *s = (k >= 0) ? &B->slaves[k] : NULL;
+
+    if (B->cs_hold_pin >= 0 && B->cs_hold_pin != x->cs) {
+        // el CS que quedó bajo por keep_cs es de otro esclavo: soltarlo antes
+        int8_t h = B->slot_of[B->cs_hold_pin];
+        if (h >= 0 && B->slaves[h].deselect != NULL) {
+            B->slaves[h].deselect(B->slaves[h].ctx);
+        }
+        gpio_write(B->cs_hold_pin, 1);
+        B->cs_hold_pin = -1;
+    }
+    if (B->cs_hold_pin != x->cs) {
+        gpio_write(x->cs, 0);
+        if (s != NULL && s->select != NULL) {
+            s->select(s->ctx);
+        }
+    }
+    if (s != NULL) {
+        s->xfer(s->ctx, x->tx, x->rx, x->len);
+    } else if (x->rx != NULL) {
+        memset(x->rx, 0xFF, x->len); // nadie contesta: MISO con pull-up
+    }
+    if (x->keep_cs) {
+        B->cs_hold_pin = x->cs;
+    } else {
+        B->cs_hold_pin = -1;
+        if (s != NULL && s->deselect != NULL) {
+            s->deselect(s->ctx);
+        }
+        gpio_write(x->cs, 1);
+    }
+    if (B->xfers == 0) {
+        B->t_first = x->t_start;
+    }
+    B->xfers++;
+    B->bytes   += x->len;
+    B->busy_ns += x->t_end - x->t_start;
+    B->wire_ns += wire_time(B, x->len);
+    B->t_last = x->t_end;
+    x->status = SPI_XFER_DONE;
+}
+
+static int xfer_ok(const spi_xfer_t *x){
+    return x != NULL && x->status != SPI_XFER_QUEUED && x->len > 0 &&
+           x->cs >= 0 && x->cs < GPIO_PIN_MAX;
+}
+
+/*==========================================================
+=                    API PÚBLICA (spi.h)                   =
+==========================================================*/
+
+int spi_init(int bus, const spi_cfg_t *cfg){
+    if (bus < 0 || bus >= SPI_COUNT || buses[bus].used || cfg->hz == 0) {
+        return -1;
+    }
+    spi_bus_t *B = &buses[bus];
+    memset(B, 0, sizeof(*B));
+    B->slot_of = malloc(GPIO_PIN_MAX);
+    if (B->slot_of == NULL) {
+        return -1;
+    }
+    memset(B->slot_of, -1, GPIO_PIN_MAX);
+    B->cfg = *cfg;
+    B->cs_hold_pin = -1;
+    B->bus_free = now_ns();
+    B->used = 1;
+    return 0;
+}
+
+void spi_deinit(int bus){
+    if (!spi_is_valid(bus)) {
+        return;
+    }
+    spi_bus_t *B = &buses[bus];
+    for (spi_xfer_t *x = B->head; x != NULL; x = x->next) {
+        x->status = SPI_XFER_IDLE; // abortadas: quien llama puede reusarlas
+    }
+    free(B->slot_of);
+    memset(B, 0, sizeof(*B));
+}
+
+int spi_attach(int bus, int cs, const spi_slave_t *slave){
+    if (!spi_is_valid(bus) || cs < 0 || cs >= GPIO_PIN_MAX) {
+        return -1;
+    }
+    spi_bus_t *B = &buses[bus];
+    int k = B->slot_of[cs];
+    if (slave == NULL) {
+        if (k >= 0) {
+            memset(&B->slaves[k], 0, sizeof(B->slaves[k])); // ranura libre
+            B->slot_of[cs] = -1;
+            while (B->nslaves > 0 && B->slaves[B->nslaves - 1].xfer == NULL) {
+                B->nslaves--;
+            }
+        }
+        return 0;
+    }
+    if (slave->xfer == NULL) {
+        return -1;
+    }
+    if (k < 0) {
+        k = 0;
+        while (k < B->nslaves && B->slaves[k].xfer != NULL) {
+            k++; // primera ranura libre (de un esclavo desconectado) o una nueva al final
+        }
+        if (k == SPI_SLAVE_MAX) {
+            return -1;
+        }
+        if (k == B->nslaves) {
+            B->nslaves++;
+        }
+        B->slot_of[cs] = (int8_t)k;
+    }
+    B->slaves[k] = *slave;
+    gpio_mode(cs, GPIO_OUTPUT);
+    gpio_write(cs, 1);
+    return 0;
+}
+
+int spi_submit(int bus, spi_xfer_t *x){
+    return spi_submit_batch(bus, x, 1);
+}
+
+int spi_submit_batch(int bus, spi_xfer_t *xs, size_t n){
+    if (!spi_is_valid(bus) || n == 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!xfer_ok(&xs[i])) {
+            return -1;
+        }
+    }
+    spi_bus_t *B = &buses[bus];
+    long long now = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        schedule(B, &xs[i], B->tail, now);
+        if (B->tail != NULL) {
+            B->tail->next = &xs[i];
+        } else {
+            B->head = &xs[i];
+        }
+        B->tail = &xs[i];
+    }
+    B->batches++;
+    return 0;
+}
+
+int spi_poll(void){
+    int done = 0;
+    long long now = now_ns();
+    for (int b = 0; b < SPI_COUNT; b++) {
+        spi_bus_t *B = &buses[b];
+        if (!B->used) {
+            continue;
+        }
+        while (B->head != NULL && B->head->t_end <= now) {
+            spi_xfer_t *x = B->head;
+            B->head = x->next;
+            if (B->head == NULL) {
+                B->tail = NULL;
+            }
+            x->next = NULL;
+            complete(B, x);
+            done++;
+            if (x->done != NULL) {
+                x->done(x, x->arg); // puede encolar más
+            }
+        }
+    }
+    return done;
+}
+
+long long spi_next_ns(void){
+    long long next = -1;
+    for (int b = 0; b < SPI_COUNT; b++) {
+        const spi_bus_t *B = &buses[b];
+        if (B->used && B->head != NULL && (next < 0 || B->head->t_end < next)) {
+            next = B->head->t_end;
+        }
+    }
+    return next;
+}
+
+int spi_transfer(int bus, spi_xfer_t *x){
+    if (spi_submit(bus, x) != 0) {
+        return -1;
+    }
+    while (x->status != SPI_XFER_DONE) {
+        sleep_until_ns(spi_next_ns());
+        spi_poll();
+    }
+    return 0;
+}
+
+void spi_stats(int bus, spi_stats_t *st){
+    memset(st, 0, sizeof(*st));
+    if (!spi_is_valid(bus)) {
+        return;
+    }
+    const spi_bus_t *B = &buses[bus];
+    st->xfers       = B->xfers;
+    st->bytes       = B->bytes;
+    st->batches     = B->batches;
+    st->busy_ns     = B->busy_ns;
+    st->wire_ns     = B->wire_ns;
+    st->wait_max_ns = B->wait_max_ns;
+    st->span_ns     = B->xfers > 0 ? B->t_last - B->t_first : 0;
+    st->utilization = st->span_ns > 0 ? (double)B->busy_ns / (double)st->span_ns : 0;
+    st->overhead    = B->busy_ns > 0 ? (double)(B->busy_ns - B->wire_ns) / (double)B->busy_ns : 0;
+}
+
+void spi_stats_reset(int bus){
+    if (!spi_is_valid(bus)) {
+        return;
+    }
+    spi_bus_t *B = &buses[bus];
+    B->xfers = B->bytes = B->batches = 0;
+    B->busy_ns = B->wire_ns = B->wait_max_ns = 0;
+    B->t_first = B->t_last = 0;
+}
@@ -0,0 +1,346 @@
+/*
+  stress.c — Prueba de carga del debounce con rebote generado (bounce.h)
+
+  N botones simulados (pines 0..N-1), cada uno con su instancia de app
+  (LED en GPIO_PIN_MAX/2 + k), alimentados por el generador de rebote y
+  corridos con el reloj VIRTUAL, igual que replay.c.
+
+  El generador sabe cuál era el nivel "verdadero" del botón, así que se
+  puede medir qué tan bien filtra el debounce:
+    - ok        : cambio ideal que llegó al LED (una vez)
+    - perdido   : cambio ideal que nunca llegó (o llegó tarde, tapado por el siguiente)
+    - espurio   : cambio de LED sin cambio ideal detrás (rebote o ruido que pasó)
+    - cortado   : cambio ideal cuya ráfaga quedó a medias al terminar la prueba
+  y cuánto cuesta: tiempo de CPU por transición cruda y por segundo simulado,
+  más la latencia cambio ideal -> LED.
+
+  Uso:
+    ./bin/stress [-n pines] [-t segundos] [-s semilla] [-D uniform|exp|normal]
+                 [-r presiones_hz] [-H hold_us] [-b rafaga_us] [-c chatter_hz]
+                 [-g ruido_hz] [-G ruido_us] [-m switch|toggle] [-d debounce_ms]
+                 [-p poll_ms] [-a algoritmo|all] [-o traza.trc] [-V ondas.vcd]
+
+  Con -a all corre la MISMA entrada (misma semilla) por cada algoritmo de
+  debounce (debounce.h) y imprime una tabla: CPU por muestreo (todo el
+  camino: timer + gpio_read + debounce + LED, más el generador), latencia y
+  tasa de cambios espurios, para elegir el más barato que cumpla la latencia.
+  El costo aislado del filtro por muestra lo da bench (debounce_<algoritmo>).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "gpio.h"
+#include "gpio_err.h"
+#include "app.h"
+#include "bounce.h"
+#include "timeutil.h"
+#include "timer.h"
+#include "latency.h"
+#include "trace.h"
+#include "vcd.h"
+
+typedef struct{
+    int           npins;
+    double        seconds;
+    bounce_cfg_t  bounce;
+    app_mode_t    mode;
+    long long     debounce_ms;
+    int           poll_ms;
+    const char   *trace_path; // grabar la entrada generada (NULL = no)
+    const char   *vcd_path;   // volcado VCD (NULL = no)
+    int           algo;       // debounce_algo_t, o -1 = todos
+} stress_opts_t;
+
+// Lo que mide una corrida
+typedef struct{
+    uint64_t  raw_changes, ideal_changes, fired;
+    uint64_t  ok, missed, spurious, cut;
+    long long wall_ns;        // CPU real de la simulación
+} stress_result_t;
+
+// Seguimiento por pin: ¿hay un cambio ideal esperando llegar al LED?
+typedef struct{
+    long long pending_ns; // instante del cambio ideal (-1 = nada pendiente)
+    int       ideal;      // nivel ideal actual
+} track_t;
+
+static track_t   *track;
+static uint64_t   n_ok, n_missed, n_spurious, n_cut;
+static lat_hist_t lat; // cambio ideal -> LED
+
+static const char *dist_name[] = { "uniform", "exp", "normal" };
+
+/*==========================================================
+=                       MEDICIÓN                           =
+==========================================================*/
+
+static void on_led(app_t *a, int led){
+    track_t *tr = a->user;
+    // en switch el LED debe quedar igual al nivel ideal; en toggle cualquier cambio vale
+    if (tr->pending_ns >= 0 && (a->mode == APP_TOGGLE || led == tr->ideal)) {
+        lat_hist_record(&lat, (uint64_t)(now_ns() - tr->pending_ns));
+        tr->pending_ns = -1;
+        n_ok++;
+    } else {
+        n_spurious++;
+    }
+}
+
+// Cambio ideal del generador: lo que el LED debería reflejar
+static void on_ideal(track_t *tr, app_mode_t mode, long long t, int ideal){
+    tr->ideal = ideal;
+    if (mode == APP_TOGGLE && !ideal) {
+        return; // en toggle solo la presión cambia el LED
+    }
+    if (tr->pending_ns >= 0) {
+        n_missed++; // el anterior nunca llegó
+    }
+    tr->pending_ns = t;
+}
+
+/*==========================================================
+=                        MAIN                              =
+==========================================================*/
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [opciones]\n"
+            "  -n  pines (por defecto 1024, max %d)\n"
+            "  -t  segundos simulados (por defecto 10)\n"
+            "  -s  semilla (por defecto 1)\n"
+            "  -D  distribucion de duraciones: uniform|exp|normal (por defecto exp)\n"
+            "  -r  presiones por segundo por pin (por defecto 1)\n"
+            "  -H  tiempo minimo apretado/suelto en us (por defecto 100000)\n"
+            "  -b  duracion media de la rafaga en us (por defecto 2000)\n"
+            "  -c  rebotes por segundo dentro de la rafaga (por defecto 20000)\n"
+            "  -g  pulsos de ruido por segundo por pin (por defecto 0.5)\n"
+            "  -G  ancho medio del ruido en us (por defecto 200)\n"
+            "  -m  logica de la app: switch|toggle (por defecto switch)\n"
+            "  -d  ventana de debounce en ms (por defecto 50)\n"
+            "  -p  periodo de muestreo en ms (por defecto 5)\n"
+            "  -a  debounce: timer|integrator|shift8|shift16|shift32|all (por defecto timer)\n"
+            "  -o  grabar la entrada generada en una traza (para replay)\n"
+            "  -V  volcar entradas y LEDs en formato VCD\n", argv0, GPIO_PIN_MAX / 2);
+}
+
+/*
+    Una corrida completa con el algoritmo "algo": reloj virtual desde t0,
+    GPIO y timers de cero, el generador con la semilla de las opciones
+    (misma entrada en cada corrida)
+*/
+static int run(const stress_opts_t *o, debounce_algo_t algo, stress_result_t *res){
+    long long t0 = 1000000000LL;
+    vclock_enable(t0 / 1000000);
+    tick_update();
+    if (gpio_init() != 0) {
+        return -1;
+    }
+    timer_service_init();
+    lat_hist_reset(&lat);
+    n_ok = n_missed = n_spurious = n_cut = 0;
+
+    int    *pins = malloc(sizeof(int) * 2 * (size_t)o->npins); // entradas y luego LEDs
+    app_t  *apps = calloc((size_t)o->npins, sizeof(*apps));
+    track = calloc((size_t)o->npins, sizeof(*track));
+    if (pins == NULL || apps == NULL || track == NULL) {
+        perror("stress");
+        return -1;
+    }
+    for (int k = 0; k < o->npins; k++) {
+        pins[k]            = k;
+        pins[o->npins + k] = GPIO_PIN_MAX / 2 + k;
+        track[k].pending_ns = -1;
+        app_init(&apps[k], o->mode, k, GPIO_PIN_MAX / 2 + k, o->poll_ms, o->debounce_ms, on_led, &track[k]);
+        if (app_set_algo(&apps[k], algo) != 0) {
+            fprintf(stderr, "stress: algoritmo de debounce invalido (%d)\n", (int)algo);
+            return -1;
+        }
+    }
+
+    bounce_gen_t gen;
+    if (bounce_init(&gen, &o->bounce, pins, o->npins, t0) != 0) {
+        fprintf(stderr, "stress: configuracion de rebote invalida\n");
+        return -1;
+    }
+
+    trace_writer_t rec;
+    if (o->trace_path != NULL) {
+        if (trace_writer_open(&rec, o->trace_path, t0) != 0) {
+            perror(o->trace_path);
+            return -1;
+        }
+        gpio_trace_attach(&rec);
+    }
+    if (o->vcd_path != NULL && vcd_open(o->vcd_path, pins, NULL, 2 * o->npins) != 0) {
+        perror(o->vcd_path);
+        return -1;
+    }
+
+    long long t_end = t0 + (long long)(o->seconds * 1e9);
+    long long wall0 = TIME_SOURCE_REAL.now_ns();
+    uint64_t  fired = 0;
+    bounce_ev_t ev;
+
+    while (bounce_peek(&gen) <= t_end && bounce_next(&gen, &ev)) {
+        fired += (uint64_t)timer_vclock_run_until(ev.t_ns);
+        if (ev.edge) {
+            on_ideal(&track[ev.pin], o->mode, ev.t_ns, ev.ideal);
+        }
+        gpio_simulate_input(ev.pin, ev.value);
+    }
+    // sin más entrada: dejar que los muestreos pendientes terminen
+    // (los algoritmos por muestras pueden necesitar más de debounce_ms: hasta 32 muestreos)
+    long long settle_ms = o->debounce_ms + 2LL * o->poll_ms;
+    if (algo != DEBOUNCE_TIMER && settle_ms < 34LL * o->poll_ms) {
+        settle_ms = 34LL * o->poll_ms;
+    }
+    fired += (uint64_t)timer_vclock_run_until(t_end + settle_ms * 1000000LL);
+    res->wall_ns = TIME_SOURCE_REAL.now_ns() - wall0;
+
+    // pendientes al final: su ráfaga quedó cortada en t_end, no se cuentan como error
+    for (int k = 0; k < o->npins; k++) {
+        if (track[k].pending_ns >= 0) {
+            n_cut++;
+        }
+    }
+    if (o->trace_path != NULL) {
+        gpio_trace_attach(NULL);
+        trace_writer_close(&rec);
+    }
+    if (vcd_active) {
+        vcd_stats_t st;
+        vcd_close();
+        vcd_stats(&st);
+        printf("VCD: %llu cambios en %s (%llu perdidos)\n",
+               (unsigned long long)st.changes, o->vcd_path, (unsigned long long)st.dropped);
+    }
+
+    res->raw_changes   = gen.raw_changes;
+    res->ideal_changes = gen.ideal_changes;
+    res->fired         = fired;
+    res->ok            = n_ok;
+    res->missed        = n_missed;
+    res->spurious      = n_spurious;
+    res->cut           = n_cut;
+
+    for (int k = 0; k < o->npins; k++) {
+        app_stop(&apps[k]);
+    }
+    bounce_free(&gen);
+    free(track);
+    free(apps);
+    free(pins);
+    return 0;
+}
+
+static double precision_pct(const stress_result_t *r){
+    uint64_t expected = r->ok + r->missed;
+    return expected ? 100.0 * (double)r->ok / (double)(expected + r->spurious) : 100.0;
+}
+
+static void print_header(const stress_opts_t *o){
+    printf("Pines: %d  modo %s  debounce %lld ms  muestreo %d ms\n",
+           o->npins, o->mode == APP_SWITCH ? "switch" : "toggle", o->debounce_ms, o->poll_ms);
+    printf("Rebote: %s  rafaga %lld us  chatter %.0f Hz  presiones %.2f Hz (hold %lld us)"
+           "  ruido %.2f Hz x %lld us  semilla %llu\n",
+           dist_name[o->bounce.dist], o->bounce.bounce_us, o->bounce.chatter_hz, o->bounce.press_hz,
+           o->bounce.hold_us, o->bounce.glitch_hz, o->bounce.glitch_us,
+           (unsigned long long)o->bounce.seed);
+}
+
+int main(int argc, char **argv){
+    stress_opts_t o = { .npins = 1024, .seconds = 10.0, .mode = APP_SWITCH,
+                        .debounce_ms = 50, .poll_ms = 5, .trace_path = NULL, .vcd_path = NULL,
+                        .algo = DEBOUNCE_TIMER };
+    bounce_cfg_default(&o.bounce);
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL || a[0] != '-' || a[1] == '\0' || a[2] != '\0') { usage(argv[0]); return 1; }
+        switch (a[1]) {
+            case 'n': o.npins = atoi(v); break;
+            case 't': o.seconds = atof(v); break;
+            case 's': o.bounce.seed = strtoull(v, NULL, 10); break;
+            case 'D': o.bounce.dist = strcmp(v, "uniform") == 0 ? BOUNCE_DIST_UNIFORM :
+                                      strcmp(v, "normal") == 0 ? BOUNCE_DIST_NORMAL : BOUNCE_DIST_EXP; break;
+            case 'r': o.bounce.press_hz = atof(v); break;
+            case 'H': o.bounce.hold_us = atoll(v); break;
+            case 'b': o.bounce.bounce_us = atoll(v); break;
+            case 'c': o.bounce.chatter_hz = atof(v); break;
+            case 'g': o.bounce.glitch_hz = atof(v); break;
+            case 'G': o.bounce.glitch_us = atoll(v); break;
+            case 'm': o.mode = strcmp(v, "toggle") == 0 ? APP_TOGGLE : APP_SWITCH; break;
+            case 'd': o.debounce_ms = atoll(v); break;
+            case 'p': o.poll_ms = atoi(v); break;
+            case 'a':
+                o.algo = strcmp(v, "all") == 0 ? -1 : debounce_algo_parse(v);
+                if (o.algo == -1 && strcmp(v, "all") != 0) { usage(argv[0]); return 1; }
+                break;
+            case 'o': o.trace_path = v; break;
+            case 'V': o.vcd_path = v; break;
+            default: usage(argv[0]); return 1;
+        }
+        i++;
+    }
+    if (o.npins < 1 || o.npins > GPIO_PIN_MAX / 2 || o.bounce.chatter_hz <= 0 || o.poll_ms < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    stress_result_t r;
+
+    if (o.algo >= 0) {
+        // un algoritmo: reporte completo
+        if (run(&o, (debounce_algo_t)o.algo, &r) != 0) {
+            return 1;
+        }
+        double secs = r.wall_ns > 0 ? r.wall_ns / 1e9 : 1e-9;
+        print_header(&o);
+        printf("Debounce: %s\n", debounce_algo_name[o.algo]);
+        printf("Tiempo simulado: %.3f s  real: %.3f s  (x%.0f)\n", o.seconds, secs, o.seconds / secs);
+        printf("Transiciones crudas: %llu  cambios ideales: %llu  muestreos: %llu\n",
+               (unsigned long long)r.raw_changes, (unsigned long long)r.ideal_changes,
+               (unsigned long long)r.fired);
+        printf("LED: ok %llu  perdidos %llu  espurios %llu  (cortados al final %llu)  precision %.4f %%\n",
+               (unsigned long long)r.ok, (unsigned long long)r.missed, (unsigned long long)r.spurious,
+               (unsigned long long)r.cut, precision_pct(&r));
+        printf("Costo: %.1f ns por transicion cruda, %.1f us de CPU por segundo simulado\n",
+               r.raw_changes ? r.wall_ns / (double)r.raw_changes : 0.0, secs * 1e6 / o.seconds);
+        lat_hist_print(&lat, "ideal->LED", stdout);
+    } else {
+        // todos: misma entrada por cada algoritmo, una fila por algoritmo
+        print_header(&o);
+        printf("Tiempo simulado: %.3f s por algoritmo\n", o.seconds);
+        printf("%-11s %12s %10s %10s %10s %10s %9s %10s %10s %10s\n",
+               "algoritmo", "muestreos", "ns/muest", "ok", "perdidos", "espurios", "espur %",
+               "p50 ms", "p99 ms", "max ms");
+        // corrida descartada: que el primer algoritmo no pague el arranque (páginas, caches)
+        stress_opts_t warm = o;
+        warm.trace_path = NULL;
+        warm.vcd_path   = NULL;
+        if (run(&warm, DEBOUNCE_TIMER, &r) != 0) {
+            return 1;
+        }
+        for (int a = 0; a < DEBOUNCE_ALGO_COUNT; a++) {
+            if (run(&o, (debounce_algo_t)a, &r) != 0) {
+                return 1;
+            }
+            o.trace_path = NULL; // la entrada es la misma: grabarla una vez basta
+            o.vcd_path   = NULL;
+            printf("%-11s %12llu %10.1f %10llu %10llu %10llu %9.4f %10.3f %10.3f %10.3f\n",
+                   debounce_algo_name[a], (unsigned long long)r.fired,
+                   r.fired ? r.wall_ns / (double)r.fired : 0.0,
+                   (unsigned long long)r.ok, (unsigned long long)r.missed,
+                   (unsigned long long)r.spurious,
+                   r.ok + r.spurious ? 100.0 * (double)r.spurious / (double)(r.ok + r.spurious) : 0.0,
+                   lat_hist_percentile(&lat, 50) / 1e6, lat_hist_percentile(&lat, 99) / 1e6,
+                   lat.count ? lat.max / 1e6 : 0.0);
+        }
+    }
+    gpio_err_flush(stderr);
+    gpio_err_dump(stderr);
+    return 0;
+}
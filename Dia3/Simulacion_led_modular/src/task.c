@@ -0,0 +1,214 @@
+/*
+  task.c — Planificador cooperativo de tareas sin pila
+
+  Ideas clave:
+  - Cola FIFO de tareas listas: correr = sacar de la cabeza y llamar a fn.
+  - Esperar un instante = armar el swtimer de la tarea; el callback del timer
+    la pone en la cola. Esperar un evento = marcar wait_mask; task_post la
+    pone en la cola si le llegó algo de lo que espera.
+  - Nada recorre las tareas dormidas: el costo por vuelta del loop depende de
+    cuántas tareas tienen algo que hacer, no de cuántas hay.
+  - La lista de todas las tareas solo se usa para task_dump / task_kill.
+*/
+
+#include "task.h"
+#include "timeutil.h"
+
+static task_t *ready_head = NULL;
+static task_t *ready_tail = NULL;
+static task_t *all_tasks  = NULL;
+
+/*==========================================================
+=                 COLA DE LISTAS (privada)                 =
+==========================================================*/
+
+static int in_ready(const task_t *t){
+    return t->next_ready != NULL || ready_tail == t;
+}
+
+static void enqueue(task_t *t){
+    t->state = TASK_READY;
+    if (in_ready(t)) {
+        return;
+    }
+    t->next_ready = NULL;
+    if (ready_tail != NULL) {
+        ready_tail->next_ready = t;
+    } else {
+        ready_head = t;
+    }
+    ready_tail = t;
+}
+
+static task_t *dequeue(void){
+    task_t *t = ready_head;
+    if (t != NULL) {
+        ready_head = t->next_ready;
+        if (ready_head == NULL) {
+            ready_tail = NULL;
+        }
+        t->next_ready = NULL;
+    }
+    return t;
+}
+
+static void unqueue(task_t *t){
+    task_t *prev = NULL;
+    for (task_t *p = ready_head; p != NULL; prev = p, p = p->next_ready) {
+        if (p == t) {
+            if (prev != NULL) {
+                prev->next_ready = t->next_ready;
+            } else {
+                ready_head = t->next_ready;
+            }
+            if (ready_tail == t) {
+                ready_tail = prev;
+            }
+            t->next_ready = NULL;
+            return;
+        }
+    }
+}
+
+// Vencimiento del timer de la tarea: pasa a la cola
+static void on_deadline(swtimer_t *tm, void *arg){
+    (void)tm;
+    task_t *t = arg;
+    if (t->state == TASK_WAIT_TIME) {
+        enqueue(t);
+    }
+}
+
+/*==========================================================
+=                        API PÚBLICA                       =
+==========================================================*/
+
+void task_start(task_t *t, const char *name, task_fn_t fn, void *arg){
+    t->name       = name;
+    t->fn         = fn;
+    t->arg        = arg;
+    t->pc         = 0;
+    t->events     = 0;
+    t->wait_mask  = 0;
+    t->got        = 0;
+    t->deadline   = tick_ms();
+    t->next_ready = NULL;
+    t->runs       = 0;
+    t->run_ns     = 0;
+    t->max_ns     = 0;
+    timer_setup(&t->timer, on_deadline, t);
+
+    t->next_all = all_tasks;
+    all_tasks = t;
+    enqueue(t);
+}
+
+void task_kill(task_t *t){
+    timer_stop(&t->timer);
+    unqueue(t);
+    t->state = TASK_FINISHED;
+    for (task_t **pp = &all_tasks; *pp != NULL; pp = &(*pp)->next_all) {
+        if (*pp == t) {
+            *pp = t->next_all;
+            break;
+        }
+    }
+    t->next_all = NULL;
+}
+
+void task_post(task_t *t, uint32_t ev){
+    t->events |= ev;
+    if (t->state == TASK_WAIT_EVENT && (t->events & t->wait_mask) != 0) {
+        enqueue(t);
+    }
+}
+
+int task_run_ready(void){
+    task_t *last = ready_tail; // lo que llegue después espera a la próxima llamada
+    int n = 0;
+    while (last != NULL && ready_head != NULL) {
+        task_t *t = dequeue();
+        int is_last = (t == last);
+
+        uint64_t t0 = (uint64_t)TIME_SOURCE_REAL.now_ns(); // reloj real también con el virtual
+        int rc = t->fn(t);
+        uint64_t dt = (uint64_t)TIME_SOURCE_REAL.now_ns() - t0;
+        t->runs++;
+        t->run_ns += dt;
+        if (dt > t->max_ns) {
+            t->max_ns = dt;
+        }
+        n++;
+
+        if (rc == TASK_DONE) {
+            timer_stop(&t->timer);
+            unqueue(t);
+            t->state = TASK_FINISHED;
+        }
+        if (is_last) {
+            break;
+        }
+    }
+    return n;
+}
+
+int task_any_ready(void){
+    return ready_head != NULL;
+}
+
+long long task_ms_until_next(void){
+    return ready_head != NULL ? 0 : timer_ms_until_next();
+}
+
+void task_dump(FILE *f){
+    static const char *state_name[] = { "lista", "tiempo", "evento", "terminada" };
+    fprintf(f, "Tareas:\n  %-12s %10s %12s %10s %10s  %s\n",
+            "nombre", "corridas", "total (ms)", "prom (us)", "max (us)", "estado");
+    for (task_t *t = all_tasks; t != NULL; t = t->next_all) {
+        fprintf(f, "  %-12s %10llu %12.3f %10.2f %10.2f  %s\n",
+                t->name, (unsigned long long)t->runs, t->run_ns / 1e6,
+                t->runs ? t->run_ns / 1e3 / (double)t->runs : 0.0, t->max_ns / 1e3,
+                state_name[t->state]);
+    }
+}
+
+void task_stats_reset(void){
+    for (task_t *t = all_tasks; t != NULL; t = t->next_all) {
+        t->runs   = 0;
+        t->run_ns = 0;
+        t->max_ns = 0;
+    }
+}
+
+/*==========================================================
+=               SOPORTE DE LAS MACROS (task.h)             =
+==========================================================*/
+
+int task_take_events_(task_t *t, uint32_t mask){
+    uint32_t hit = t->events & mask;
+    if (hit != 0) {
+        t->events &= ~hit;
+        t->got = hit;
+        return 1;
+    }
+    t->wait_mask = mask;
+    t->state = TASK_WAIT_EVENT;
+    return 0;
+}
+
+void task_arm_(task_t *t, long long at_ms){
+    t->deadline = at_ms;
+    if (at_ms <= tick_ms()) {
+        return; // ya venció: sigue sin esperar
+    }
+    t->state = TASK_WAIT_TIME;
+    timer_start_at(&t->timer, at_ms, 0);
+}
+
+int task_time_due_(task_t *t){
+    return t->state != TASK_WAIT_TIME;
+}
+
+void task_ready_(task_t *t){
+    enqueue(t);
+}
@@ -0,0 +1,320 @@
+/*
+  timer.c — Rueda de temporizadores jerárquica (hierarchical timing wheel)
+
+  Ideas clave:
+  - "base" = próximo ms que todavía no se procesó (todo lo que vence antes ya disparó).
+  - 4 niveles de 64 slots. El nivel de un timer depende de en qué grupo de 6 bits
+    difiere su vencimiento de "base":
+        nivel 0: mismo bloque de 64 ms         -> slot = ms exacto
+        nivel 1: mismo bloque de 4096 ms       -> slot = bloque de 64 ms
+        nivel 2: mismo bloque de 262144 ms     -> slot = bloque de 4096 ms
+        nivel 3: mismo bloque de 2^24 ms (~4.6 h)
+    más allá va a una lista "lejana" que se revisa cada 2^24 ms.
+  - Insertar / cancelar = enlazar / desenlazar de una lista: O(1).
+  - Cuando "base" entra en un bloque nuevo, el slot correspondiente del nivel
+    superior se "cascadea": sus timers se reubican en niveles más bajos.
+  - occ[nivel] = bitmap de slots ocupados: encontrar el próximo evento es un ctz,
+    así que saltar un tramo vacío (dormir 5 s) no recorre 5000 ticks.
+*/
+
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "timer.h"
+#include "timeutil.h"
+
+#define TW_BITS   6
+#define TW_SIZE   (1 << TW_BITS)
+#define TW_MASK   (TW_SIZE - 1)
+#define TW_LEVELS 4
+#define TW_SPAN   (1LL << (TW_BITS * TW_LEVELS))  // alcance de la rueda en ms
+
+#define LEVEL_FAR (-1)
+
+static swtimer_t *wheel[TW_LEVELS][TW_SIZE]; // cabeza de la lista de cada slot
+static uint64_t   occ[TW_LEVELS];            // slots ocupados por nivel
+static swtimer_t *far_list;                  // timers fuera del alcance
+static long long  base;                      // próximo ms a procesar
+static int        running;                   // 1 mientras corren callbacks del tick "base"
+
+/*==========================================================
+=                 LISTAS (uso interno)                      =
+==========================================================*/
+
+static void list_link(swtimer_t **head, swtimer_t *t){
+    t->next = *head;
+    if (*head != NULL) {
+        (*head)->pprev = &t->next;
+    }
+    *head = t;
+    t->pprev = head;
+}
+
+static void list_unlink(swtimer_t *t){
+    *t->pprev = t->next;
+    if (t->next != NULL) {
+        t->next->pprev = t->pprev;
+    }
+    t->next  = NULL;
+    t->pprev = NULL;
+    if (t->level >= 0 && wheel[t->level][t->slot] == NULL) {
+        occ[t->level] &= ~(1ULL << t->slot);
+    }
+}
+
+// Ubica el timer en el nivel/slot que le toca según "base"
+static void place(swtimer_t *t){
+    long long e = t->expires;
+    long long min = running ? base + 1 : base; // el tick en curso ya se está procesando
+    if (e < min) {
+        e = min; // vencido: sale en el próximo tick procesable
+    }
+
+    long long diff = e ^ base;
+    for (int lvl = 0; lvl < TW_LEVELS; lvl++) {
+        if (diff < (1LL << (TW_BITS * (lvl + 1)))) {
+            int slot = (int)((e >> (TW_BITS * lvl)) & TW_MASK);
+            t->level = lvl;
+            t->slot  = slot;
+            list_link(&wheel[lvl][slot], t);
+            occ[lvl] |= 1ULL << slot;
+            return;
+        }
+    }
+    t->level = LEVEL_FAR;
+    t->slot  = 0;
+    list_link(&far_list, t);
+}
+
+/*
+   Próximo tick (>= base) en el que hay algo que hacer: un slot del nivel 0 que
+   vence o un slot superior que hay que cascadear. Como "base" siempre se
+   cascadea al entrar en un bloque (ver advance()), los niveles quedan anidados
+   (nivel 0 < nivel 1 < ...) y el primero que aparece es el más cercano.
+   Retorna LLONG_MAX si la rueda está vacía. *out_lvl / *out_slot: dónde está.
+*/
+static long long next_event_tick(int *out_lvl, int *out_slot){
+    for (int lvl = 0; lvl < TW_LEVELS; lvl++) {
+        int shift = TW_BITS * lvl;
+        int cur   = (int)((base >> shift) & TW_MASK);
+        // nivel 0: desde el slot actual. Niveles superiores: solo bloques
+        // posteriores (el actual ya se cascadeó al entrar en él)
+        uint64_t m;
+        if (lvl == 0) {
+            m = occ[0] & (~0ULL << cur);
+        } else {
+            m = (cur == TW_MASK) ? 0 : (occ[lvl] & (~0ULL << (cur + 1)));
+        }
+        if (m != 0) {
+            int slot = __builtin_ctzll(m);
+            long long block = base & ~((1LL << (shift + TW_BITS)) - 1);
+            long long start = block | ((long long)slot << shift);
+            *out_lvl  = lvl;
+            *out_slot = slot;
+            return start;
+        }
+    }
+    if (far_list != NULL) {
+        *out_lvl  = LEVEL_FAR;
+        *out_slot = 0;
+        return ((base / TW_SPAN) + 1) * TW_SPAN;
+    }
+    return LLONG_MAX;
+}
+
+// Reubica todos los timers de una lista (cascada)
+static void replace_list(swtimer_t **head){
+    swtimer_t *list = *head;
+    *head = NULL;
+    if (list != NULL) {
+        list->pprev = &list;
+    }
+    while (list != NULL) {
+        swtimer_t *t = list;
+        list_unlink(t);
+        place(t);
+    }
+}
+
+// "base" acaba de entrar en un bloque nuevo: bajar los slots que empiezan aquí
+static void cascade(void){
+    if ((base & (TW_SPAN - 1)) == 0) {
+        replace_list(&far_list);
+    }
+    for (int lvl = TW_LEVELS - 1; lvl >= 1; lvl--) {
+        int shift = TW_BITS * lvl;
+        if ((base & ((1LL << shift) - 1)) != 0) {
+            continue;
+        }
+        int slot = (int)((base >> shift) & TW_MASK);
+        if (occ[lvl] & (1ULL << slot)) {
+            occ[lvl] &= ~(1ULL << slot);
+            replace_list(&wheel[lvl][slot]);
+        }
+    }
+}
+
+// Mueve "base" y, si entra en un bloque nuevo, cascadea en ese momento
+static void advance(long long nb){
+    base = nb;
+    if ((base & TW_MASK) == 0) {
+        cascade();
+    }
+}
+
+// Dispara todos los timers del slot del nivel 0 que corresponde a "base"
+static int fire_slot(void){
+    int slot = (int)(base & TW_MASK);
+    if (!(occ[0] & (1ULL << slot))) {
+        return 0;
+    }
+
+    // sacamos la lista del slot: los callbacks pueden parar/arrancar timers
+    swtimer_t *list = wheel[0][slot];
+    wheel[0][slot] = NULL;
+    occ[0] &= ~(1ULL << slot);
+    list->pprev = &list;
+
+    int fired = 0;
+    running = 1;
+    while (list != NULL) {
+        swtimer_t *t = list;
+        list_unlink(t);
+
+        if (t->period > 0) {
+            // periódico: re-armar ANTES del callback (así el callback puede pararlo)
+            // si nos atrasamos, saltamos los periodos perdidos sin perder la fase
+            long long e = t->expires + t->period;
+            if (e <= base) {
+                e += t->period * ((base - e) / t->period + 1);
+            }
+            t->expires = e;
+            place(t);
+        }
+        t->cb(t, t->arg);
+        fired++;
+    }
+    running = 0;
+    return fired;
+}
+
+/*==========================================================
+=                        API PÚBLICA                        =
+==========================================================*/
+
+void timer_service_init(void){
+    memset(wheel, 0, sizeof(wheel));
+    memset(occ, 0, sizeof(occ));
+    far_list = NULL;
+    running  = 0;
+    base     = now_ms();
+}
+
+void timer_setup(swtimer_t *t, swtimer_cb_t cb, void *arg){
+    memset(t, 0, sizeof(*t));
+    t->cb  = cb;
+    t->arg = arg;
+}
+
+void timer_start_at(swtimer_t *t, long long at_ms, long long period_ms){
+    if (timer_active(t)) {
+        list_unlink(t);
+    }
+    t->expires = at_ms;
+    t->period  = (period_ms > 0) ? period_ms : 0;
+    place(t);
+}
+
+void timer_start(swtimer_t *t, long long delay_ms, long long period_ms){
+    timer_start_at(t, now_ms() + delay_ms, period_ms);
+}
+
+void timer_stop(swtimer_t *t){
+    if (timer_active(t)) {
+        list_unlink(t);
+    }
+}
+
+int timer_active(const swtimer_t *t){
+    return t->pprev != NULL;
+}
+
+long long timer_next_deadline(void){
+    int lvl, slot;
+    long long tick = next_event_tick(&lvl, &slot);
+    if (tick == LLONG_MAX) {
+        return -1;
+    }
+    if (lvl == 0) {
+        return tick; // el slot del nivel 0 es un ms exacto
+    }
+
+    // slot superior: el más temprano de su lista (todos caen dentro de su bloque)
+    swtimer_t *t = (lvl == LEVEL_FAR) ? far_list : wheel[lvl][slot];
+    long long best = LLONG_MAX;
+    for (; t != NULL; t = t->next) {
+        if (t->expires < best) {
+            best = t->expires;
+        }
+    }
+    return (best > tick) ? best : tick;
+}
+
+long long timer_ms_until_next(void){
+    long long d = timer_next_deadline();
+    if (d < 0) {
+        return -1;
+    }
+    long long now = now_ms();
+    return (d > now) ? d - now : 0;
+}
+
+int timer_run_due(long long now){
+    int fired = 0;
+    int lvl, slot;
+
+    while (1) {
+        long long t = next_event_tick(&lvl, &slot);
+        if (t > now) {
+            // nada más hasta "now": saltamos el tramo vacío de una vez
+            if (now + 1 > base) {
+                advance(now + 1);
+            }
+            break;
+        }
+        if (t != base) {
+            advance(t);
+        }
+        fired += fire_slot();
+        advance(base + 1);
+    }
+    return fired;
+}
+
+int timer_run_until_next(void){
+    long long d = timer_next_deadline();
+    if (d < 0) {
+        return -1;
+    }
+    if (d > now_ms()) {
+        sleep_until_ms(d);
+    }
+    return timer_run_due(now_ms());
+}
+
+long long timer_vclock_run_until(long long t_ns){
+    long long fired = 0;
+    long long d;
+    while ((d = timer_next_deadline()) >= 0 && d * 1000000LL <= t_ns) {
+        if (d * 1000000LL > now_ns()) {
+            vclock_set_ns(d * 1000000LL);
+        }
+        tick_update();
+        fired += timer_run_due(tick_ms());
+    }
+    if (t_ns > now_ns()) {
+        vclock_set_ns(t_ns);
+    }
+    tick_update();
+    return fired;
+}
@@ -2,24 +2,155 @@
 /*
   timeutil.c — Tiempo monotónico + sleep cooperativo
 
-  now_ms():
+  now_ns() / now_us() / now_ms():
     - Usa CLOCK_MONOTONIC (no retrocede si cambia la hora del SO).
-    - Retorna milisegundos desde que arrancó el reloj.
+    - Una sola lectura en ns; us y ms son la misma lectura truncada.
 
   sleep_ms():
     - Envuelve nanosleep para ms.
     - Útil para que el loop no consuma 100% CPU en la simulación.
+
+  sleep_until_ms() / sleep_until_ns():
+    - clock_nanosleep con TIMER_ABSTIME: duerme hasta un instante absoluto.
+    - No acumula error: si el loop tardó, duerme menos (o nada).
+
+  tick_update():
+    - Lee el reloj una vez y lo deja en tick_now_ns; el resto del loop usa
+      tick_ns()/tick_us()/tick_ms() (una carga de memoria).
+
+  Reloj virtual:
+    - now_ns() devuelve un contador en RAM, y dormir solo lo adelanta.
+    - Todo el que use now_*()/sleep_*() (debounce, timers, mains) corre igual
+      pero sin esperar: 1 hora de escenario tarda lo que tarde el CPU.
+    - El contador es atómico para que otros hilos lo puedan leer.
 */
 
 #include <time.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "timeutil.h"
 
-long long now_ms(void){
+#define NS_PER_SEC 1000000000LL
+
+atomic_llong tick_now_ns = 0;
+
+/* -------------------- Reloj real (CLOCK_MONOTONIC) -------------------- */
+
+static long long real_now_ns(void){
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+    return (long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
 }
 
-void sleep_ms(long ms){
-    struct timespec rq = { .tv_sec = ms/1000, .tv_nsec = (ms%1000)*1000000L };
+static void real_sleep_ns(long long ns){
+    struct timespec rq = { .tv_sec = ns / NS_PER_SEC, .tv_nsec = ns % NS_PER_SEC };
     nanosleep(&rq, NULL);
 }
+
+static void real_sleep_until_ns(long long deadline_ns){
+    struct timespec ts = { .tv_sec = deadline_ns / NS_PER_SEC, .tv_nsec = deadline_ns % NS_PER_SEC };
+    // si una señal interrumpe, volvemos a dormir hasta el mismo instante
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+const time_source_t TIME_SOURCE_REAL = {
+    .now_ns         = real_now_ns,
+    .sleep_ns       = real_sleep_ns,
+    .sleep_until_ns = real_sleep_until_ns,
+};
+
+/* -------------------- Reloj virtual (simulado) -------------------- */
+
+static atomic_llong vnow_ns; // instante virtual actual
+
+static long long virt_now_ns(void){
+    return atomic_load_explicit(&vnow_ns, memory_order_relaxed);
+}
+
+static void virt_sleep_until_ns(long long deadline_ns){
+    // solo hacia adelante: el reloj es monotónico
+    long long cur = atomic_load(&vnow_ns);
+    while (deadline_ns > cur && !atomic_compare_exchange_weak(&vnow_ns, &cur, deadline_ns)) {
+    }
+}
+
+static void virt_sleep_ns(long long ns){
+    if (ns > 0) {
+        atomic_fetch_add(&vnow_ns, ns);
+    }
+}
+
+const time_source_t TIME_SOURCE_VIRTUAL = {
+    .now_ns         = virt_now_ns,
+    .sleep_ns       = virt_sleep_ns,
+    .sleep_until_ns = virt_sleep_until_ns,
+};
+
+/* -------------------- API -------------------- */
+
+static const time_source_t *src = &TIME_SOURCE_REAL;
+
+void time_source_set(const time_source_t *s){
+    src = (s != NULL) ? s : &TIME_SOURCE_REAL;
+}
+
+int time_is_virtual(void){
+    return src == &TIME_SOURCE_VIRTUAL;
+}
+
+void vclock_enable(long long start_ms){
+    atomic_store(&vnow_ns, start_ms * 1000000LL);
+    time_source_set(&TIME_SOURCE_VIRTUAL);
+}
+
+void vclock_set_ns(long long t_ns){
+    virt_sleep_until_ns(t_ns);
+}
+
+void vclock_advance_ns(long long ns){
+    virt_sleep_ns(ns);
+}
+
+void vclock_set_ms(long long t_ms){
+    virt_sleep_until_ns(t_ms * 1000000LL);
+}
+
+void vclock_advance_ms(long long ms){
+    virt_sleep_ns(ms * 1000000LL);
+}
+
+long long now_ns(void){
+    return src->now_ns();
+}
+
+long long now_us(void){
+    return src->now_ns() / 1000LL;
+}
+
+long long now_ms(void){
+    return src->now_ns() / 1000000LL;
+}
+
+long long tick_update(void){
+    long long t = src->now_ns();
+    atomic_store_explicit(&tick_now_ns, t, memory_order_relaxed);
+    return t;
+}
+
+void sleep_ms(long long ms){
+    src->sleep_ns(ms * 1000000LL);
+}
+
+void sleep_us(long long us){
+    src->sleep_ns(us * 1000LL);
+}
+
+void sleep_until_ns(long long deadline_ns){
+    src->sleep_until_ns(deadline_ns);
+}
+
+void sleep_until_ms(long long deadline_ms){
+    src->sleep_until_ns(deadline_ms * 1000000LL);
+}
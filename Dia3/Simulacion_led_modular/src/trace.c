@@ -0,0 +1,164 @@
+/*
+  trace.c — Grabación y lectura de trazas binarias de pines
+
+  Escritura:
+  - FILE* con un buffer de 1 MB: los registros se acumulan en RAM y salen en
+    escrituras grandes, no un write() por transición.
+  - Al cerrar se vuelve al inicio y se reescribe el header con el total.
+
+  Lectura:
+  - mmap del archivo completo (solo lectura). Los registros son un arreglo
+    de structs de 8 bytes: recorrerlos es leer memoria secuencial, sin
+    syscalls ni parseo.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+#define TRACE_BUF_SIZE (1 << 20)
+
+_Static_assert(sizeof(trace_header_t) == 32, "trace_header_t debe medir 32 bytes");
+_Static_assert(sizeof(trace_rec_t) == 8, "trace_rec_t debe medir 8 bytes");
+
+/*==========================================================
+=                        ESCRITURA                         =
+==========================================================*/
+
+static void write_header(trace_writer_t *w){
+    trace_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic    = TRACE_MAGIC;
+    h.version  = TRACE_VERSION;
+    h.rec_size = sizeof(trace_rec_t);
+    h.count    = w->count;
+    h.t0_ns    = w->t0_ns;
+    fwrite(&h, sizeof(h), 1, w->f);
+}
+
+int trace_writer_open(trace_writer_t *w, const char *path, long long t0_ns){
+    memset(w, 0, sizeof(*w));
+    w->f = fopen(path, "wb");
+    if (w->f == NULL) {
+        return -1;
+    }
+    w->buf = malloc(TRACE_BUF_SIZE);
+    if (w->buf != NULL) {
+        setvbuf(w->f, w->buf, _IOFBF, TRACE_BUF_SIZE);
+    }
+    w->t0_ns   = t0_ns;
+    w->last_us = t0_ns / 1000;
+    write_header(w);
+    return 0;
+}
+
+void trace_writer_add(trace_writer_t *w, long long t_ns, int pin, int value){
+    long long t_us = t_ns / 1000;
+    long long dt = t_us - w->last_us;
+    if (dt < 0) {
+        dt = 0;
+    }
+
+    // deltas gigantes: registros que solo adelantan el tiempo
+    while (dt > UINT32_MAX) {
+        trace_rec_t gap = { .dt_us = UINT32_MAX, .pin = 0, .value = 0, .flags = TRACE_F_TIME };
+        fwrite(&gap, sizeof(gap), 1, w->f);
+        w->count++;
+        dt -= UINT32_MAX;
+    }
+
+    trace_rec_t r = { .dt_us = (uint32_t)dt, .pin = (uint16_t)pin, .value = (uint8_t)(value != 0), .flags = 0 };
+    fwrite(&r, sizeof(r), 1, w->f);
+    w->count++;
+    w->last_us = t_us;
+}
+
+int trace_writer_close(trace_writer_t *w){
+    if (w->f == NULL) {
+        return -1;
+    }
+    // volver al inicio y reescribir el header con el total
+    int rc = 0;
+    if (fseek(w->f, 0, SEEK_SET) != 0) {
+        rc = -1;
+    } else {
+        write_header(w);
+    }
+    if (fclose(w->f) != 0) {
+        rc = -1;
+    }
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+    return rc;
+}
+
+/*==========================================================
+=                      LECTURA (mmap)                      =
+==========================================================*/
+
+int trace_reader_open(trace_reader_t *r, const char *path){
+    memset(r, 0, sizeof(*r));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(trace_header_t)) {
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // el mapeo sigue vivo sin el descriptor
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+
+    const trace_header_t *h = p;
+    // count viene del archivo: se compara contra lo que entra antes de multiplicar
+    // (count * 8 con un count enorme da la vuelta y pasaría el chequeo)
+    size_t fit = ((size_t)st.st_size - sizeof(*h)) / sizeof(trace_rec_t);
+    if (h->magic != TRACE_MAGIC || h->version != TRACE_VERSION ||
+        h->rec_size != sizeof(trace_rec_t) || h->count > fit) {
+        munmap(p, (size_t)st.st_size);
+        return -1;
+    }
+    // vamos a leer todo en orden: que el kernel lea por adelantado
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    r->hdr  = h;
+    r->rec  = (const trace_rec_t *)(h + 1);
+    r->size = (size_t)st.st_size;
+    trace_reader_rewind(r);
+    return 0;
+}
+
+void trace_reader_close(trace_reader_t *r){
+    if (r->hdr != NULL) {
+        munmap((void *)r->hdr, r->size);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+void trace_reader_rewind(trace_reader_t *r){
+    r->pos  = 0;
+    r->t_us = r->hdr->t0_ns / 1000;
+}
+
+int trace_reader_next(trace_reader_t *r, long long *t_ns, int *pin, int *value){
+    while (r->pos < r->hdr->count) {
+        const trace_rec_t *x = &r->rec[r->pos++];
+        r->t_us += x->dt_us;
+        if (x->flags & TRACE_F_TIME) {
+            continue; // solo adelanta el tiempo
+        }
+        *t_ns  = r->t_us * 1000;
+        *pin   = x->pin;
+        *value = x->value;
+        return 1;
+    }
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include <unistd.h>   // STDIN_FILENO, read(), tcgetattr/tcsetattr
 #include <fcntl.h>    // fcntl(), F_GETFL, F_SETFL, O_NONBLOCK
 #include <stdio.h>    // setvbuf(), printf (por si quieres logs)
+#include <errno.h>    // EAGAIN
+#include "tty.h"
 
 /// Guardamos el estado ORIGINAL del TTY para restaurarlo al salir.
 /// Si no restauras, te quedas con la terminal rara (sin eco).
@@ -69,18 +71,40 @@ void tty_raw_disable(void){
     }
 }
 
+/// Buffer de tty_getch_nonblock(): lo que trajo la última lectura y todavía no se entregó
+static unsigned char pend[TTY_BURST_MAX];
+static int pend_len = 0;
+static int pend_pos = 0;
+
+/// Lee de una vez TODO lo que haya pendiente en fd (hasta max bytes).
+/// Devuelve: >0 bytes leídos, 0 si no había nada, -1 si fin de archivo o error.
+/// Un pegado o un script de 1000 teclas es UN read(), no 1000.
+int tty_read_burst(int fd, unsigned char *buf, int max){
+    ssize_t n = read(fd, buf, (size_t)max);
+    if (n > 0) {
+        return (int)n;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return 0; // no hay nada (stdin en O_NONBLOCK)
+    }
+    return -1; // n == 0: fin de archivo
+}
+
 /// Lee UNA tecla en modo no bloqueante.
 /// Devuelve: 0..255 (unsigned char) si hay tecla, o -1 si no hay nada.
 /// Nota: NO imprime, NO hace echo (estás en raw), el UI lo decides tú.
+/// Internamente lee por ráfagas (tty_read_burst) y entrega byte a byte desde el buffer.
 int tty_getch_nonblock(void){
-    unsigned char ch;
-    // read() intenta leer 1 byte de stdin.
-    // Con O_NONBLOCK + VMIN/VTIME=0, si no hay datos devuelve -1 (errno=EAGAIN/EWOULDBLOCK).
-    ssize_t n = read(STDIN_FILENO, &ch, 1);
-    if (n == 1) {
-        // ¡Hay tecla! devolvemos su código (char -> int)
-        return ch;
+    if (pend_pos == pend_len) {
+        // buffer vacío: traer todo lo pendiente con un solo read()
+        int n = tty_read_burst(STDIN_FILENO, pend, TTY_BURST_MAX);
+        if (n <= 0) {
+            // No hay tecla pendiente.
+            return -1;
+        }
+        pend_len = n;
+        pend_pos = 0;
     }
-    // No hay tecla pendiente.
-    return -1;
+    // ¡Hay tecla! devolvemos su código (char -> int)
+    return pend[pend_pos++];
 }
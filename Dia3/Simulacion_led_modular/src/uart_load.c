@@ -0,0 +1,230 @@
+/*
+  uart_load.c — Throughput del UART simulado con DMA y callbacks por bloque
+
+  Para cada baud, el UART 0 en loopback transmite un patrón conocido durante
+  unos segundos, manejado solo por eventos (como haría el firmware):
+    - UART_EV_TX_LOW: rellena el anillo de TX de a bloques
+    - RX por DMA circular: en HALF / FULL / IDLE procesa el bloque desde la
+      última posición hasta la actual y lo compara (memcmp) con el patrón
+  El loop duerme en event_wait() entre eventos. Reporta:
+    - bytes/s logrados vs el teórico (baud / 10, 8N1)
+    - callbacks/s y despertares del loop
+    - CPU del loop y del proceso completo
+    - bytes perdidos y bloques con datos distintos al patrón
+
+  Con -d 0 el RX va al anillo y se lee con uart_read() en UART_EV_RX_DATA.
+
+  Uso:
+    ./bin/uart [-b baud,...] [-t segundos] [-d dma_bytes]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "uart.h"
+#include "event.h"
+#include "timeutil.h"
+
+#define LOAD_UART  0
+#define LOAD_BLOCK 256 // bytes por uart_write
+
+typedef struct{
+    uint32_t bauds[8];
+    int      nbauds;
+    double   secs;
+    size_t   dma_len;   // 0 = RX por anillo
+} uart_opts_t;
+
+typedef struct{
+    uint8_t *dma;
+    size_t   dma_len;
+    size_t   last_pos;  // hasta dónde se procesó el buffer del DMA
+    uint64_t tx_off;    // bytes del patrón ya escritos
+    uint64_t rx_off;    // bytes del patrón ya verificados
+    uint64_t bad;       // bloques distintos al patrón
+    uint64_t callbacks;
+    int      sending;
+} load_ctx_t;
+
+// byte k del patrón: no se repite en ningún múltiplo chico de los buffers
+static uint8_t pattern_at(uint64_t k){
+    return (uint8_t)(k * 31u + (k >> 9));
+}
+
+static void pattern_fill(uint8_t *dst, uint64_t off, size_t n){
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = pattern_at(off + i);
+    }
+}
+
+static void refill(load_ctx_t *c){
+    uint8_t blk[LOAD_BLOCK];
+    while (c->sending && uart_tx_free(LOAD_UART) >= LOAD_BLOCK) {
+        pattern_fill(blk, c->tx_off, LOAD_BLOCK);
+        c->tx_off += uart_write(LOAD_UART, blk, LOAD_BLOCK);
+    }
+}
+
+static void check(load_ctx_t *c, const uint8_t *data, size_t n){
+    uint8_t exp[LOAD_BLOCK];
+    while (n > 0) {
+        size_t k = n < LOAD_BLOCK ? n : LOAD_BLOCK;
+        pattern_fill(exp, c->rx_off, k);
+        c->bad += (memcmp(data, exp, k) != 0);
+        c->rx_off += k;
+        data += k;
+        n -= k;
+    }
+}
+
+static void on_uart(int uart, unsigned events, size_t pos, void *arg){
+    load_ctx_t *c = arg;
+    (void)uart;
+    c->callbacks++;
+    if (events & UART_EV_TX_LOW) {
+        refill(c);
+    }
+    if (c->dma != NULL && (events & (UART_EV_RX_HALF | UART_EV_RX_FULL | UART_EV_RX_IDLE))) {
+        // de last_pos a pos, dando la vuelta si hace falta
+        if (pos < c->last_pos || (pos == c->last_pos && (events & UART_EV_RX_FULL))) {
+            check(c, c->dma + c->last_pos, c->dma_len - c->last_pos);
+            c->last_pos = 0;
+        }
+        check(c, c->dma + c->last_pos, pos - c->last_pos);
+        c->last_pos = pos;
+    }
+    if (events & UART_EV_RX_DATA) {
+        uint8_t buf[1024];
+        size_t n;
+        while ((n = uart_read(LOAD_UART, buf, sizeof(buf))) > 0) {
+            check(c, buf, n);
+        }
+    }
+}
+
+static long long cpu_ns(clockid_t id){
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int run_baud(const uart_opts_t *o, uint32_t baud){
+    load_ctx_t c = { .dma_len = o->dma_len, .sending = 1 };
+    uart_cfg_t cfg = { .baud = baud, .peer = LOAD_UART, .tx_size = 4096, .rx_size = 4096,
+                       .cb = on_uart, .arg = &c };
+    if (uart_init(LOAD_UART, &cfg) != 0) {
+        fprintf(stderr, "uart: no se pudo iniciar a %u baud\n", baud);
+        return -1;
+    }
+    if (o->dma_len > 0) {
+        c.dma = malloc(o->dma_len);
+        if (c.dma == NULL || uart_rx_dma_start(LOAD_UART, c.dma, o->dma_len) != 0) {
+            fprintf(stderr, "uart: DMA de %zu bytes no válido\n", o->dma_len);
+            uart_deinit(LOAD_UART);
+            free(c.dma);
+            return -1;
+        }
+    }
+
+    long long wakes  = 0;
+    long long loop0  = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+    long long proc0  = cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+    long long t0     = now_ns();
+    long long t_end  = t0 + (long long)(o->secs * 1e9);
+    refill(&c);
+    for (;;) {
+        long long now = now_ns();
+        if (c.sending && now >= t_end) {
+            c.sending = 0; // dejar de escribir y esperar que la línea se vacíe
+        }
+        if (!c.sending && uart_tx_idle(LOAD_UART) && c.rx_off == c.tx_off) {
+            break;
+        }
+        if (!c.sending && now >= t_end + 1000000000LL) {
+            break; // se perdieron bytes: no van a llegar nunca
+        }
+        if (event_wait(c.sending ? (t_end - now) / 1000000 + 1 : 10) != 0) {
+            wakes++;
+        }
+        uart_poll();
+    }
+    long long t1    = now_ns();
+    long long loop1 = cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+    long long proc1 = cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+
+    uart_stats_t st;
+    uart_stats(LOAD_UART, &st);
+    uart_rx_dma_stop(LOAD_UART);
+    uart_deinit(LOAD_UART);
+    free(c.dma);
+
+    double secs = (double)(t1 - t0) / 1e9;
+    double ideal = baud / 10.0;
+    double got   = (double)st.rx_bytes / secs;
+    printf("%9u %11.0f %11.0f %6.1f %10.0f %10.0f %7.2f %7.2f %9llu %6llu\n",
+           baud, ideal, got, 100.0 * got / ideal, (double)c.callbacks / secs, (double)wakes / secs,
+           100.0 * (double)(loop1 - loop0) / (double)(t1 - t0),
+           100.0 * (double)(proc1 - proc0) / (double)(t1 - t0),
+           (unsigned long long)st.rx_dropped, (unsigned long long)c.bad);
+    return (c.bad != 0 || st.rx_dropped != 0) ? 1 : 0;
+}
+
+static void usage(const char *argv0){
+    fprintf(stderr,
+            "uso: %s [-b baud,...] [-t segundos] [-d dma_bytes]\n"
+            "  -b  velocidades a medir (por defecto 115200,1000000,4000000,12000000)\n"
+            "  -t  segundos por velocidad (por defecto 1)\n"
+            "  -d  buffer circular del DMA de RX, par (por defecto 4096, 0 = anillo + uart_read)\n", argv0);
+}
+
+int main(int argc, char **argv){
+    uart_opts_t o = { .bauds = { 115200, 1000000, 4000000, 12000000 }, .nbauds = 4, .secs = 1,
+                      .dma_len = 4096 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (v == NULL) { usage(argv[0]); return 1; }
+        if (strcmp(a, "-b") == 0) {
+            o.nbauds = 0;
+            char buf[128];
+            snprintf(buf, sizeof(buf), "%s", v);
+            for (char *tok = strtok(buf, ","); tok != NULL && o.nbauds < 8; tok = strtok(NULL, ",")) {
+                long b = atol(tok);
+                if (b > 0) {
+                    o.bauds[o.nbauds++] = (uint32_t)b;
+                }
+            }
+        } else if (strcmp(a, "-t") == 0) {
+            o.secs = atof(v);
+        } else if (strcmp(a, "-d") == 0) {
+            o.dma_len = (size_t)atol(v);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.nbauds == 0 || o.secs <= 0) { usage(argv[0]); return 1; }
+    if (event_init() != 0) {
+        perror("event_init");
+        return 1;
+    }
+
+    printf("%9s %11s %11s %6s %10s %10s %7s %7s %9s %6s\n",
+           "baud", "teórico B/s", "logrado B/s", "%", "callbk/s", "despert/s",
+           "loop %", "CPU %", "perdidos", "malos");
+    int rc = 0;
+    for (int k = 0; k < o.nbauds; k++) {
+        int r = run_baud(&o, o.bauds[k]);
+        if (r < 0) {
+            rc = 1;
+            break;
+        }
+        rc |= r;
+    }
+    event_close();
+    return rc;
+}
@@ -0,0 +1,444 @@
+/*
+    uart_sim.c — UART SIMULADO (implementación de uart.h)
+
+    ¿QUÉ ES ESTO?
+    -------------
+    - Un UART por software: cada uno tiene un hilo "línea" que saca bytes de
+      su anillo de TX a la velocidad del baud (8N1 = 10 bits por byte) y los
+      entrega del otro lado del cable: al anillo de RX del peer o, si el peer
+      tiene DMA activo, directo en su buffer circular.
+    - El firmware (hilo del loop) solo copia bloques: uart_write() al anillo
+      de TX, uart_read() o el buffer del DMA desde el de RX.
+
+    HILOS
+    -----
+    - anillo de TX: productor = loop (uart_write), consumidor = línea propia
+    - anillo de RX: productor = línea del peer, consumidor = loop (uart_read)
+      (una sola línea escribe en cada RX, así que alcanza con spsc.h)
+    - buffer del DMA: lo escribe la línea del peer con slot_mu tomado (uno por
+      ráfaga, no por byte), para que uart_rx_dma_stop() sepa que nadie lo toca
+    - slot_mu[u]: un mutex por ranura, estático y nunca destruido. Protege
+      "used" y los buffers de RX: la línea del peer solo toca la ranura con él
+      tomado y después de ver used, así uart_deinit / uart_init pueden
+      liberar o reiniciar la ranura aunque el peer siga transmitiendo
+    - eventos: la línea los acumula en "pending" (atómico) y llama a
+      event_signal(); uart_poll() los entrega en el hilo del loop
+
+    TIEMPO
+    ------
+    - siempre reloj real (CLOCK_MONOTONIC): es un periférico en tiempo real
+    - la línea despierta cada max(1 caracter, UART_SIM_TICK_NS) y entrega de
+      una vez todos los bytes que "entraron" en el tiempo transcurrido
+    - IDLE: después de una ráfaga, si pasa un caracter sin bytes nuevos
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "uart.h"
+#include "spsc.h"
+#include "event.h"
+#include "timeutil.h"
+
+#define UART_SIM_TICK_NS     50000LL // la línea despierta como mucho cada 50 us
+#define UART_SIM_RING_DEFAULT 4096
+
+typedef struct{
+    int             used;
+    uart_cfg_t      cfg;
+    long long       char_ns;      // duración de un byte en la línea
+
+    // TX
+    spsc_t          txq;
+    uint8_t        *txbuf;
+    pthread_t       line;
+    atomic_int      stop;
+    atomic_uint     kick;         // futex: uart_write despierta a la línea dormida
+    atomic_int      sleeping;
+
+    // RX
+    spsc_t          rxq;
+    uint8_t        *rxbuf;
+    uint8_t        *dma_buf;      // NULL = RX al anillo
+    size_t          dma_len;
+    atomic_size_t   dma_pos;
+    size_t          dma_unread;   // bytes escritos desde el último uart_poll (para ver desbordes)
+    atomic_int      rx_burst;     // 1 = llegaron bytes y todavía no hubo IDLE
+
+    atomic_uint     pending;      // eventos para uart_poll
+
+    // estadísticas
+    atomic_uint_least64_t tx_bytes, rx_bytes, rx_dropped, wakeups;
+    uint64_t        events;
+} uart_sim_t;
+
+static uart_sim_t      uarts[UART_COUNT];
+static pthread_mutex_t slot_mu[UART_COUNT] = { [0 ... UART_COUNT - 1] = PTHREAD_MUTEX_INITIALIZER };
+
+/*==========================================================
+=                 FUNCIONES AUXILIARES (privadas)          =
+==========================================================*/
+
+static int uart_is_valid(int u){
+    return u >= 0 && u < UART_COUNT && uarts[u].used;
+}
+
+static pthread_mutex_t *mu_of(const uart_sim_t *U){
+    return &slot_mu[U - uarts];
+}
+
+static int pow2(size_t n){
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+// Eventos para el loop: un event_signal solo si no había ninguno pendiente
+static void post(uart_sim_t *U, unsigned ev){
+    if (atomic_fetch_or(&U->pending, ev) == 0) {
+        atomic_fetch_add_explicit(&U->wakeups, 1, memory_order_relaxed);
+        event_signal();
+    }
+}
+
+/* Copia n bytes del anillo src (a partir del índice sin enmascarar "from") a dst */
+static void ring_copy_out(uint8_t *dst, const uint8_t *ring, size_t mask, size_t from, size_t n){
+    size_t i   = from & mask;
+    size_t seg = (mask + 1 - i < n) ? mask + 1 - i : n;
+    memcpy(dst, ring + i, seg);
+    memcpy(dst + seg, ring, n - seg);
+}
+
+static void ring_copy_in(uint8_t *ring, size_t mask, size_t from, const uint8_t *src, size_t n){
+    size_t i   = from & mask;
+    size_t seg = (mask + 1 - i < n) ? mask + 1 - i : n;
+    memcpy(ring + i, src, seg);
+    memcpy(ring, src + seg, n - seg);
+}
+
+/* Entrega n bytes (del anillo de TX de S) en el RX de P: DMA o anillo */
+static void deliver(uart_sim_t *S, size_t from, size_t n, uart_sim_t *P){
+    unsigned ev = 0;
+    pthread_mutex_lock(mu_of(P));
+    if (!P->used) {
+        pthread_mutex_unlock(mu_of(P)); // peer desinicializado: los bytes se pierden en el cable
+        return;
+    }
+    if (P->dma_buf != NULL) {
+        size_t len  = P->dma_len;
+        size_t half = len / 2;
+        size_t pos  = atomic_load_explicit(&P->dma_pos, memory_order_relaxed);
+        size_t left = n;
+        while (left > 0) {
+            size_t seg = (len - pos < left) ? len - pos : left;
+            ring_copy_out(P->dma_buf + pos, S->txbuf, S->txq.mask, from, seg);
+            if (pos < half && pos + seg >= half) {
+                ev |= UART_EV_RX_HALF;
+            }
+            pos += seg;
+            if (pos == len) {
+                pos = 0;
+                ev |= UART_EV_RX_FULL;
+            }
+            from += seg;
+            left -= seg;
+        }
+        atomic_store_explicit(&P->dma_pos, pos, memory_order_release);
+        P->dma_unread += n;
+        if (P->dma_unread > len) {
+            // el loop no llegó a leer: lo más viejo se pisó (como en HW)
+            atomic_fetch_add_explicit(&P->rx_dropped, P->dma_unread - len, memory_order_relaxed);
+            P->dma_unread = len;
+        }
+        atomic_fetch_add_explicit(&P->rx_bytes, n, memory_order_relaxed);
+    } else {
+        size_t first;
+        size_t room = spsc_reserve_n(&P->rxq, n, &first);
+        size_t k = room < n ? room : n;
+        for (size_t done = 0; done < k; ) {
+            size_t src = (from + done) & S->txq.mask;
+            size_t seg = S->txq.mask + 1 - src;
+            if (seg > k - done) seg = k - done;
+            ring_copy_in(P->rxbuf, P->rxq.mask, first + done, S->txbuf + src, seg);
+            done += seg;
+        }
+        spsc_publish_n(&P->rxq, k);
+        atomic_fetch_add_explicit(&P->rx_bytes, k, memory_order_relaxed);
+        if (k < n) {
+            atomic_fetch_add_explicit(&P->rx_dropped, n - k, memory_order_relaxed);
+        }
+        if (k > 0) {
+            ev |= UART_EV_RX_DATA;
+        }
+    }
+    atomic_store(&P->rx_burst, 1);
+    if (ev) {
+        post(P, ev);
+    }
+    pthread_mutex_unlock(mu_of(P));
+}
+
+// IDLE en el peer (un caracter sin bytes después de una ráfaga), si sigue vivo
+static void idle_check(uart_sim_t *P){
+    pthread_mutex_lock(mu_of(P));
+    if (P->used && atomic_exchange(&P->rx_burst, 0)) {
+        post(P, UART_EV_RX_IDLE);
+    }
+    pthread_mutex_unlock(mu_of(P));
+}
+
+static void line_wait(uart_sim_t *U, unsigned seen, long long timeout_ns){
+    struct timespec ts = { timeout_ns / 1000000000LL, timeout_ns % 1000000000LL };
+    atomic_store(&U->sleeping, 1);
+    size_t first;
+    if (spsc_peek(&U->txq, &first) == 0 && !atomic_load(&U->stop)) {
+        syscall(SYS_futex, &U->kick, FUTEX_WAIT_PRIVATE, seen, timeout_ns < 0 ? NULL : &ts, NULL, 0);
+    }
+    atomic_store(&U->sleeping, 0);
+}
+
+/* Hilo línea: TX de este UART -> RX del peer, al ritmo del baud */
+static void *line_main(void *arg){
+    uart_sim_t *U = arg;
+    uart_sim_t *P = (U->cfg.peer >= 0) ? &uarts[U->cfg.peer] : NULL;
+    long long tick = U->char_ns > UART_SIM_TICK_NS ? U->char_ns : UART_SIM_TICK_NS;
+    long long last = TIME_SOURCE_REAL.now_ns();
+    long long acc  = 0;   // ns de línea acumulados y todavía no convertidos en bytes
+    size_t    cap  = U->txq.mask + 1;
+
+    prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+    while (!atomic_load(&U->stop)) {
+        size_t first;
+        size_t n = spsc_peek(&U->txq, &first);
+        if (n == 0) {
+            // línea callada: IDLE del otro lado un caracter después del último byte
+            unsigned seen = atomic_load(&U->kick);
+            if (P != NULL && atomic_load(&P->rx_burst)) {
+                line_wait(U, seen, U->char_ns);
+                if (spsc_peek(&U->txq, &first) == 0) {
+                    idle_check(P);
+                }
+            } else {
+                line_wait(U, seen, -1);
+            }
+            last = TIME_SOURCE_REAL.now_ns();
+            acc  = 0;
+            continue;
+        }
+
+        long long now = TIME_SOURCE_REAL.now_ns();
+        acc += now - last;
+        last = now;
+        size_t bytes = (size_t)(acc / U->char_ns);
+        if (bytes > n) {
+            bytes = n;
+            acc = 0;
+        } else {
+            acc -= (long long)bytes * U->char_ns;
+        }
+        if (bytes > 0) {
+            if (P != NULL) {
+                deliver(U, first, bytes, P); // mira P->used con el mutex de P tomado
+            }
+            spsc_consume(&U->txq, bytes);
+            atomic_fetch_add_explicit(&U->tx_bytes, bytes, memory_order_relaxed);
+            if (n >= cap / 2 && n - bytes < cap / 2) {
+                post(U, UART_EV_TX_LOW);
+            }
+        }
+        TIME_SOURCE_REAL.sleep_until_ns(now + tick);
+    }
+    return NULL;
+}
+
+/*==========================================================
+=                    API PÚBLICA (uart.h)                  =
+==========================================================*/
+
+int uart_init(int u, const uart_cfg_t *cfg){
+    if (u < 0 || u >= UART_COUNT || uarts[u].used || cfg->baud == 0 ||
+        cfg->peer < -1 || cfg->peer >= UART_COUNT) {
+        return -1;
+    }
+    size_t txs = cfg->tx_size ? cfg->tx_size : UART_SIM_RING_DEFAULT;
+    size_t rxs = cfg->rx_size ? cfg->rx_size : UART_SIM_RING_DEFAULT;
+    if (!pow2(txs) || !pow2(rxs)) {
+        return -1;
+    }
+    uart_sim_t *U = &uarts[u];
+    pthread_mutex_lock(mu_of(U)); // la línea del peer puede estar mirando esta ranura
+    memset(U, 0, sizeof(*U));
+    U->cfg     = *cfg;
+    U->char_ns = 10LL * 1000000000LL / cfg->baud;
+    if (U->char_ns < 1) U->char_ns = 1;
+    U->txbuf   = malloc(txs);
+    U->rxbuf   = malloc(rxs);
+    if (U->txbuf == NULL || U->rxbuf == NULL) {
+        free(U->txbuf);
+        free(U->rxbuf);
+        U->txbuf = U->rxbuf = NULL;
+        pthread_mutex_unlock(mu_of(U));
+        return -1;
+    }
+    spsc_init(&U->txq, txs);
+    spsc_init(&U->rxq, rxs);
+    U->used = 1;
+    pthread_mutex_unlock(mu_of(U));
+    if (pthread_create(&U->line, NULL, line_main, U) != 0) {
+        pthread_mutex_lock(mu_of(U));
+        U->used = 0;
+        free(U->txbuf);
+        free(U->rxbuf);
+        U->txbuf = U->rxbuf = NULL;
+        pthread_mutex_unlock(mu_of(U));
+        return -1;
+    }
+    return 0;
+}
+
+void uart_deinit(int u){
+    if (!uart_is_valid(u)) {
+        return;
+    }
+    uart_sim_t *U = &uarts[u];
+    atomic_store(&U->stop, 1);
+    atomic_fetch_add(&U->kick, 1);
+    syscall(SYS_futex, &U->kick, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    pthread_join(U->line, NULL);
+    // con el mutex de la ranura: ninguna línea de un peer está dentro de deliver()
+    pthread_mutex_lock(mu_of(U));
+    U->used = 0;
+    U->dma_buf = NULL;
+    free(U->txbuf);
+    free(U->rxbuf);
+    U->txbuf = NULL;
+    U->rxbuf = NULL;
+    pthread_mutex_unlock(mu_of(U));
+}
+
+size_t uart_write(int u, const void *data, size_t len){
+    if (!uart_is_valid(u)) {
+        return 0;
+    }
+    uart_sim_t *U = &uarts[u];
+    size_t first;
+    size_t room = spsc_reserve_n(&U->txq, len, &first);
+    size_t n = room < len ? room : len;
+    if (n == 0) {
+        return 0;
+    }
+    ring_copy_in(U->txbuf, U->txq.mask, first, data, n);
+    spsc_publish_n(&U->txq, n);
+    atomic_fetch_add(&U->kick, 1);
+    if (atomic_load(&U->sleeping)) {
+        syscall(SYS_futex, &U->kick, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+    return n;
+}
+
+size_t uart_tx_free(int u){
+    if (!uart_is_valid(u)) {
+        return 0;
+    }
+    size_t first;
+    return spsc_reserve_n(&uarts[u].txq, SIZE_MAX, &first);
+}
+
+int uart_tx_idle(int u){
+    if (!uart_is_valid(u)) {
+        return 1;
+    }
+    return uart_tx_free(u) == uarts[u].txq.mask + 1;
+}
+
+size_t uart_read(int u, void *data, size_t len){
+    if (!uart_is_valid(u)) {
+        return 0;
+    }
+    uart_sim_t *U = &uarts[u];
+    size_t first;
+    size_t n = spsc_peek(&U->rxq, &first);
+    if (n > len) {
+        n = len;
+    }
+    ring_copy_out(data, U->rxbuf, U->rxq.mask, first, n);
+    spsc_consume(&U->rxq, n);
+    return n;
+}
+
+size_t uart_rx_available(int u){
+    if (!uart_is_valid(u)) {
+        return 0;
+    }
+    size_t first;
+    return spsc_peek(&uarts[u].rxq, &first);
+}
+
+int uart_rx_dma_start(int u, void *buf, size_t len){
+    if (!uart_is_valid(u) || buf == NULL || len < 2 || (len & 1u)) {
+        return -1;
+    }
+    uart_sim_t *U = &uarts[u];
+    pthread_mutex_lock(mu_of(U));
+    U->dma_buf    = buf;
+    U->dma_len    = len;
+    U->dma_unread = 0;
+    atomic_store(&U->dma_pos, 0);
+    pthread_mutex_unlock(mu_of(U));
+    return 0;
+}
+
+void uart_rx_dma_stop(int u){
+    if (!uart_is_valid(u)) {
+        return;
+    }
+    uart_sim_t *U = &uarts[u];
+    pthread_mutex_lock(mu_of(U)); // espera a que termine la ráfaga en curso
+    U->dma_buf = NULL;
+    U->dma_len = 0;
+    pthread_mutex_unlock(mu_of(U));
+}
+
+size_t uart_rx_dma_pos(int u){
+    if (!uart_is_valid(u)) {
+        return 0;
+    }
+    return atomic_load_explicit(&uarts[u].dma_pos, memory_order_acquire);
+}
+
+void uart_poll(void){
+    for (int u = 0; u < UART_COUNT; u++) {
+        uart_sim_t *U = &uarts[u];
+        if (!U->used || atomic_load_explicit(&U->pending, memory_order_relaxed) == 0) {
+            continue;
+        }
+        unsigned ev = atomic_exchange(&U->pending, 0);
+        if (ev & (UART_EV_RX_HALF | UART_EV_RX_FULL | UART_EV_RX_IDLE)) {
+            pthread_mutex_lock(mu_of(U));
+            U->dma_unread = 0; // el callback lee hasta la posición actual
+            pthread_mutex_unlock(mu_of(U));
+        }
+        if (U->cfg.cb != NULL) {
+            U->cfg.cb(u, ev, uart_rx_dma_pos(u), U->cfg.arg);
+            U->events++;
+        }
+    }
+}
+
+void uart_stats(int u, uart_stats_t *st){
+    memset(st, 0, sizeof(*st));
+    if (u < 0 || u >= UART_COUNT) {
+        return;
+    }
+    uart_sim_t *U = &uarts[u];
+    st->tx_bytes   = atomic_load(&U->tx_bytes);
+    st->rx_bytes   = atomic_load(&U->rx_bytes);
+    st->rx_dropped = atomic_load(&U->rx_dropped);
+    st->wakeups    = atomic_load(&U->wakeups);
+    st->events     = U->events;
+}
@@ -0,0 +1,247 @@
+/*
+  vcd.c — Volcado VCD de los pines con un hilo escritor
+
+  Camino caliente (hilo del loop, vcd_change):
+    - ¿el pin se vuelca? (una tabla)
+    - reservar un hueco en la cola, copiar 16 bytes, publicar
+  sin locks, sin syscalls, sin formatear texto.
+
+  Hilo escritor:
+    - vacía la cola por lotes, arma el texto VCD en un buffer propio y lo
+      escribe con fwrite en bloques de VCD_OUT_SIZE
+    - si la cola está vacía duerme VCD_IDLE_NS (reloj real, aunque el
+      programa use el virtual)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "vcd.h"
+#include "spsc.h"
+#include "gpio.h"
+#include "timeutil.h"
+
+#define VCD_RING_BITS 18                    // 256 K cambios en vuelo (4 MB)
+#define VCD_RING_SIZE (1u << VCD_RING_BITS)
+#define VCD_OUT_SIZE  (256 * 1024)          // bloque de escritura
+#define VCD_IDLE_NS   1000000LL             // 1 ms de siesta si no hay nada
+
+typedef struct{
+    long long t_ns;
+    uint16_t  pin;
+    uint8_t   value;
+} vcd_rec_t;
+
+int vcd_active = 0;
+
+static vcd_rec_t   ring[VCD_RING_SIZE];
+static spsc_t      q;
+static int16_t     var_of[GPIO_PIN_MAX];    // pin -> variable VCD (-1 = no se vuelca)
+static char        var_id[GPIO_PIN_MAX][4]; // identificador corto de cada variable
+static FILE       *out;
+static long long   t0_ns;
+static pthread_t   writer;
+static atomic_int  stop;
+static uint64_t    dropped;                 // solo lo toca el productor
+static uint64_t    written;                 // solo lo toca el escritor
+
+/*==========================================================
+=                  FORMATO (uso interno)                   =
+==========================================================*/
+
+// Identificador VCD: base 94 con los ASCII imprimibles '!'..'~'
+static void make_id(char *dst, int n){
+    int len = 0;
+    do {
+        dst[len++] = (char)('!' + n % 94);
+        n /= 94;
+    } while (n > 0 && len < 3);
+    dst[len] = '\0';
+}
+
+// Escribe v en decimal al final de p, retorna el nuevo final
+static char *put_u64(char *p, unsigned long long v){
+    char tmp[24];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+/*==========================================================
+=                     HILO ESCRITOR                        =
+==========================================================*/
+
+static void *writer_main(void *arg){
+    (void)arg;
+    char *buf = malloc(VCD_OUT_SIZE);
+    if (buf == NULL) {
+        return NULL;
+    }
+    char *p = buf;
+    char *limit = buf + VCD_OUT_SIZE - 64; // espacio para un registro más
+    long long last_t = 0;                  // "#0" ya salió con $dumpvars
+
+    for (;;) {
+        size_t first;
+        size_t n = spsc_peek(&q, &first);
+        if (n == 0) {
+            if (atomic_load_explicit(&stop, memory_order_acquire)) {
+                // el productor ya terminó: lo que publicó antes de stop se ve aquí
+                if (spsc_peek(&q, &first) == 0) {
+                    break;
+                }
+                continue;
+            }
+            if (p != buf) {
+                fwrite(buf, 1, (size_t)(p - buf), out); // no retener datos mientras no hay tráfico
+                p = buf;
+            }
+            TIME_SOURCE_REAL.sleep_ns(VCD_IDLE_NS);
+            continue;
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            const vcd_rec_t *r = &ring[(first + k) & q.mask];
+            long long t = r->t_ns - t0_ns;
+            if (t < last_t) {
+                t = last_t; // VCD exige tiempos crecientes
+            }
+            if (t != last_t) {
+                *p++ = '#';
+                p = put_u64(p, (unsigned long long)t);
+                *p++ = '\n';
+                last_t = t;
+            }
+            *p++ = r->value ? '1' : '0';
+            for (const char *id = var_id[r->pin]; *id; id++) {
+                *p++ = *id;
+            }
+            *p++ = '\n';
+            if (p >= limit) {
+                fwrite(buf, 1, (size_t)(p - buf), out);
+                p = buf;
+            }
+        }
+        written += n;
+        spsc_consume(&q, n);
+    }
+
+    // marca de tiempo final: que el visor muestre cuánto duró el último estado
+    long long t_end = now_ns() - t0_ns;
+    if (t_end > last_t) {
+        *p++ = '#';
+        p = put_u64(p, (unsigned long long)t_end);
+        *p++ = '\n';
+    }
+    fwrite(buf, 1, (size_t)(p - buf), out);
+    free(buf);
+    return NULL;
+}
+
+/*==========================================================
+=                        API PÚBLICA                        =
+==========================================================*/
+
+int vcd_open(const char *path, const int *pins, const char *const *names, int npins){
+    if (vcd_active) {
+        return -1;
+    }
+    out = fopen(path, "w");
+    if (out == NULL) {
+        return -1;
+    }
+
+    // una variable por pin (inválidos y repetidos se saltan); decl = índice en pins[]
+    static int decl[GPIO_PIN_MAX];
+    int nvars = 0;
+    memset(var_of, 0xff, sizeof(var_of)); // todo -1
+    for (int i = 0; i < npins; i++) {
+        int pin = pins[i];
+        if (pin < 0 || pin >= GPIO_PIN_MAX || var_of[pin] >= 0) {
+            continue;
+        }
+        var_of[pin] = (int16_t)nvars;
+        make_id(var_id[pin], nvars);
+        decl[nvars++] = i;
+    }
+
+    // encabezado y declaración de variables
+    time_t now = time(NULL);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    fprintf(out, "$date %s $end\n", date);
+    fprintf(out, "$version Simulacion_led_modular gpio_sim $end\n");
+    fprintf(out, "$timescale 1ns $end\n");
+    fprintf(out, "$scope module gpio $end\n");
+    for (int v = 0; v < nvars; v++) {
+        int i = decl[v];
+        if (names != NULL && names[i] != NULL) {
+            fprintf(out, "$var wire 1 %s %s $end\n", var_id[pins[i]], names[i]);
+        } else {
+            fprintf(out, "$var wire 1 %s pin%d $end\n", var_id[pins[i]], pins[i]);
+        }
+    }
+    fprintf(out, "$upscope $end\n$enddefinitions $end\n");
+
+    // valores iniciales
+    fprintf(out, "#0\n$dumpvars\n");
+    for (int v = 0; v < nvars; v++) {
+        int pin = pins[decl[v]];
+        fprintf(out, "%d%s\n", gpio_read(pin), var_id[pin]);
+    }
+    fprintf(out, "$end\n");
+
+    spsc_init(&q, VCD_RING_SIZE);
+    atomic_store(&stop, 0);
+    dropped = 0;
+    written = 0;
+    t0_ns   = now_ns();
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        fclose(out);
+        out = NULL;
+        return -1;
+    }
+    vcd_active = 1;
+    return 0;
+}
+
+void vcd_change(long long t_ns, int pin, int value){
+    if (var_of[pin] < 0) {
+        return; // pin no declarado
+    }
+    long i = spsc_reserve(&q);
+    if (i < 0) {
+        dropped++; // cola llena: descartar antes que bloquear el loop
+        return;
+    }
+    ring[i].t_ns  = t_ns;
+    ring[i].pin   = (uint16_t)pin;
+    ring[i].value = (uint8_t)value;
+    spsc_publish(&q);
+}
+
+int vcd_close(void){
+    if (!vcd_active) {
+        return -1;
+    }
+    vcd_active = 0;
+    atomic_store_explicit(&stop, 1, memory_order_release);
+    pthread_join(writer, NULL);
+    int rc = (fclose(out) == 0) ? 0 : -1;
+    out = NULL;
+    return rc;
+}
+
+void vcd_stats(vcd_stats_t *s){
+    s->changes = written;
+    s->dropped = dropped;
+}